@@ -0,0 +1,500 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct DemoPath {
+        std::string_view name;
+        std::string_view path;
+    };
+
+    /// 由 CMake 生成，每个示例可执行文件的路径
+    constexpr DemoPath DEMO_PATHS[] = {
+#include "demo_paths.inc"
+    };
+
+    enum class Backend {
+        /// SDL_Renderer，用 offscreen 视频驱动和软件渲染器
+        Renderer,
+        /// OpenGL 上下文，用 offscreen 视频驱动的 EGL 和 Mesa llvmpipe
+        OpenGL,
+    };
+
+    struct Demo {
+        std::string_view name;
+        Backend backend;
+        std::vector<std::string_view> arguments;
+    };
+
+    /// snake 的渲染和步进都按真实时间限速，基准只看每帧的 CPU 时间；自动驾驶保证跑满帧数不会撞死
+    /// woodeneye 不限帧率，256 个机器人让网格、射击和剔除都有负载
+    const std::vector<Demo> DEMOS = {
+            {.name = "03_lines", .backend = Backend::Renderer},
+            {.name = "04_points", .backend = Backend::Renderer},
+            {.name = "05_rectangle", .backend = Backend::Renderer},
+            {.name = "06_texture", .backend = Backend::Renderer},
+            {.name = "07_streaming_texture", .backend = Backend::Renderer},
+            {.name = "snake", .backend = Backend::Renderer, .arguments = {"--autopilot", "--seed", "1"}},
+            {.name = "woodeneye", .backend = Backend::Renderer, .arguments = {"--bots", "256", "--pacing", "uncapped"}},
+            {.name = "first_opengl", .backend = Backend::OpenGL},
+            {.name = "opengl_sandbox", .backend = Backend::OpenGL},
+    };
+
+    struct Options {
+        std::uint64_t frames = 600;
+        /// 前几帧包括加载资源、编译着色器，不计入统计
+        std::uint64_t warmup = 60;
+        std::filesystem::path output = "benchmark_results.json";
+        std::filesystem::path baseline = BENCHMARK_BASELINE;
+        bool update_baseline = false;
+        /// 比基线慢或多占内存超过这个比例就算退步
+        double threshold = 0.10;
+        double timeout_seconds = 120.0;
+        std::filesystem::path work_dir = "benchmark_runs";
+        std::vector<std::string> only;
+    };
+
+    struct Result {
+        std::string name;
+        std::string error;
+        std::uint64_t frames = 0;
+        /// 按帧间隔算的帧率，包括示例自己的限速和等待
+        double fps = 0.0;
+        /// 只按每帧的 CPU 时间算的帧率
+        double work_fps = 0.0;
+        double mean_ns = 0.0;
+        double p50_ns = 0.0;
+        double p90_ns = 0.0;
+        double p99_ns = 0.0;
+        double max_ns = 0.0;
+        long peak_rss_kb = 0;
+
+        [[nodiscard]] auto ok() const -> bool { return error.empty(); }
+    };
+
+    auto find_path(const std::string_view name) -> std::optional<std::string_view> {
+        for (const auto &[demo, path]: DEMO_PATHS) {
+            if (demo == name) {
+                return path;
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto split(const std::string_view text, const char separator) -> std::vector<std::string_view> {
+        std::vector<std::string_view> parts;
+        std::size_t begin = 0;
+        while (true) {
+            const auto end = text.find(separator, begin);
+            parts.push_back(text.substr(begin, end - begin));
+            if (end == std::string_view::npos) {
+                return parts;
+            }
+            begin = end + 1;
+        }
+    }
+
+    auto parse_double(const std::string_view text) -> double {
+        double value = 0.0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
+
+    /// 在子进程里设置环境、重定向输出后启动示例，不返回
+    [[noreturn]] auto exec_demo(const Demo &demo, const std::string_view path, const std::filesystem::path &trace,
+                                const std::filesystem::path &log, const Options &options) -> void {
+        // 示例按相对路径加载 res/，工作目录切到可执行文件所在目录
+        const std::filesystem::path executable{path};
+        if (chdir(executable.parent_path().c_str()) != 0) {
+            _exit(126);
+        }
+        setenv("SDL_VIDEO_DRIVER", "offscreen", 1);
+        setenv("APP_RUNTIME_FRAMES", std::to_string(options.warmup + options.frames).c_str(), 1);
+        setenv("APP_RUNTIME_TRACE", trace.c_str(), 1);
+        unsetenv("APP_RUNTIME_CHROME_TRACE");
+        if (demo.backend == Backend::Renderer) {
+            setenv("SDL_RENDER_DRIVER", "software", 1);
+        }
+        else {
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+            setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+            // 示例要求 4.6 core 上下文，旧一些的 llvmpipe 只报告 4.5
+            setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+            // 示例打开了垂直同步，基准不等待
+            setenv("vblank_mode", "0", 1);
+        }
+
+        if (const auto fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+
+        std::vector<std::string> arguments{executable.string()};
+        arguments.insert(arguments.end(), demo.arguments.begin(), demo.arguments.end());
+        std::vector<char *> argv;
+        for (auto &argument: arguments) {
+            argv.push_back(argument.data());
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    /// 读取 FrameCapture 写出的每帧 CSV，跳过预热帧后统计
+    auto read_frames(const std::filesystem::path &csv, const Options &options, Result &result) -> void {
+        std::ifstream in(csv);
+        std::string line;
+        if (not in or not std::getline(in, line)) {
+            result.error = std::format("no frame records in {}", csv.string());
+            return;
+        }
+        const auto header = split(line, ',');
+        const auto column = [&header](const std::string_view name) {
+            return static_cast<std::size_t>(std::ranges::find(header, name) - header.begin());
+        };
+        const auto frame_column = column("frame");
+        const auto interval_column = column("interval_ms");
+        const auto iteration_column = column("iteration_ms");
+        if (std::max({frame_column, interval_column, iteration_column}) >= header.size()) {
+            result.error = std::format("unexpected header in {}", csv.string());
+            return;
+        }
+
+        std::vector<double> samples;
+        double interval_seconds = 0.0;
+        std::uint64_t intervals = 0;
+        while (std::getline(in, line)) {
+            const auto fields = split(line, ',');
+            if (fields.size() < header.size()) {
+                continue;
+            }
+            if (static_cast<std::uint64_t>(parse_double(fields[frame_column])) < options.warmup) {
+                continue;
+            }
+            samples.push_back(parse_double(fields[iteration_column]) * 1e6);
+            if (const auto interval_ms = parse_double(fields[interval_column]); interval_ms > 0.0) {
+                interval_seconds += interval_ms / 1000.0;
+                ++intervals;
+            }
+        }
+        if (samples.empty()) {
+            result.error = std::format("no frames after warmup in {}", csv.string());
+            return;
+        }
+
+        result.frames = samples.size();
+        for (const auto sample: samples) {
+            result.mean_ns += sample;
+        }
+        result.mean_ns /= static_cast<double>(samples.size());
+        result.work_fps = result.mean_ns > 0.0 ? 1e9 / result.mean_ns : 0.0;
+        result.fps = interval_seconds > 0.0 ? static_cast<double>(intervals) / interval_seconds : 0.0;
+
+        std::ranges::sort(samples);
+        const auto percentile = [&samples](const double fraction) {
+            return samples[static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1))];
+        };
+        result.p50_ns = percentile(0.50);
+        result.p90_ns = percentile(0.90);
+        result.p99_ns = percentile(0.99);
+        result.max_ns = samples.back();
+    }
+
+    auto run_demo(const Demo &demo, const Options &options) -> Result {
+        Result result{.name = std::string(demo.name)};
+        const auto path = find_path(demo.name);
+        if (not path) {
+            result.error = "executable path unknown";
+            return result;
+        }
+
+        std::filesystem::create_directories(options.work_dir);
+        const auto trace = std::filesystem::absolute(options.work_dir / demo.name);
+        auto csv = trace;
+        csv += ".csv";
+        auto log = trace;
+        log += ".log";
+        std::filesystem::remove(csv);
+
+        std::fflush(stdout);
+        const auto pid = fork();
+        if (pid < 0) {
+            result.error = "fork failed";
+            return result;
+        }
+        if (pid == 0) {
+            exec_demo(demo, *path, trace, log, options);
+        }
+
+        // 轮询等待，超时就杀掉，避免没有 GL 驱动等情况下卡住整个基准
+        const auto start = std::chrono::steady_clock::now();
+        int status = 0;
+        rusage usage{};
+        while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >
+                options.timeout_seconds) {
+                kill(pid, SIGKILL);
+                wait4(pid, &status, 0, &usage);
+                result.error = std::format("timed out after {:.0f} s, see {}", options.timeout_seconds, log.string());
+                return result;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+#if defined(__APPLE__)
+        result.peak_rss_kb = usage.ru_maxrss / 1024; // macOS 以字节为单位
+#else
+        result.peak_rss_kb = usage.ru_maxrss;
+#endif
+        if (not WIFEXITED(status) or WEXITSTATUS(status) != 0) {
+            result.error = WIFEXITED(status) ? std::format("exit code {}, see {}", WEXITSTATUS(status), log.string())
+                                             : std::format("killed by signal {}, see {}", WTERMSIG(status),
+                                                           log.string());
+            return result;
+        }
+        read_frames(csv, options, result);
+        return result;
+    }
+
+    /// 与 app_runtime.trace 的 write_escaped 相同，只转义引号和反斜杠；error 里带着日志路径
+    auto escape_json(const std::string_view text) -> std::string {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (const auto c: text) {
+            if (c == '"' or c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    /**
+     * 每个基准一行，基线比较时按行读取
+     * kept_lines 是从旧基线原样保留下来的行，接在这次的结果后面
+     */
+    auto write_results(const std::filesystem::path &path, const std::vector<Result> &results, const Options &options,
+                       const std::vector<std::string> &kept_lines = {}) -> bool {
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+        std::ofstream out(path);
+        if (not out) {
+            std::fprintf(stderr, "Failed to open %s for writing\n", path.string().c_str());
+            return false;
+        }
+        out << "{\n";
+        out << std::format("  \"frames\": {},\n  \"warmup\": {},\n  \"benchmarks\": [\n", options.frames,
+                           options.warmup);
+        const auto line_count = results.size() + kept_lines.size();
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto &result = results[i];
+            if (result.ok()) {
+                out << std::format(R"(    {{"name": "{}", "status": "ok", "frames": {}, "fps": {:.2f}, )"
+                                   R"("work_fps": {:.2f}, "mean_ns": {:.0f}, "p50_ns": {:.0f}, "p90_ns": {:.0f}, )"
+                                   R"("p99_ns": {:.0f}, "max_ns": {:.0f}, "peak_rss_kb": {}}})",
+                                   result.name, result.frames, result.fps, result.work_fps, result.mean_ns,
+                                   result.p50_ns, result.p90_ns, result.p99_ns, result.max_ns, result.peak_rss_kb);
+            }
+            else {
+                out << std::format(R"(    {{"name": "{}", "status": "failed", "error": "{}"}})", result.name,
+                                   escape_json(result.error));
+            }
+            out << (i + 1 < line_count ? ",\n" : "\n");
+        }
+        for (std::size_t i = 0; i < kept_lines.size(); ++i) {
+            out << kept_lines[i] << (results.size() + i + 1 < line_count ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return true;
+    }
+
+    auto find_number(const std::string_view line, const std::string_view key) -> std::optional<double> {
+        const auto pattern = std::format("\"{}\": ", key);
+        const auto position = line.find(pattern);
+        if (position == std::string_view::npos) {
+            return std::nullopt;
+        }
+        return parse_double(line.substr(position + pattern.size()));
+    }
+
+    auto find_string(const std::string_view line, const std::string_view key) -> std::optional<std::string_view> {
+        const auto pattern = std::format("\"{}\": \"", key);
+        const auto position = line.find(pattern);
+        if (position == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto begin = position + pattern.size();
+        return line.substr(begin, line.find('"', begin) - begin);
+    }
+
+    /**
+     * 更新基线：这次成功的示例用新结果，其余示例（没有运行或失败）保留旧基线里的行
+     * 这样 --only 只跑一部分示例时不会把其他示例的基线删掉，失败的示例也不会覆盖原来正常的基线
+     */
+    auto update_baseline(const std::vector<Result> &results, const Options &options) -> bool {
+        std::vector<Result> updated;
+        std::ranges::copy_if(results, std::back_inserter(updated), &Result::ok);
+
+        std::vector<std::string> kept_lines;
+        std::ifstream in(options.baseline);
+        std::string line;
+        while (std::getline(in, line)) {
+            const auto name = find_string(line, "name");
+            if (not name or std::ranges::find(updated, *name, &Result::name) != updated.end()) {
+                continue;
+            }
+            if (line.ends_with(',')) {
+                line.pop_back();
+            }
+            kept_lines.push_back(line);
+        }
+        in.close();
+        return write_results(options.baseline, updated, options, kept_lines);
+    }
+
+    /// 与基线比较每帧 CPU 时间的中位数和峰值内存，返回退步的个数；基线文件是 write_results 写出的格式
+    auto compare_with_baseline(const std::vector<Result> &results, const Options &options) -> int {
+        std::ifstream in(options.baseline);
+        if (not in) {
+            std::printf("\nNo baseline at %s, run with --update-baseline to record one\n",
+                        options.baseline.string().c_str());
+            return 0;
+        }
+        std::printf("\nbaseline: %s (threshold %.0f%%)\n", options.baseline.string().c_str(),
+                    options.threshold * 100.0);
+        std::printf("%-22s %12s %12s\n", "name", "p50", "peak rss");
+
+        int regressions = 0;
+        const auto compare = [&options, &regressions](const double current, const double baseline) {
+            const auto change = baseline > 0.0 ? current / baseline - 1.0 : 0.0;
+            const auto regressed = change > options.threshold;
+            regressions += regressed ? 1 : 0;
+            return std::format("{:+.1f}%{}", change * 100.0, regressed ? " !" : "");
+        };
+        std::string line;
+        while (std::getline(in, line)) {
+            const auto name = find_string(line, "name");
+            const auto p50 = find_number(line, "p50_ns");
+            const auto rss = find_number(line, "peak_rss_kb");
+            if (not name or not p50 or not rss) {
+                continue;
+            }
+            const auto result = std::ranges::find(results, *name, &Result::name);
+            if (result == results.end() or not result->ok()) {
+                continue;
+            }
+            std::printf("%-22s %12s %12s\n", result->name.c_str(), compare(result->p50_ns, *p50).c_str(),
+                        compare(static_cast<double>(result->peak_rss_kb), *rss).c_str());
+        }
+        if (regressions > 0) {
+            std::printf("%d regression(s) over %.0f%%\n", regressions, options.threshold * 100.0);
+        }
+        return regressions;
+    }
+
+    auto print_usage() -> void {
+        std::printf("usage: benchmarks [--frames N] [--warmup N] [--only NAME[,NAME...]] [--output FILE]\n"
+                    "                  [--baseline FILE] [--update-baseline] [--threshold FRACTION]\n"
+                    "                  [--timeout SECONDS] [--work-dir DIR]\n");
+    }
+} // namespace
+
+auto main(const int argc, char **argv) -> int {
+    // --frames N：每个示例在预热之后记录的帧数，默认 600；--warmup N：不计入统计的开头帧数，默认 60
+    // --only a,b：只跑列出的示例；--output FILE：结果 JSON，默认 benchmark_results.json
+    // --baseline FILE：比较用的基线，默认 benchmarks/baseline.json
+    // --update-baseline：把这次成功的结果合并进基线，没有运行或失败的示例保留原来的基线
+    // --threshold F：p50 或峰值内存比基线多出这个比例就算退步，默认 0.1；退步或有示例失败时返回 1
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument{argv[i]};
+        const auto has_value = i + 1 < argc;
+        if (argument == "--frames" && has_value) {
+            options.frames = std::max<std::uint64_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (argument == "--warmup" && has_value) {
+            options.warmup = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--only" && has_value) {
+            for (const auto name: split(argv[++i], ',')) {
+                options.only.emplace_back(name);
+            }
+        }
+        else if (argument == "--output" && has_value) {
+            options.output = argv[++i];
+        }
+        else if (argument == "--baseline" && has_value) {
+            options.baseline = argv[++i];
+        }
+        else if (argument == "--update-baseline") {
+            options.update_baseline = true;
+        }
+        else if (argument == "--threshold" && has_value) {
+            options.threshold = std::strtod(argv[++i], nullptr);
+        }
+        else if (argument == "--timeout" && has_value) {
+            options.timeout_seconds = std::strtod(argv[++i], nullptr);
+        }
+        else if (argument == "--work-dir" && has_value) {
+            options.work_dir = argv[++i];
+        }
+        else {
+            print_usage();
+            return argument == "--help" ? 0 : 2;
+        }
+    }
+
+    std::printf("%-22s %8s %10s %10s %10s %10s %10s %10s\n", "name", "frames", "fps", "work fps", "p50 us",
+                "p99 us", "max us", "rss MB");
+    std::vector<Result> results;
+    bool failed = false;
+    for (const auto &demo: DEMOS) {
+        if (not options.only.empty() && std::ranges::find(options.only, demo.name) == options.only.end()) {
+            continue;
+        }
+        const auto &result = results.emplace_back(run_demo(demo, options));
+        if (not result.ok()) {
+            std::printf("%-22s failed: %s\n", result.name.c_str(), result.error.c_str());
+            failed = true;
+            continue;
+        }
+        std::printf("%-22s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", result.name.c_str(),
+                    static_cast<unsigned long long>(result.frames), result.fps, result.work_fps,
+                    result.p50_ns / 1000.0, result.p99_ns / 1000.0, result.max_ns / 1000.0,
+                    static_cast<double>(result.peak_rss_kb) / 1024.0);
+    }
+
+    if (not write_results(options.output, results, options)) {
+        return 1;
+    }
+    std::printf("\nWrote %s\n", options.output.string().c_str());
+    if (options.update_baseline) {
+        if (not update_baseline(results, options)) {
+            return 1;
+        }
+        std::printf("Updated baseline %s\n", options.baseline.string().c_str());
+        return failed ? 1 : 0;
+    }
+    const auto regressions = compare_with_baseline(results, options);
+    return failed || regressions > 0 ? 1 : 0;
+}
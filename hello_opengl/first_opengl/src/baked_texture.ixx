@@ -0,0 +1,195 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module first_opengl.baked_texture;
+
+export namespace first_opengl {
+    /**
+     * 离线烘焙的纹理容器（.gtex），由构建时的 texture_baker 从 png/jpg 生成：
+     *
+     *     [BakedTextureHeader][padding]  [level 0][padding]  [level 1][padding] ...
+     *
+     * 头部和每一层 mip 都按 BAKED_TEXTURE_ALIGNMENT 对齐，文件可以直接 mmap 后把每层指针交给 GL
+     * 像素为紧密排列的 8 位通道，行序与 stbi_set_flip_vertically_on_load(true) 相同（从下到上）
+     */
+    constexpr std::uint32_t BAKED_TEXTURE_MAGIC = 0x58455447; // "GTEX"
+    constexpr std::uint32_t BAKED_TEXTURE_VERSION = 1;
+    constexpr std::size_t BAKED_TEXTURE_ALIGNMENT = 4096;
+    constexpr std::size_t BAKED_TEXTURE_MAX_LEVELS = 16;
+    constexpr std::string_view BAKED_TEXTURE_EXTENSION = ".gtex";
+
+    struct BakedMipLevel {
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+
+    struct BakedTextureHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        /// 与 get_image_format 使用的 stb 通道数一致：1、3 或 4
+        std::uint32_t channels;
+        std::uint32_t level_count;
+        std::array<BakedMipLevel, BAKED_TEXTURE_MAX_LEVELS> levels;
+    };
+
+    static_assert(sizeof(BakedTextureHeader) <= BAKED_TEXTURE_ALIGNMENT);
+
+    constexpr auto align_baked_offset(const std::size_t offset) -> std::size_t {
+        return (offset + BAKED_TEXTURE_ALIGNMENT - 1) & ~(BAKED_TEXTURE_ALIGNMENT - 1);
+    }
+
+    /// 源图片对应的烘焙文件路径：res/image/wall.jpg → res/image/wall.jpg.gtex
+    /// 保留原扩展名，同名的 wall.png 和 wall.jpg 不会烘焙到同一个文件
+    auto baked_texture_path(const std::filesystem::path &source_path) -> std::filesystem::path {
+        auto path = source_path;
+        path += BAKED_TEXTURE_EXTENSION;
+        return path;
+    }
+
+    /**
+     * 只读内存映射的文件，析构时解除映射
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Failed to open file: " + path.string());
+            }
+            LARGE_INTEGER file_size{};
+            GetFileSizeEx(file, &file_size);
+            size = static_cast<std::size_t>(file_size.QuadPart);
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                CloseHandle(file);
+                throw std::runtime_error("Failed to map file: " + path.string());
+            }
+            data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (data == nullptr) {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error("Failed to map file: " + path.string());
+            }
+#else
+            const auto descriptor = open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                throw std::runtime_error("Failed to open file: " + path.string());
+            }
+            struct stat status{};
+            fstat(descriptor, &status);
+            size = static_cast<std::size_t>(status.st_size);
+            auto *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            close(descriptor);
+            if (address == MAP_FAILED) {
+                throw std::runtime_error("Failed to map file: " + path.string());
+            }
+            // 在加载线程上提前把页面读进来，渲染线程拷贝时就不会再触发缺页
+            madvise(address, size, MADV_WILLNEED);
+            data = static_cast<const std::byte *>(address);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+            CloseHandle(mapping);
+            CloseHandle(file);
+#else
+            munmap(const_cast<std::byte *>(data), size);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+        [[nodiscard]] auto bytes() const -> std::span<const std::byte> { return {data, size}; }
+
+    private:
+        const std::byte *data = nullptr;
+        std::size_t size = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+    };
+
+    /**
+     * 映射并校验 .gtex 文件，返回的每层像素都直接指向映射内存
+     * 文件截断、魔数或版本不符、各层大小与宽高通道数对不上时抛出异常
+     */
+    class BakedTexture {
+    public:
+        explicit BakedTexture(const std::filesystem::path &path) : file(std::make_shared<MappedFile>(path)) {
+            const auto bytes = file->bytes();
+            if (bytes.size() < sizeof(BakedTextureHeader)) {
+                throw std::runtime_error("Baked texture is truncated: " + path.string());
+            }
+            std::memcpy(&header, bytes.data(), sizeof(header));
+            if (header.magic != BAKED_TEXTURE_MAGIC) {
+                throw std::runtime_error("Invalid baked texture: " + path.string());
+            }
+            if (header.version != BAKED_TEXTURE_VERSION) {
+                throw std::runtime_error("Baked texture version " + std::to_string(header.version) +
+                                         " does not match " + std::to_string(BAKED_TEXTURE_VERSION) + ": " +
+                                         path.string());
+            }
+            if (header.level_count == 0 || header.level_count > BAKED_TEXTURE_MAX_LEVELS ||
+                (header.channels != 1 && header.channels != 3 && header.channels != 4)) {
+                throw std::runtime_error("Invalid baked texture: " + path.string());
+            }
+            for (std::uint32_t i = 0; i < header.level_count; ++i) {
+                const auto &level = header.levels[i];
+                if (level.offset > bytes.size() || level.size > bytes.size() - level.offset) {
+                    throw std::runtime_error("Baked texture is truncated: " + path.string());
+                }
+                // 上传时按 max(size >> i, 1) 推算每一级的尺寸，头部记录的尺寸必须与之一致
+                if (level.width != std::max(header.width >> i, 1u) ||
+                    level.height != std::max(header.height >> i, 1u) ||
+                    level.size != std::uint64_t{level.width} * level.height * header.channels) {
+                    throw std::runtime_error("Baked texture level size mismatch: " + path.string());
+                }
+            }
+        }
+
+        [[nodiscard]] auto get_header() const -> const BakedTextureHeader & { return header; }
+
+        [[nodiscard]] auto level_pixels(const std::uint32_t level) const -> std::span<const std::byte> {
+            const auto &info = header.levels[level];
+            return file->bytes().subspan(info.offset, info.size);
+        }
+
+        /// 与像素指针共享所有权，只要还有人持有映射就不会被解除
+        [[nodiscard]] auto get_mapping() const -> std::shared_ptr<const MappedFile> { return file; }
+
+    private:
+        std::shared_ptr<const MappedFile> file;
+        BakedTextureHeader header{};
+    };
+} // namespace first_opengl
@@ -0,0 +1,92 @@
+module;
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+export module first_opengl.concurrent_queue;
+
+export namespace first_opengl {
+    /**
+     * 有界的无锁多生产者多消费者队列（Dmitry Vyukov 的环形队列）
+     * 每个槽位带一个序号，生产者/消费者只在各自的位置计数器上做 CAS，不需要互斥锁
+     * 容量会向上取整到 2 的幂；队列满时 try_push 返回 false，空时 try_pop 返回 std::nullopt
+     */
+    template<typename T>
+    class ConcurrentQueue {
+    public:
+        explicit ConcurrentQueue(const std::size_t capacity) :
+            cells(std::make_unique<Cell[]>(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity))),
+            mask(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1) {
+            for (std::size_t i = 0; i <= mask; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ConcurrentQueue(const ConcurrentQueue &) = delete;
+        auto operator=(const ConcurrentQueue &) -> ConcurrentQueue & = delete;
+
+        /// 只有成功时才会移走 value，失败时调用方可以继续重试
+        auto try_push(T &&value) -> bool {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                auto &cell = cells[position & mask];
+                const auto sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        auto try_pop() -> std::optional<T> {
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                auto &cell = cells[position & mask];
+                const auto sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference =
+                        static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        std::optional<T> value{std::move(cell.value)};
+                        cell.sequence.store(position + mask + 1, std::memory_order_release);
+                        return value;
+                    }
+                }
+                else if (difference < 0) {
+                    return std::nullopt;
+                }
+                else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        [[nodiscard]] auto capacity() const -> std::size_t { return mask + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence{0};
+            T value{};
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        std::size_t mask;
+        // 两个计数器放在不同的缓存行，避免生产者和消费者互相伪共享
+        alignas(64) std::atomic<std::size_t> enqueue_position{0};
+        alignas(64) std::atomic<std::size_t> dequeue_position{0};
+    };
+} // namespace first_opengl
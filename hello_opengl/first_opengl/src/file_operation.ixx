@@ -1,20 +1,32 @@
 module;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <glad/glad.h>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <string_view>
+#include <vector>
 
 
 export module first_opengl.file_operation;
 
+import first_opengl.baked_texture;
+
 export struct ImageData {
     unsigned char *data;
     int width;
     int height;
     int channels;
+    // 来自 .gtex 时 data 指向映射内存，levels 为预先算好的全部 mip 层，不需要 glGenerateMipmap
+    std::shared_ptr<const first_opengl::MappedFile> mapping;
+    std::vector<std::span<const std::byte>> levels;
 };
 
 export namespace first_opengl {
@@ -54,7 +66,34 @@ export namespace first_opengl {
         return shader;
     }
 
+    /**
+     * 加载图片：同目录下有烘焙好的 .gtex 时直接内存映射，不做任何解码；否则用 stb_image 解码
+     * .gtex 截断、损坏或格式版本不符时记一条日志，退回解码源图片
+     * 返回的数据用 free_image 释放
+     */
     auto load_image(const std::string_view &file_path) -> ImageData {
+        if (const auto baked_path = baked_texture_path(std::filesystem::path{file_path});
+            std::filesystem::exists(baked_path)) {
+            try {
+                const BakedTexture baked{baked_path};
+                const auto &header = baked.get_header();
+                ImageData image_data{};
+                image_data.width = static_cast<int>(header.width);
+                image_data.height = static_cast<int>(header.height);
+                image_data.channels = static_cast<int>(header.channels);
+                image_data.mapping = baked.get_mapping();
+                for (std::uint32_t level = 0; level < header.level_count; ++level) {
+                    image_data.levels.push_back(baked.level_pixels(level));
+                }
+                image_data.data = const_cast<unsigned char *>(
+                        reinterpret_cast<const unsigned char *>(image_data.levels.front().data()));
+                return image_data;
+            }
+            catch (const std::exception &e) {
+                SDL_Log("%s, decoding %s instead", e.what(), std::string(file_path).c_str());
+            }
+        }
+
         //检查 文件是否存在
         if (!std::filesystem::exists(file_path)) {
             throw std::runtime_error("File does not exist: " + std::string(file_path));
@@ -67,6 +106,15 @@ export namespace first_opengl {
         return image_data;
     }
 
+    auto free_image(ImageData &image_data) -> void {
+        if (image_data.mapping == nullptr) {
+            stbi_image_free(image_data.data);
+        }
+        image_data.data = nullptr;
+        image_data.mapping.reset();
+        image_data.levels.clear();
+    }
+
     auto get_image_format(const ImageData &image_data) -> GLenum {
         GLenum format = GL_RGB;
         if (image_data.channels == 1)
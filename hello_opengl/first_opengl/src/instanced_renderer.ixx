@@ -0,0 +1,79 @@
+module;
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <span>
+
+export module first_opengl.instanced_renderer;
+
+import gl_common.mesh;
+
+export namespace first_opengl {
+    /**
+     * 实例化渲染：把每个实例的 model 矩阵打包进实例 VBO，
+     * 通过 glVertexAttribDivisor 让矩阵按实例前进，一次 glDrawElementsInstanced 画完所有实例
+     */
+    class InstancedRenderer {
+    public:
+        /// mat4 属性占用 4 个连续的 location：2、3、4、5
+        static constexpr GLuint MODEL_ATTRIBUTE_LOCATION = 2;
+
+        /**
+         * @param vertex_array_object 已经配置好网格顶点属性的 VAO，实例属性会追加到它上面
+         */
+        explicit InstancedRenderer(const unsigned int vertex_array_object) : vertex_array(vertex_array_object) {
+            glGenBuffers(1, &instance_buffer);
+
+            glBindVertexArray(vertex_array);
+            glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+            for (GLuint column = 0; column < 4; ++column) {
+                const auto location = MODEL_ATTRIBUTE_LOCATION + column;
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                      reinterpret_cast<void *>(column * sizeof(glm::vec4)));
+                glVertexAttribDivisor(location, 1);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+        }
+
+        ~InstancedRenderer() { glDeleteBuffers(1, &instance_buffer); }
+
+        InstancedRenderer(const InstancedRenderer &) = delete;
+        auto operator=(const InstancedRenderer &) -> InstancedRenderer & = delete;
+
+        /**
+         * 上传本帧的实例矩阵；容量足够时先 orphan 旧存储再写入，避免等待上一帧的绘制完成
+         */
+        auto upload(const std::span<const glm::mat4> models) -> void {
+            const auto bytes = static_cast<GLsizeiptr>(models.size_bytes());
+            glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+            if (models.size() > capacity) {
+                capacity = models.size();
+                glBufferData(GL_ARRAY_BUFFER, bytes, models.data(), GL_STREAM_DRAW);
+            }
+            else {
+                glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(glm::mat4)), nullptr,
+                             GL_STREAM_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, models.data());
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            instance_count = models.size();
+        }
+
+        /// mesh 必须是构造时传入 VAO 的那个网格，索引缓冲已经记录在 VAO 中
+        auto draw(const gl_common::Mesh &mesh) const -> void {
+            glBindVertexArray(vertex_array);
+            glDrawElementsInstanced(GL_TRIANGLES, mesh.get_index_count(), mesh.get_index_type(), nullptr,
+                                    static_cast<GLsizei>(instance_count));
+        }
+
+        [[nodiscard]] auto get_instance_count() const -> std::size_t { return instance_count; }
+
+    private:
+        unsigned int vertex_array{};
+        unsigned int instance_buffer{};
+        std::size_t capacity = 0;
+        std::size_t instance_count = 0;
+    };
+} // namespace first_opengl
@@ -1,5 +1,9 @@
 module;
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,10 +16,13 @@ module;
 
 export module first_opengl.sandbox;
 
+import gl_common.mesh;
 import first_opengl.app;
 import first_opengl.window;
 import first_opengl.shader;
 import first_opengl.file_operation;
+import first_opengl.instanced_renderer;
+import first_opengl.texture_cache;
 
 export namespace first_opengl {
     class Sandbox : public Application {
@@ -28,108 +35,95 @@ export namespace first_opengl {
             shader_program = std::make_shared<Shader>("./res/shader/first_vert.glsl", "./res/shader/first_frag.glsl");
             shader_program->use();
 
-            // Set up vertex data and buffers and configure vertex attributes
-            glGenVertexArrays(1, &vertex_array_object);
-            glBindVertexArray(vertex_array_object);
-
-            glGenBuffers(1, &vertex_buffer_object);
-            glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-            // Position attribute
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void *>(0));
-            glEnableVertexAttribArray(0);
+            // 展开的 36 个顶点焊接成 16 个顶点 + 索引，UV 使用半精度存储
+            using gl_common::AttributeFormat;
+            using gl_common::VertexAttribute;
+            constexpr std::array layout{
+                    VertexAttribute{.location = 0, .components = 3, .format = AttributeFormat::Float32},
+                    VertexAttribute{.location = 1, .components = 2, .format = AttributeFormat::Half16},
+            };
+            cube_mesh = std::make_unique<gl_common::Mesh>(gl_common::build_indexed_mesh(vertices, 5), layout);
 
-            // Texture coord attribute
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-                                  reinterpret_cast<void *>(3 * sizeof(float)));
-            glEnableVertexAttribArray(1);
+            const auto before = gl_common::expanded_stats(vertices, 5);
+            const auto &after = cube_mesh->get_stats();
+            SDL_Log("Cube mesh: %zu -> %zu bytes uploaded, %zu -> %zu vertices shaded (%zu vertices, %zu indices)",
+                    before.bytes_uploaded, after.bytes_uploaded, before.vertices_shaded, after.vertices_shaded,
+                    after.vertex_count, after.index_count);
 
+            // 解码放到工作线程，这里只拿到带占位图的纹理句柄，第一帧不必等待图片加载
+            // 同一路径 + 采样参数只会加载一次，重复 acquire 直接复用
             stbi_set_flip_vertically_on_load(true);
-
-            // Texture 1
-            glActiveTexture(GL_TEXTURE0);
-            glGenTextures(1, &texture_1);
-            glBindTexture(GL_TEXTURE_2D, texture_1);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            if (const auto img_data = load_image("./res/image/oak_planks.png"); img_data.data != nullptr) {
-                const auto format = get_image_format(img_data);
-                glTexImage2D(GL_TEXTURE_2D, 0, format, img_data.width, img_data.height, 0, format, GL_UNSIGNED_BYTE,
-                             img_data.data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-                stbi_image_free(img_data.data);
-            }
-            else {
-                // In a robust app, handle error gracefully
-                stbi_image_free(img_data.data);
-            }
-
-            // Texture 2
-            glActiveTexture(GL_TEXTURE1);
-            glGenTextures(1, &texture_2);
-            glBindTexture(GL_TEXTURE_2D, texture_2);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            if (const auto img_data = load_image("./res/image/diamond_pickaxe.png"); img_data.data != nullptr) {
-                const auto format = get_image_format(img_data);
-                glTexImage2D(GL_TEXTURE_2D, 0, format, img_data.width, img_data.height, 0, format, GL_UNSIGNED_BYTE,
-                             img_data.data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-                stbi_image_free(img_data.data);
-            }
-            else {
-                stbi_image_free(img_data.data);
-            }
+            texture_cache = std::make_unique<TextureCache>();
+            texture_1 = texture_cache->acquire("./res/image/oak_planks.png");
+            texture_2 = texture_cache->acquire("./res/image/diamond_pickaxe.png");
 
             shader_program->set_int("texture1", 0);
             shader_program->set_int("texture2", 1);
 
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glBindVertexArray(0);
+            instanced_shader =
+                    std::make_shared<Shader>("./res/shader/instanced_vert.glsl", "./res/shader/first_frag.glsl");
+            instanced_shader->use();
+            instanced_shader->set_int("texture1", 0);
+            instanced_shader->set_int("texture2", 1);
+            instanced_renderer = std::make_unique<InstancedRenderer>(cube_mesh->get_vertex_array());
+
+            set_cube_count(cube_count_presets.front());
+            last_frame_ns = SDL_GetTicksNS();
+            last_report_ns = last_frame_ns;
         }
 
         void on_update(double delta_time) override {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texture_1);
+            const auto frame_start_ns = SDL_GetTicksNS();
 
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, texture_2);
-
-            shader_program->use();
+            // 先上传已经解码完成的纹理，再绑定本帧要用的纹理
+            texture_cache->update();
+            texture_1.bind(0);
+            texture_2.bind(1);
 
             // Projection setup
             glm::mat4 projection = glm::perspective(
                     glm::radians(45.0f),
                     static_cast<float>(window.get_width()) / static_cast<float>(window.get_height()), 0.1f, 100.0f);
-            shader_program->set_mat4("projection", projection);
 
             // View setup
             glm::mat4 view = glm::lookAt(camera_pos, camera_pos + camera_front, camera_up);
-            auto view_loc = glGetUniformLocation(shader_program->get_id(), "view");
-            glUniformMatrix4fv(view_loc, 1, GL_FALSE, glm::value_ptr(view));
-
-            auto model_loc = glGetUniformLocation(shader_program->get_id(), "model");
 
-            glBindVertexArray(vertex_array_object);
-
-            for (unsigned int i = 0; i < 10; i++) {
+            const auto seconds = static_cast<float>(SDL_GetTicks()) / 1000.0f;
+            for (std::size_t i = 0; i < cube_positions.size(); i++) {
                 glm::mat4 model = glm::mat4(1.0f);
                 model = glm::translate(model, cube_positions[i]);
-                float angle = 20.0f * i;
-                model = glm::rotate(
-                        model, glm::radians(angle) + static_cast<float>(SDL_GetTicks()) / 1000.0f * glm::radians(50.0f),
-                        glm::vec3(1.0f, 0.3f, 0.5f));
-                glUniformMatrix4fv(model_loc, 1, GL_FALSE, glm::value_ptr(model));
+                float angle = 20.0f * static_cast<float>(i % 10);
+                model = glm::rotate(model, glm::radians(angle) + seconds * glm::radians(50.0f),
+                                    glm::vec3(1.0f, 0.3f, 0.5f));
+                cube_models[i] = model;
+            }
+
+            if (use_instancing) {
+                instanced_shader->use();
+                instanced_shader->set_mat4("projection", projection);
+                instanced_shader->set_mat4("view", view);
+
+                instanced_renderer->upload(cube_models);
+                instanced_renderer->draw(*cube_mesh);
+            }
+            else {
+                shader_program->use();
+                shader_program->set_mat4("projection", projection);
+
+                auto view_loc = glGetUniformLocation(shader_program->get_id(), "view");
+                glUniformMatrix4fv(view_loc, 1, GL_FALSE, glm::value_ptr(view));
+
+                auto model_loc = glGetUniformLocation(shader_program->get_id(), "model");
+
+                cube_mesh->bind();
 
-                glDrawArrays(GL_TRIANGLES, 0, 36);
+                for (const auto &model: cube_models) {
+                    glUniformMatrix4fv(model_loc, 1, GL_FALSE, glm::value_ptr(model));
+                    cube_mesh->draw();
+                }
             }
+
+            record_frame_time(frame_start_ns);
         }
 
         auto on_event(const SDL_Event &event) -> SDL_AppResult override {
@@ -152,6 +146,19 @@ export namespace first_opengl {
                 if (event.key.scancode == SDL_SCANCODE_D) {
                     camera_pos += glm::normalize(glm::cross(camera_front, camera_up)) * camera_speed;
                 }
+                // I：切换逐个绘制 / 实例化绘制；1~4：切换立方体数量；V：开关垂直同步（测量时关闭）
+                if (event.key.scancode == SDL_SCANCODE_I) {
+                    use_instancing = not use_instancing;
+                    reset_frame_stats();
+                }
+                if (event.key.scancode >= SDL_SCANCODE_1 && event.key.scancode <= SDL_SCANCODE_4) {
+                    set_cube_count(cube_count_presets[event.key.scancode - SDL_SCANCODE_1]);
+                }
+                if (event.key.scancode == SDL_SCANCODE_V) {
+                    vsync_enabled = not vsync_enabled;
+                    SDL_GL_SetSwapInterval(vsync_enabled ? 1 : 0);
+                    reset_frame_stats();
+                }
                 return SDL_APP_CONTINUE;
             };
 
@@ -188,19 +195,73 @@ export namespace first_opengl {
 
         void on_quit() override {
             // Cleanup if needed (shared_ptr handles shader)
-            glDeleteVertexArrays(1, &vertex_array_object);
-            glDeleteBuffers(1, &vertex_buffer_object);
-            glDeleteTextures(1, &texture_1);
-            glDeleteTextures(1, &texture_2);
+            texture_1.reset();
+            texture_2.reset();
+            texture_cache.reset();
+            instanced_renderer.reset();
+            cube_mesh.reset();
         }
 
     private:
+        /**
+         * 前 10 个立方体沿用原来的位置，其余的排成立方体阵列放在场景后方
+         */
+        auto set_cube_count(const std::size_t count) -> void {
+            cube_positions.assign(classic_cube_positions.begin(),
+                                  classic_cube_positions.begin() +
+                                          static_cast<std::ptrdiff_t>(std::min(count, classic_cube_positions.size())));
+
+            const auto extra = count - cube_positions.size();
+            const auto side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(extra))));
+            for (std::size_t i = 0; i < extra; ++i) {
+                const auto x = static_cast<float>(i % side) - static_cast<float>(side) / 2.0f;
+                const auto y = static_cast<float>(i / side % side) - static_cast<float>(side) / 2.0f;
+                const auto z = static_cast<float>(i / (side * side));
+                cube_positions.emplace_back(x * 1.5f, y * 1.5f, -20.0f - z * 1.5f);
+            }
+
+            cube_models.resize(cube_positions.size());
+            reset_frame_stats();
+            SDL_Log("Cube count: %zu", cube_positions.size());
+        }
+
+        auto reset_frame_stats() -> void {
+            frame_count = 0;
+            frame_time_sum_ns = 0;
+            update_time_sum_ns = 0;
+        }
+
+        /**
+         * 统计帧间隔（包含 swap）和 on_update 本身的 CPU 耗时，每 0.5 秒刷新一次窗口标题
+         */
+        auto record_frame_time(const Uint64 frame_start_ns) -> void {
+            const auto now = SDL_GetTicksNS();
+            frame_time_sum_ns += frame_start_ns - last_frame_ns;
+            update_time_sum_ns += now - frame_start_ns;
+            last_frame_ns = frame_start_ns;
+            ++frame_count;
+
+            if (now - last_report_ns < 500'000'000) {
+                return;
+            }
+            const auto frames = static_cast<double>(frame_count);
+            const auto title = std::format("first opengl | {} | {} cubes | {:.2f} ms/frame | update {:.2f} ms",
+                                           use_instancing ? "instanced" : "per-draw", cube_positions.size(),
+                                           static_cast<double>(frame_time_sum_ns) / frames / 1e6,
+                                           static_cast<double>(update_time_sum_ns) / frames / 1e6);
+            SDL_SetWindowTitle(window.get_native_window(), title.c_str());
+            last_report_ns = now;
+            reset_frame_stats();
+        }
+
         Window &window;
         std::shared_ptr<Shader> shader_program = nullptr;
-        unsigned int vertex_array_object{};
-        unsigned int vertex_buffer_object{};
-        unsigned int texture_1{};
-        unsigned int texture_2{};
+        std::shared_ptr<Shader> instanced_shader = nullptr;
+        std::unique_ptr<InstancedRenderer> instanced_renderer = nullptr;
+        std::unique_ptr<gl_common::Mesh> cube_mesh = nullptr;
+        std::unique_ptr<TextureCache> texture_cache = nullptr;
+        TextureHandle texture_1{};
+        TextureHandle texture_2{};
 
         glm::vec3 camera_pos{0.0f, 0.0f, 3.0f};
         glm::vec3 camera_front{0.0f, 0.0f, -1.0f};
@@ -210,11 +271,23 @@ export namespace first_opengl {
         float pitch = 0.0f;
         float sensitivity = 0.1f;
 
-        const std::vector<glm::vec3> cube_positions = {glm::vec3(0.0f, 0.0f, 0.0f),    glm::vec3(2.0f, 5.0f, -15.0f),
-                                                       glm::vec3(-1.5f, -2.2f, -2.5f), glm::vec3(-3.8f, -2.0f, -12.3f),
-                                                       glm::vec3(2.4f, -0.4f, -3.5f),  glm::vec3(-1.7f, 3.0f, -7.5f),
-                                                       glm::vec3(1.3f, -2.0f, -2.5f),  glm::vec3(1.5f, 2.0f, -2.5f),
-                                                       glm::vec3(1.5f, 0.2f, -1.5f),   glm::vec3(-1.3f, 1.0f, -1.5f)};
+        bool use_instancing = true;
+        bool vsync_enabled = true;
+        static constexpr std::array<std::size_t, 4> cube_count_presets{10, 1'000, 10'000, 100'000};
+
+        Uint64 last_frame_ns = 0;
+        Uint64 last_report_ns = 0;
+        Uint64 frame_time_sum_ns = 0;
+        Uint64 update_time_sum_ns = 0;
+        Uint64 frame_count = 0;
+
+        const std::vector<glm::vec3> classic_cube_positions = {
+                glm::vec3(0.0f, 0.0f, 0.0f),    glm::vec3(2.0f, 5.0f, -15.0f), glm::vec3(-1.5f, -2.2f, -2.5f),
+                glm::vec3(-3.8f, -2.0f, -12.3f), glm::vec3(2.4f, -0.4f, -3.5f), glm::vec3(-1.7f, 3.0f, -7.5f),
+                glm::vec3(1.3f, -2.0f, -2.5f),  glm::vec3(1.5f, 2.0f, -2.5f),  glm::vec3(1.5f, 0.2f, -1.5f),
+                glm::vec3(-1.3f, 1.0f, -1.5f)};
+        std::vector<glm::vec3> cube_positions{};
+        std::vector<glm::mat4> cube_models{};
 
         const std::vector<float> vertices = {
                 -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 0.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
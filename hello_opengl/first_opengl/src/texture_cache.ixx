@@ -0,0 +1,335 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module first_opengl.texture_cache;
+
+import first_opengl.texture_loader;
+
+export namespace first_opengl {
+    /// 纹理的采样参数，与规范化后的路径一起组成缓存键
+    struct SamplerParams {
+        GLint wrap_s = GL_REPEAT;
+        GLint wrap_t = GL_REPEAT;
+        GLint min_filter = GL_NEAREST_MIPMAP_NEAREST;
+        GLint mag_filter = GL_NEAREST;
+
+        auto operator<=>(const SamplerParams &) const = default;
+    };
+
+    class TextureCache;
+
+    /**
+     * 引用计数的纹理句柄，可以复制，最后一个句柄释放后纹理仍留在缓存中，直到被 LRU 淘汰
+     * 句柄不能比创建它的 TextureCache 活得更久
+     */
+    class TextureHandle {
+    public:
+        TextureHandle() = default;
+        TextureHandle(const TextureHandle &other);
+        TextureHandle(TextureHandle &&other) noexcept;
+        auto operator=(const TextureHandle &other) -> TextureHandle &;
+        auto operator=(TextureHandle &&other) noexcept -> TextureHandle &;
+        ~TextureHandle();
+
+        /**
+         * 绑定到指定纹理单元，同时刷新 LRU 时间戳
+         * 如果纹理因为超出预算被淘汰过，会重新发起异步加载，加载完成前显示占位图
+         */
+        auto bind(unsigned int unit) const -> void;
+
+        /// 当前的 GL 纹理 id，淘汰后重新加载会变化，所以不要长期保存
+        [[nodiscard]] auto get_id() const -> unsigned int;
+
+        auto reset() -> void;
+
+        explicit operator bool() const { return cache != nullptr; }
+
+    private:
+        friend class TextureCache;
+        TextureHandle(TextureCache *owner, std::uint32_t entry_slot);
+
+        TextureCache *cache = nullptr;
+        std::uint32_t slot = 0;
+    };
+
+    /**
+     * 按 规范化路径 + 采样参数 去重的纹理缓存
+     * 同一张图片无论请求多少次只解码、上传一次；统计常驻显存字节数，
+     * 超过预算时按最近最少使用的顺序淘汰：先淘汰没有句柄引用的纹理，
+     * 仍然不够时再释放本帧没有使用过的纹理的显存（句柄保留，下次 bind 时重新加载）
+     */
+    class TextureCache {
+    public:
+        /// 默认 256 MiB
+        static constexpr std::size_t DEFAULT_BUDGET_BYTES = std::size_t{256} << 20;
+
+        explicit TextureCache(const std::size_t budget_bytes = DEFAULT_BUDGET_BYTES) :
+            loader(std::make_unique<TextureLoader>()), budget(budget_bytes) {
+            loader->set_upload_callback([this](const TextureLoader::UploadEvent &event) { on_uploaded(event); });
+        }
+
+        ~TextureCache() {
+            loader.reset();
+            for (const auto &entry: entries) {
+                if (entry.texture != 0) {
+                    glDeleteTextures(1, &entry.texture);
+                }
+            }
+        }
+
+        TextureCache(const TextureCache &) = delete;
+        auto operator=(const TextureCache &) -> TextureCache & = delete;
+
+        /**
+         * 获取纹理句柄，已经存在的纹理直接复用，否则发起异步加载
+         */
+        auto acquire(const std::string_view file_path, const SamplerParams &sampler = {}) -> TextureHandle {
+            Key key{canonical_path(file_path), sampler};
+            if (const auto it = lookup.find(key); it != lookup.end()) {
+                ++hit_count;
+                return TextureHandle{this, it->second};
+            }
+
+            std::uint32_t slot;
+            if (not free_slots.empty()) {
+                slot = free_slots.back();
+                free_slots.pop_back();
+            }
+            else {
+                slot = static_cast<std::uint32_t>(entries.size());
+                entries.emplace_back();
+            }
+
+            auto &entry = entries[slot];
+            entry = Entry{.path = key.path, .sampler = sampler, .last_used = frame_index};
+            lookup.emplace(std::move(key), slot);
+            start_load(slot);
+            ++miss_count;
+            return TextureHandle{this, slot};
+        }
+
+        /**
+         * 每帧调用一次：在时间预算内上传已经解码好的纹理，然后把常驻显存压回预算以内
+         */
+        auto update(const Uint64 upload_budget_ns = TextureLoader::DEFAULT_UPLOAD_BUDGET_NS) -> void {
+            loader->pump(upload_budget_ns);
+            trim();
+            ++frame_index;
+        }
+
+        auto set_budget(const std::size_t budget_bytes) -> void {
+            budget = budget_bytes;
+            trim();
+        }
+
+        [[nodiscard]] auto get_budget() const -> std::size_t { return budget; }
+        [[nodiscard]] auto get_resident_bytes() const -> std::size_t { return resident_bytes; }
+        [[nodiscard]] auto get_texture_count() const -> std::size_t { return lookup.size(); }
+        [[nodiscard]] auto get_hit_count() const -> std::size_t { return hit_count; }
+        [[nodiscard]] auto get_miss_count() const -> std::size_t { return miss_count; }
+
+    private:
+        friend class TextureHandle;
+
+        enum class State {
+            Loading, ///< 占位图已创建，正在解码或等待上传
+            Resident, ///< 已上传，计入常驻显存
+            Evicted, ///< 显存已释放，但仍有句柄引用
+            Failed, ///< 解码失败，继续使用占位图，不计入常驻显存也不参与淘汰
+        };
+
+        struct Entry {
+            std::string path;
+            SamplerParams sampler{};
+            unsigned int texture = 0;
+            std::size_t bytes = 0;
+            std::uint32_t ref_count = 0;
+            std::uint64_t last_used = 0;
+            State state = State::Loading;
+        };
+
+        struct Key {
+            std::string path;
+            SamplerParams sampler;
+
+            auto operator<=>(const Key &) const = default;
+        };
+
+        static auto canonical_path(const std::string_view file_path) -> std::string {
+            std::error_code error;
+            auto path = std::filesystem::weakly_canonical(std::filesystem::path{file_path}, error);
+            if (error) {
+                path = std::filesystem::absolute(std::filesystem::path{file_path}, error).lexically_normal();
+            }
+            return path.string();
+        }
+
+        auto start_load(const std::uint32_t slot) -> void {
+            auto &entry = entries[slot];
+            entry.texture = loader->request(entry.path);
+            entry.state = State::Loading;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampler.wrap_s);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampler.wrap_t);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.sampler.min_filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampler.mag_filter);
+            texture_slots[entry.texture] = slot;
+        }
+
+        auto on_uploaded(const TextureLoader::UploadEvent &event) -> void {
+            const auto it = texture_slots.find(event.texture);
+            if (it == texture_slots.end()) {
+                return;
+            }
+            auto &entry = entries[it->second];
+            if (not event.success) {
+                entry.state = State::Failed;
+                entry.bytes = 0;
+                return;
+            }
+            entry.state = State::Resident;
+            entry.bytes = event.bytes;
+            resident_bytes += event.bytes;
+        }
+
+        auto add_ref(const std::uint32_t slot) -> void { ++entries[slot].ref_count; }
+
+        auto release(const std::uint32_t slot) -> void { --entries[slot].ref_count; }
+
+        auto bind(const std::uint32_t slot, const unsigned int unit) -> void {
+            auto &entry = entries[slot];
+            entry.last_used = frame_index;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            if (entry.state == State::Evicted) {
+                start_load(slot);
+            }
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+        }
+
+        auto release_gpu_memory(Entry &entry) -> void {
+            texture_slots.erase(entry.texture);
+            glDeleteTextures(1, &entry.texture);
+            entry.texture = 0;
+            resident_bytes -= entry.bytes;
+            entry.bytes = 0;
+        }
+
+        /**
+         * 淘汰顺序：没有引用的纹理优先，其次是本帧未使用的纹理，各自按 last_used 从旧到新
+         * 正在加载的纹理不参与淘汰，避免加载线程写入已经删除的纹理对象
+         */
+        auto trim() -> void {
+            if (resident_bytes <= budget) {
+                return;
+            }
+
+            std::vector<std::uint32_t> candidates;
+            for (const auto &[key, slot]: lookup) {
+                const auto &entry = entries[slot];
+                if (entry.state == State::Resident && entry.last_used < frame_index) {
+                    candidates.push_back(slot);
+                }
+            }
+            std::ranges::sort(candidates, [this](const std::uint32_t a, const std::uint32_t b) {
+                const auto &lhs = entries[a];
+                const auto &rhs = entries[b];
+                return std::pair{lhs.ref_count != 0, lhs.last_used} < std::pair{rhs.ref_count != 0, rhs.last_used};
+            });
+
+            std::size_t evicted = 0;
+            const auto before = resident_bytes;
+            for (const auto slot: candidates) {
+                if (resident_bytes <= budget) {
+                    break;
+                }
+                auto &entry = entries[slot];
+                release_gpu_memory(entry);
+                if (entry.ref_count == 0) {
+                    lookup.erase(Key{entry.path, entry.sampler});
+                    entry = Entry{};
+                    free_slots.push_back(slot);
+                }
+                else {
+                    entry.state = State::Evicted;
+                }
+                ++evicted;
+            }
+
+            if (evicted > 0) {
+                SDL_Log("Texture cache evicted %zu textures (%zu -> %zu bytes, budget %zu)", evicted, before,
+                        resident_bytes, budget);
+            }
+        }
+
+        std::unique_ptr<TextureLoader> loader;
+        std::vector<Entry> entries;
+        std::vector<std::uint32_t> free_slots;
+        std::map<Key, std::uint32_t> lookup;
+        std::unordered_map<unsigned int, std::uint32_t> texture_slots;
+        std::size_t budget;
+        std::size_t resident_bytes = 0;
+        std::size_t hit_count = 0;
+        std::size_t miss_count = 0;
+        std::uint64_t frame_index = 0;
+    };
+
+    TextureHandle::TextureHandle(TextureCache *owner, const std::uint32_t entry_slot) : cache(owner), slot(entry_slot) {
+        cache->add_ref(slot);
+    }
+
+    TextureHandle::TextureHandle(const TextureHandle &other) : cache(other.cache), slot(other.slot) {
+        if (cache != nullptr) {
+            cache->add_ref(slot);
+        }
+    }
+
+    TextureHandle::TextureHandle(TextureHandle &&other) noexcept :
+        cache(std::exchange(other.cache, nullptr)), slot(other.slot) {}
+
+    auto TextureHandle::operator=(const TextureHandle &other) -> TextureHandle & {
+        if (this != &other) {
+            TextureHandle copy{other};
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    auto TextureHandle::operator=(TextureHandle &&other) noexcept -> TextureHandle & {
+        if (this != &other) {
+            reset();
+            cache = std::exchange(other.cache, nullptr);
+            slot = other.slot;
+        }
+        return *this;
+    }
+
+    TextureHandle::~TextureHandle() { reset(); }
+
+    auto TextureHandle::reset() -> void {
+        if (cache != nullptr) {
+            cache->release(slot);
+            cache = nullptr;
+        }
+    }
+
+    auto TextureHandle::bind(const unsigned int unit) const -> void {
+        if (cache != nullptr) {
+            cache->bind(slot, unit);
+        }
+    }
+
+    auto TextureHandle::get_id() const -> unsigned int { return cache != nullptr ? cache->entries[slot].texture : 0; }
+} // namespace first_opengl
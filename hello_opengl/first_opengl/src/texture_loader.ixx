@@ -0,0 +1,274 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <glad/glad.h>
+#include <semaphore>
+#include <span>
+#include <stb_image.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+export module first_opengl.texture_loader;
+
+import first_opengl.file_operation;
+import first_opengl.concurrent_queue;
+
+export namespace first_opengl {
+    /**
+     * 异步纹理加载：
+     * 1. request() 在渲染线程立即创建纹理对象并填入占位图，返回的纹理 id 可以马上绑定使用
+     * 2. 工作线程池用 stb_image 解码，解码结果通过无锁队列交回渲染线程
+     * 3. 渲染线程每帧调用 pump()，在时间预算内经由 PBO 把像素上传到同一个纹理对象并生成 mipmap
+     * 这样 on_init 不再阻塞在解码上，第一帧可以立刻显示，真实纹理到达后自动替换占位图
+     */
+    class TextureLoader {
+    public:
+        /// 默认每帧最多花 2 ms 上传纹理
+        static constexpr Uint64 DEFAULT_UPLOAD_BUDGET_NS = 2'000'000;
+
+        /// 一个请求处理完毕（成功上传或解码失败）时的通知，bytes 为包含 mipmap 的显存占用估算
+        struct UploadEvent {
+            unsigned int texture{};
+            std::size_t bytes = 0;
+            bool success = false;
+        };
+        using UploadCallback = std::function<void(const UploadEvent &)>;
+
+        explicit TextureLoader(const unsigned int worker_count = default_worker_count()) :
+            requests(QUEUE_CAPACITY), results(QUEUE_CAPACITY), pending_jobs(0) {
+            glGenBuffers(1, &pixel_buffer);
+            workers.reserve(worker_count);
+            for (unsigned int i = 0; i < worker_count; ++i) {
+                workers.emplace_back([this](const std::stop_token &stop) { worker_loop(stop); });
+            }
+            SDL_Log("Texture loader started with %u decode threads", worker_count);
+        }
+
+        ~TextureLoader() {
+            for (auto &worker: workers) {
+                worker.request_stop();
+            }
+            pending_jobs.release(static_cast<std::ptrdiff_t>(workers.size()));
+            workers.clear();
+
+            while (auto result = results.try_pop()) {
+                free_image(result->image);
+            }
+            glDeleteBuffers(1, &pixel_buffer);
+        }
+
+        TextureLoader(const TextureLoader &) = delete;
+        auto operator=(const TextureLoader &) -> TextureLoader & = delete;
+
+        /**
+         * 立即返回一个绑定了占位图的纹理，解码在后台进行
+         * 调用后该纹理仍绑定在当前激活的纹理单元上，调用方可以直接设置采样参数
+         */
+        auto request(const std::string &file_path) -> unsigned int {
+            unsigned int texture{};
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            upload_placeholder();
+
+            if (in_flight.load(std::memory_order_relaxed) == 0) {
+                batch_start_ns = SDL_GetTicksNS();
+            }
+            in_flight.fetch_add(1, std::memory_order_relaxed);
+            ++requested_count;
+
+            Request request{.texture = texture, .path = file_path};
+            while (not requests.try_push(std::move(request))) {
+                std::this_thread::yield();
+            }
+            pending_jobs.release();
+            return texture;
+        }
+
+        /**
+         * 在渲染线程调用，把已经解码好的图片上传到显存，超过时间预算就留到下一帧
+         * 每帧至少上传一张，保证即使预算很小也能前进
+         * 会改变当前激活纹理单元上的 GL_TEXTURE_2D 绑定
+         */
+        auto pump(const Uint64 budget_ns = DEFAULT_UPLOAD_BUDGET_NS) -> void {
+            const auto start_ns = SDL_GetTicksNS();
+            std::size_t uploaded = 0;
+            while (uploaded == 0 || SDL_GetTicksNS() - start_ns < budget_ns) {
+                auto result = results.try_pop();
+                if (not result) {
+                    break;
+                }
+
+                UploadEvent event{.texture = result->texture};
+                if (result->image.data == nullptr) {
+                    SDL_Log("Texture load failed, keeping placeholder: %s", result->error.c_str());
+                }
+                else {
+                    upload(result->texture, result->image);
+                    event.bytes = estimate_bytes(result->image);
+                    event.success = true;
+                    free_image(result->image);
+                }
+                ++uploaded;
+                if (upload_callback) {
+                    upload_callback(event);
+                }
+
+                if (in_flight.fetch_sub(1, std::memory_order_relaxed) == 1) {
+                    SDL_Log("Loaded %zu textures in %.2f ms", requested_count,
+                            static_cast<double>(SDL_GetTicksNS() - batch_start_ns) / 1e6);
+                    requested_count = 0;
+                }
+            }
+        }
+
+        /// 在 pump() 中、渲染线程上调用
+        auto set_upload_callback(UploadCallback callback) -> void { upload_callback = std::move(callback); }
+
+        /// 还没上传完成的纹理数量（包括正在解码的）
+        [[nodiscard]] auto get_pending_count() const -> std::size_t {
+            return in_flight.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Request {
+            unsigned int texture{};
+            std::string path;
+        };
+
+        struct Result {
+            unsigned int texture{};
+            ImageData image{};
+            std::string error;
+        };
+
+        static constexpr std::size_t QUEUE_CAPACITY = 256;
+
+        static auto default_worker_count() -> unsigned int {
+            // 留一个核心给渲染线程
+            const auto hardware = std::thread::hardware_concurrency();
+            return std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, 4u);
+        }
+
+        auto worker_loop(const std::stop_token &stop) -> void {
+            while (true) {
+                pending_jobs.acquire();
+                if (stop.stop_requested()) {
+                    return;
+                }
+                auto request = requests.try_pop();
+                if (not request) {
+                    continue;
+                }
+
+                Result result{.texture = request->texture};
+                try {
+                    result.image = load_image(request->path);
+                }
+                catch (const std::exception &e) {
+                    result.error = e.what();
+                }
+                while (not results.try_push(std::move(result))) {
+                    if (stop.stop_requested()) {
+                        free_image(result.image);
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        /// 每个像素按 4 字节估算（驱动通常会把 RGB 补齐成 RGBA），完整 mipmap 链约为基础层的 4/3
+        static auto estimate_bytes(const ImageData &image) -> std::size_t {
+            const auto base = static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) * 4;
+            return base + base / 3;
+        }
+
+        /// 2x2 品红/黑色棋盘格，生成 mipmap 以满足 *_MIPMAP_* 过滤方式的完整性要求
+        static auto upload_placeholder() -> void {
+            constexpr unsigned char pixels[] = {
+                    255, 0, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 0, 255, 255,
+            };
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+
+        /**
+         * 像素先写入 orphan 过的 PBO，再从 PBO 传给纹理，驱动可以异步完成拷贝
+         * 烘焙过的纹理把所有 mip 层依次放进 PBO 逐层上传，跳过 glGenerateMipmap
+         */
+        auto upload(const unsigned int texture, const ImageData &image) const -> void {
+            const auto format = get_image_format(image);
+            std::vector<std::span<const std::byte>> levels = image.levels;
+            if (levels.empty()) {
+                const auto size = static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) *
+                                  static_cast<std::size_t>(image.channels);
+                levels.emplace_back(reinterpret_cast<const std::byte *>(image.data), size);
+            }
+
+            std::size_t total_size = 0;
+            for (const auto &level: levels) {
+                total_size += level.size();
+            }
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(total_size), nullptr, GL_STREAM_DRAW);
+            if (auto *mapped = static_cast<std::byte *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                                                          static_cast<GLsizeiptr>(total_size),
+                                                                          GL_MAP_WRITE_BIT |
+                                                                                  GL_MAP_INVALIDATE_BUFFER_BIT));
+                mapped != nullptr) {
+                for (const auto &level: levels) {
+                    std::memcpy(mapped, level.data(), level.size());
+                    mapped += level.size();
+                }
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+            else {
+                std::size_t offset = 0;
+                for (const auto &level: levels) {
+                    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(offset),
+                                    static_cast<GLsizeiptr>(level.size()), level.data());
+                    offset += level.size();
+                }
+            }
+
+            // 行是紧密排列的，RGB 图片宽度不是 4 的倍数时需要 1 字节对齐
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < levels.size(); ++i) {
+                const auto width = std::max(image.width >> i, 1);
+                const auto height = std::max(image.height >> i, 1);
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), static_cast<GLint>(format), width, height, 0,
+                             format, GL_UNSIGNED_BYTE, reinterpret_cast<void *>(offset));
+                offset += levels[i].size();
+            }
+            if (image.levels.empty()) {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+            else {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        ConcurrentQueue<Request> requests;
+        ConcurrentQueue<Result> results;
+        std::counting_semaphore<> pending_jobs;
+        std::atomic<std::size_t> in_flight{0};
+        std::size_t requested_count = 0;
+        Uint64 batch_start_ns = 0;
+        UploadCallback upload_callback;
+        unsigned int pixel_buffer{};
+        // 最后声明，析构时最先 join，确保线程结束后队列才销毁
+        std::vector<std::jthread> workers;
+    };
+} // namespace first_opengl
@@ -9,6 +9,7 @@ module;
 
 export module first_opengl.window;
 
+import app_runtime.profiler;
 import first_opengl.app;
 
 export namespace first_opengl {
@@ -38,11 +39,15 @@ export namespace first_opengl {
 
         Application *application = nullptr;
 
+        // 和 hello_sdl 的示例一样按帧计时，支持 APP_RUNTIME_TRACE 和 APP_RUNTIME_FRAMES
+        app_runtime::FrameCapture capture;
+
         auto window_init() -> void;
+        auto render_frame() -> void;
     };
 
     Window::Window(const std::string_view &title, const int width, const int height) :
-        window_title(title), window_width(width), window_height(height) {
+        window_title(title), window_width(width), window_height(height), capture(window_title) {
         window_init();
     }
 
@@ -77,6 +82,16 @@ export namespace first_opengl {
     }
 
     auto Window::handle_iterate() -> SDL_AppResult {
+        capture.begin_frame();
+        {
+            const app_runtime::ScopedTimer timer(capture.get_profiler(), app_runtime::FrameCapture::ITERATION_SCOPE);
+            render_frame();
+        }
+        // 设置了 APP_RUNTIME_FRAMES 时跑满帧数就退出，无头基准靠它结束
+        return capture.end_frame() ? SDL_APP_SUCCESS : SDL_APP_CONTINUE;
+    }
+
+    auto Window::render_frame() -> void {
         // Clear background
         glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -95,8 +110,6 @@ export namespace first_opengl {
         }
 
         SDL_GL_SwapWindow(window);
-
-        return SDL_APP_CONTINUE;
     }
 
     auto Window::window_init() -> void {
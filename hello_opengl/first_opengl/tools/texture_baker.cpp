@@ -0,0 +1,124 @@
+// 构建时运行的离线纹理烘焙工具：png/jpg → .gtex
+// 用法：texture_baker <input image> <output .gtex>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+import first_opengl.baked_texture;
+
+namespace {
+    struct Level {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    /// 2x2 盒式滤波生成下一层 mip，奇数边长时最后一行/列重复使用，与 glGenerateMipmap 的结果基本一致
+    auto downsample(const Level &source, const std::uint32_t channels) -> Level {
+        Level target{std::max(source.width / 2, 1u), std::max(source.height / 2, 1u), {}};
+        target.pixels.resize(static_cast<std::size_t>(target.width) * target.height * channels);
+
+        for (std::uint32_t y = 0; y < target.height; ++y) {
+            const auto y0 = std::min(y * 2, source.height - 1);
+            const auto y1 = std::min(y * 2 + 1, source.height - 1);
+            for (std::uint32_t x = 0; x < target.width; ++x) {
+                const auto x0 = std::min(x * 2, source.width - 1);
+                const auto x1 = std::min(x * 2 + 1, source.width - 1);
+                for (std::uint32_t c = 0; c < channels; ++c) {
+                    const auto sample = [&](const std::uint32_t sx, const std::uint32_t sy) {
+                        return static_cast<std::uint32_t>(
+                                source.pixels[(static_cast<std::size_t>(sy) * source.width + sx) * channels + c]);
+                    };
+                    const auto sum = sample(x0, y0) + sample(x1, y0) + sample(x0, y1) + sample(x1, y1);
+                    target.pixels[(static_cast<std::size_t>(y) * target.width + x) * channels + c] =
+                            static_cast<std::uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        return target;
+    }
+
+    auto bake(const std::filesystem::path &input, const std::filesystem::path &output) -> void {
+        // 与运行时 stbi_set_flip_vertically_on_load(true) 保持一致，行序从下到上
+        stbi_set_flip_vertically_on_load(true);
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        auto *data = stbi_load(input.string().c_str(), &width, &height, &channels, 0);
+        if (data == nullptr) {
+            throw std::runtime_error("Failed to load image: " + input.string());
+        }
+        // get_image_format 只认识 1/3/4 通道，2 通道的灰度 + alpha 扩展成 RGBA
+        if (channels == 2) {
+            stbi_image_free(data);
+            data = stbi_load(input.string().c_str(), &width, &height, &channels, 4);
+            channels = 4;
+        }
+
+        std::vector<Level> levels;
+        levels.push_back({static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height),
+                          std::vector<std::uint8_t>(data, data + static_cast<std::size_t>(width) * height * channels)});
+        stbi_image_free(data);
+        while ((levels.back().width > 1 || levels.back().height > 1) &&
+               levels.size() < first_opengl::BAKED_TEXTURE_MAX_LEVELS) {
+            levels.push_back(downsample(levels.back(), static_cast<std::uint32_t>(channels)));
+        }
+
+        first_opengl::BakedTextureHeader header{};
+        header.magic = first_opengl::BAKED_TEXTURE_MAGIC;
+        header.version = first_opengl::BAKED_TEXTURE_VERSION;
+        header.width = static_cast<std::uint32_t>(width);
+        header.height = static_cast<std::uint32_t>(height);
+        header.channels = static_cast<std::uint32_t>(channels);
+        header.level_count = static_cast<std::uint32_t>(levels.size());
+
+        auto offset = first_opengl::align_baked_offset(sizeof(header));
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            header.levels[i] = {.offset = offset,
+                                .size = levels[i].pixels.size(),
+                                .width = levels[i].width,
+                                .height = levels[i].height};
+            offset = first_opengl::align_baked_offset(offset + levels[i].pixels.size());
+        }
+
+        std::filesystem::create_directories(output.parent_path());
+        std::vector<char> file(offset, 0);
+        std::copy_n(reinterpret_cast<const char *>(&header), sizeof(header), file.begin());
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            std::ranges::copy(levels[i].pixels, file.begin() + static_cast<std::ptrdiff_t>(header.levels[i].offset));
+        }
+
+        std::ofstream stream{output, std::ios::binary | std::ios::trunc};
+        stream.write(file.data(), static_cast<std::streamsize>(file.size()));
+        if (not stream) {
+            throw std::runtime_error("Failed to write baked texture: " + output.string());
+        }
+        std::printf("Baked %s -> %s (%dx%d, %d channels, %zu levels, %zu bytes)\n", input.string().c_str(),
+                    output.string().c_str(), width, height, channels, levels.size(), file.size());
+    }
+} // namespace
+
+int main(const int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <input image> <output .gtex>\n", argv[0]);
+        return 1;
+    }
+    try {
+        bake(argv[1], argv[2]);
+    }
+    catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
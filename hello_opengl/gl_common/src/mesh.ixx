@@ -0,0 +1,521 @@
+module;
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glad/glad.h>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+export module gl_common.mesh;
+
+export namespace gl_common {
+    /// 统计 GL 调用次数的回调，参数是刚发出的调用次数
+    using GlCallHook = void (*)(std::uint32_t count);
+} // namespace gl_common
+
+namespace gl_common {
+    GlCallHook gl_call_hook = nullptr;
+
+    auto count_gl_calls(const std::uint32_t count) -> void {
+        if (gl_call_hook != nullptr) {
+            gl_call_hook(count);
+        }
+    }
+} // namespace gl_common
+
+export namespace gl_common {
+    /// Mesh::bind() / draw() 每发出一次 GL 调用就调用一次 hook；默认不统计，opengl_sandbox 把它接到 GlCallCounter 上
+    auto set_gl_call_hook(const GlCallHook hook) -> void { gl_call_hook = hook; }
+
+    /// 顶点属性在显存中的存储格式
+    enum class AttributeFormat {
+        Float32, ///< 每个分量 4 字节
+        Half16, ///< GL_HALF_FLOAT，每个分量 2 字节，适合 UV
+        Snorm10_10_10_2, ///< GL_INT_2_10_10_10_REV，三分量法线打包进 4 字节
+    };
+
+    /**
+     * 描述源数据中的一个属性：依次占用源顶点中 components 个 float，按 format 打包后上传
+     */
+    struct VertexAttribute {
+        GLuint location;
+        int components;
+        AttributeFormat format = AttributeFormat::Float32;
+    };
+
+    /// 焊接后的网格：去重后的顶点（仍为交错的 float）与三角形索引
+    struct MeshData {
+        std::vector<float> vertices;
+        std::vector<std::uint32_t> indices;
+        std::size_t floats_per_vertex = 0;
+
+        [[nodiscard]] auto vertex_count() const -> std::size_t {
+            return floats_per_vertex == 0 ? 0 : vertices.size() / floats_per_vertex;
+        }
+    };
+
+    /// 上传量与着色次数，用来对比展开数组与索引网格
+    struct MeshStats {
+        std::size_t bytes_uploaded = 0;
+        std::size_t vertices_shaded = 0;
+        std::size_t vertex_count = 0;
+        std::size_t index_count = 0;
+    };
+
+    /**
+     * 把完全展开的三角形顶点数组焊接成 顶点 + 索引，按位比较，完全相同的顶点只保留一份
+     * @param expanded 每 floats_per_vertex 个 float 为一个顶点，每 3 个顶点为一个三角形
+     */
+    auto weld_vertices(const std::span<const float> expanded, const std::size_t floats_per_vertex) -> MeshData {
+        if (floats_per_vertex == 0 || expanded.size() % floats_per_vertex != 0) {
+            throw std::invalid_argument("Vertex data is not a multiple of the vertex size");
+        }
+
+        MeshData mesh{};
+        mesh.floats_per_vertex = floats_per_vertex;
+        const auto input_count = expanded.size() / floats_per_vertex;
+        mesh.indices.reserve(input_count);
+
+        const auto vertex_bytes = floats_per_vertex * sizeof(float);
+        const auto key_of = [&](const std::size_t vertex) {
+            return std::string_view{reinterpret_cast<const char *>(expanded.data() + vertex * floats_per_vertex),
+                                    vertex_bytes};
+        };
+
+        std::unordered_map<std::string_view, std::uint32_t> lookup;
+        lookup.reserve(input_count);
+        for (std::size_t i = 0; i < input_count; ++i) {
+            const auto next_index = static_cast<std::uint32_t>(mesh.vertex_count());
+            const auto [it, inserted] = lookup.try_emplace(key_of(i), next_index);
+            if (inserted) {
+                const auto first = expanded.begin() + static_cast<std::ptrdiff_t>(i * floats_per_vertex);
+                mesh.vertices.insert(mesh.vertices.end(), first,
+                                     first + static_cast<std::ptrdiff_t>(floats_per_vertex));
+            }
+            mesh.indices.push_back(it->second);
+        }
+        return mesh;
+    }
+
+    /**
+     * 模拟 FIFO 形式的 post-transform cache，返回实际需要执行顶点着色器的次数
+     */
+    auto simulate_vertex_cache(const std::span<const std::uint32_t> indices, const std::size_t cache_size = 16)
+            -> std::size_t {
+        std::vector<std::uint32_t> fifo(cache_size, std::numeric_limits<std::uint32_t>::max());
+        std::size_t head = 0;
+        std::size_t misses = 0;
+        for (const auto index: indices) {
+            if (std::ranges::find(fifo, index) != fifo.end()) {
+                continue;
+            }
+            fifo[head] = index;
+            head = (head + 1) % cache_size;
+            ++misses;
+        }
+        return misses;
+    }
+
+    /**
+     * Tom Forsyth 的 linear-speed vertex cache optimisation：
+     * 贪心地挑选得分最高的三角形，得分偏向已在 LRU cache 中、且剩余三角形少的顶点
+     */
+    auto optimize_vertex_cache(std::span<std::uint32_t> indices, const std::size_t vertex_count) -> void {
+        constexpr int cache_size = 32;
+        constexpr float cache_decay_power = 1.5f;
+        constexpr float last_triangle_score = 0.75f;
+        constexpr float valence_boost_scale = 2.0f;
+        constexpr float valence_boost_power = 0.5f;
+
+        const auto triangle_count = indices.size() / 3;
+        if (triangle_count == 0) {
+            return;
+        }
+
+        struct VertexState {
+            int cache_position = -1;
+            float score = 0.0f;
+            std::uint32_t remaining = 0;
+            std::uint32_t first_triangle = 0;
+        };
+        std::vector<VertexState> vertices(vertex_count);
+        for (const auto index: indices) {
+            ++vertices[index].remaining;
+        }
+
+        // 每个顶点引用的三角形列表（CSR 形式）
+        std::uint32_t offset = 0;
+        for (auto &vertex: vertices) {
+            vertex.first_triangle = offset;
+            offset += vertex.remaining;
+        }
+        std::vector<std::uint32_t> vertex_triangles(indices.size());
+        std::vector<std::uint32_t> fill(vertex_count, 0);
+        for (std::size_t t = 0; t < triangle_count; ++t) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                const auto v = indices[t * 3 + k];
+                vertex_triangles[vertices[v].first_triangle + fill[v]++] = static_cast<std::uint32_t>(t);
+            }
+        }
+
+        const auto score_of = [&](const VertexState &vertex) {
+            if (vertex.remaining == 0) {
+                return -1.0f;
+            }
+            float score = 0.0f;
+            if (vertex.cache_position >= 0) {
+                if (vertex.cache_position < 3) {
+                    score = last_triangle_score;
+                }
+                else {
+                    const auto scaler = 1.0f / static_cast<float>(cache_size - 3);
+                    score = std::pow(1.0f - static_cast<float>(vertex.cache_position - 3) * scaler,
+                                     cache_decay_power);
+                }
+            }
+            return score + valence_boost_scale *
+                                   std::pow(static_cast<float>(vertex.remaining), -valence_boost_power);
+        };
+
+        for (auto &vertex: vertices) {
+            vertex.score = score_of(vertex);
+        }
+
+        std::vector<float> triangle_scores(triangle_count);
+        std::vector<bool> emitted(triangle_count, false);
+        const auto triangle_score = [&](const std::size_t t) {
+            return vertices[indices[t * 3]].score + vertices[indices[t * 3 + 1]].score +
+                   vertices[indices[t * 3 + 2]].score;
+        };
+        for (std::size_t t = 0; t < triangle_count; ++t) {
+            triangle_scores[t] = triangle_score(t);
+        }
+
+        std::vector<std::uint32_t> output;
+        output.reserve(indices.size());
+        std::vector<std::uint32_t> cache;
+        cache.reserve(cache_size + 3);
+
+        std::size_t scan_position = 0;
+        auto best_triangle = std::numeric_limits<std::size_t>::max();
+
+        for (std::size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+            if (best_triangle == std::numeric_limits<std::size_t>::max()) {
+                // cache 里没有候选时，线性扫描剩余三角形
+                float best_score = -1.0f;
+                for (auto t = scan_position; t < triangle_count; ++t) {
+                    if (not emitted[t] && triangle_scores[t] > best_score) {
+                        best_score = triangle_scores[t];
+                        best_triangle = t;
+                    }
+                }
+                while (scan_position < triangle_count && emitted[scan_position]) {
+                    ++scan_position;
+                }
+            }
+
+            emitted[best_triangle] = true;
+            std::uint32_t triangle_vertices[3];
+            for (std::size_t k = 0; k < 3; ++k) {
+                const auto v = indices[best_triangle * 3 + k];
+                triangle_vertices[k] = v;
+                output.push_back(v);
+
+                // 从该顶点的三角形列表中移除刚输出的三角形
+                auto &vertex = vertices[v];
+                const auto begin = vertex_triangles.begin() + vertex.first_triangle;
+                const auto end = begin + vertex.remaining;
+                const auto it = std::find(begin, end, static_cast<std::uint32_t>(best_triangle));
+                std::iter_swap(it, end - 1);
+                --vertex.remaining;
+            }
+
+            // 把刚用过的顶点移到 LRU cache 最前面
+            for (int k = 2; k >= 0; --k) {
+                const auto v = triangle_vertices[k];
+                if (const auto it = std::ranges::find(cache, v); it != cache.end()) {
+                    cache.erase(it);
+                }
+                cache.insert(cache.begin(), v);
+            }
+            for (std::size_t position = 0; position < cache.size(); ++position) {
+                vertices[cache[position]].cache_position =
+                        position < static_cast<std::size_t>(cache_size) ? static_cast<int>(position) : -1;
+            }
+
+            // 重新计算 cache 中顶点及其三角形的得分，并挑选下一个候选
+            best_triangle = std::numeric_limits<std::size_t>::max();
+            float best_score = -1.0f;
+            for (const auto v: cache) {
+                vertices[v].score = score_of(vertices[v]);
+            }
+            for (const auto v: cache) {
+                const auto &vertex = vertices[v];
+                for (std::uint32_t i = 0; i < vertex.remaining; ++i) {
+                    const auto t = vertex_triangles[vertex.first_triangle + i];
+                    triangle_scores[t] = triangle_score(t);
+                    if (triangle_scores[t] > best_score) {
+                        best_score = triangle_scores[t];
+                        best_triangle = t;
+                    }
+                }
+            }
+            if (cache.size() > static_cast<std::size_t>(cache_size)) {
+                cache.resize(cache_size);
+            }
+        }
+
+        std::ranges::copy(output, indices.begin());
+    }
+
+    /**
+     * 按索引中第一次出现的顺序重排顶点，让顶点读取也尽量顺序访问
+     */
+    auto reorder_vertices_for_fetch(MeshData &mesh) -> void {
+        const auto count = mesh.vertex_count();
+        std::vector remap(count, std::numeric_limits<std::uint32_t>::max());
+        std::vector<float> reordered;
+        reordered.reserve(mesh.vertices.size());
+
+        std::uint32_t next = 0;
+        for (auto &index: mesh.indices) {
+            if (remap[index] == std::numeric_limits<std::uint32_t>::max()) {
+                remap[index] = next++;
+                const auto first = mesh.vertices.begin() + static_cast<std::ptrdiff_t>(index * mesh.floats_per_vertex);
+                reordered.insert(reordered.end(), first,
+                                 first + static_cast<std::ptrdiff_t>(mesh.floats_per_vertex));
+            }
+            index = remap[index];
+        }
+        mesh.vertices = std::move(reordered);
+    }
+
+    /// float 转 IEEE 754 半精度，最近舍入
+    auto float_to_half(const float value) -> std::uint16_t {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+        const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+        const auto raw_exponent = static_cast<int>((bits >> 23) & 0xFFu);
+        auto mantissa = bits & 0x7FFFFFu;
+
+        if (raw_exponent == 0xFF) {
+            return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+        }
+        const auto exponent = raw_exponent - 127 + 15;
+        if (exponent >= 31) {
+            return static_cast<std::uint16_t>(sign | 0x7C00u);
+        }
+        if (exponent <= 0) {
+            if (exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000u;
+            const auto shift = static_cast<unsigned>(14 - exponent);
+            auto half_mantissa = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1u) {
+                ++half_mantissa;
+            }
+            return static_cast<std::uint16_t>(sign | half_mantissa);
+        }
+        auto half = static_cast<std::uint32_t>(sign) | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000u) {
+            ++half; // 进位会自然地溢出到指数位
+        }
+        return static_cast<std::uint16_t>(half);
+    }
+
+    /// 把 [-1, 1] 的三分量向量打包成 GL_INT_2_10_10_10_REV（w 为 0）
+    auto pack_snorm_10_10_10_2(const float x, const float y, const float z) -> std::uint32_t {
+        const auto pack = [](const float value) {
+            const auto scaled = static_cast<std::int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f));
+            return static_cast<std::uint32_t>(scaled) & 0x3FFu;
+        };
+        return pack(x) | (pack(y) << 10) | (pack(z) << 20);
+    }
+
+    /// 单个属性打包后的字节数，按 4 字节对齐
+    auto packed_attribute_size(const VertexAttribute &attribute) -> std::size_t {
+        switch (attribute.format) {
+            case AttributeFormat::Half16:
+                return (static_cast<std::size_t>(attribute.components) * 2 + 3) & ~std::size_t{3};
+            case AttributeFormat::Snorm10_10_10_2:
+                return 4;
+            case AttributeFormat::Float32:
+            default:
+                return static_cast<std::size_t>(attribute.components) * 4;
+        }
+    }
+
+    auto packed_vertex_size(const std::span<const VertexAttribute> layout) -> std::size_t {
+        std::size_t size = 0;
+        for (const auto &attribute: layout) {
+            size += packed_attribute_size(attribute);
+        }
+        return size;
+    }
+
+    /**
+     * 把交错的 float 顶点按 layout 打包成显存中的字节布局
+     */
+    auto pack_vertices(const MeshData &mesh, const std::span<const VertexAttribute> layout)
+            -> std::vector<std::byte> {
+        const auto stride = packed_vertex_size(layout);
+        std::vector<std::byte> packed(stride * mesh.vertex_count());
+
+        for (std::size_t v = 0; v < mesh.vertex_count(); ++v) {
+            const float *source = mesh.vertices.data() + v * mesh.floats_per_vertex;
+            std::byte *target = packed.data() + v * stride;
+            for (const auto &attribute: layout) {
+                switch (attribute.format) {
+                    case AttributeFormat::Half16:
+                        for (int c = 0; c < attribute.components; ++c) {
+                            const auto half = float_to_half(source[c]);
+                            std::memcpy(target + c * 2, &half, sizeof(half));
+                        }
+                        break;
+                    case AttributeFormat::Snorm10_10_10_2: {
+                        const auto word = pack_snorm_10_10_10_2(source[0], attribute.components > 1 ? source[1] : 0.0f,
+                                                                attribute.components > 2 ? source[2] : 0.0f);
+                        std::memcpy(target, &word, sizeof(word));
+                        break;
+                    }
+                    case AttributeFormat::Float32:
+                    default:
+                        std::memcpy(target, source, static_cast<std::size_t>(attribute.components) * sizeof(float));
+                        break;
+                }
+                source += attribute.components;
+                target += packed_attribute_size(attribute);
+            }
+        }
+        return packed;
+    }
+
+    /**
+     * GPU 上的索引网格：VAO + 打包后的 VBO + EBO，使用 glDrawElements 绘制
+     * 顶点数不超过 65535 时使用 16 位索引
+     */
+    class Mesh {
+    public:
+        Mesh(const MeshData &data, const std::span<const VertexAttribute> layout) {
+            const auto packed = pack_vertices(data, layout);
+            const auto stride = static_cast<GLsizei>(packed_vertex_size(layout));
+
+            glGenVertexArrays(1, &vertex_array);
+            glGenBuffers(1, &vertex_buffer);
+            glGenBuffers(1, &index_buffer);
+
+            glBindVertexArray(vertex_array);
+            glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size()), packed.data(), GL_STATIC_DRAW);
+
+            std::size_t offset = 0;
+            for (const auto &attribute: layout) {
+                const auto pointer = reinterpret_cast<void *>(offset);
+                switch (attribute.format) {
+                    case AttributeFormat::Half16:
+                        glVertexAttribPointer(attribute.location, attribute.components, GL_HALF_FLOAT, GL_FALSE, stride,
+                                              pointer);
+                        break;
+                    case AttributeFormat::Snorm10_10_10_2:
+                        glVertexAttribPointer(attribute.location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, pointer);
+                        break;
+                    case AttributeFormat::Float32:
+                    default:
+                        glVertexAttribPointer(attribute.location, attribute.components, GL_FLOAT, GL_FALSE, stride,
+                                              pointer);
+                        break;
+                }
+                glEnableVertexAttribArray(attribute.location);
+                offset += packed_attribute_size(attribute);
+            }
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+            std::size_t index_bytes = 0;
+            if (data.vertex_count() <= std::numeric_limits<std::uint16_t>::max()) {
+                const std::vector<std::uint16_t> short_indices(data.indices.begin(), data.indices.end());
+                index_bytes = short_indices.size() * sizeof(std::uint16_t);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_bytes), short_indices.data(),
+                             GL_STATIC_DRAW);
+                index_type = GL_UNSIGNED_SHORT;
+            }
+            else {
+                index_bytes = data.indices.size() * sizeof(std::uint32_t);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_bytes), data.indices.data(),
+                             GL_STATIC_DRAW);
+                index_type = GL_UNSIGNED_INT;
+            }
+
+            // EBO 绑定属于 VAO 状态，先解绑 VAO 再解绑 ARRAY_BUFFER
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            index_count = static_cast<GLsizei>(data.indices.size());
+            stats = {
+                    .bytes_uploaded = packed.size() + index_bytes,
+                    .vertices_shaded = simulate_vertex_cache(data.indices),
+                    .vertex_count = data.vertex_count(),
+                    .index_count = data.indices.size(),
+            };
+        }
+
+        ~Mesh() {
+            glDeleteVertexArrays(1, &vertex_array);
+            glDeleteBuffers(1, &vertex_buffer);
+            glDeleteBuffers(1, &index_buffer);
+        }
+
+        Mesh(const Mesh &) = delete;
+        auto operator=(const Mesh &) -> Mesh & = delete;
+
+        auto bind() const -> void {
+            glBindVertexArray(vertex_array);
+            count_gl_calls(1);
+        }
+
+        /// 需要先 bind()，同一网格连续绘制多次时只绑定一次
+        auto draw() const -> void {
+            glDrawElements(GL_TRIANGLES, index_count, index_type, nullptr);
+            count_gl_calls(1);
+        }
+
+        [[nodiscard]] auto get_vertex_array() const -> unsigned int { return vertex_array; }
+        [[nodiscard]] auto get_index_count() const -> GLsizei { return index_count; }
+        [[nodiscard]] auto get_index_type() const -> GLenum { return index_type; }
+        [[nodiscard]] auto get_stats() const -> const MeshStats & { return stats; }
+
+    private:
+        unsigned int vertex_array{};
+        unsigned int vertex_buffer{};
+        unsigned int index_buffer{};
+        GLsizei index_count = 0;
+        GLenum index_type = GL_UNSIGNED_SHORT;
+        MeshStats stats{};
+    };
+
+    /**
+     * 焊接 → 可选的 cache 优化 → 按首次使用重排顶点，一步得到可以上传的网格数据
+     */
+    auto build_indexed_mesh(const std::span<const float> expanded, const std::size_t floats_per_vertex,
+                            const bool optimize_for_cache = true) -> MeshData {
+        auto mesh = weld_vertices(expanded, floats_per_vertex);
+        if (optimize_for_cache) {
+            optimize_vertex_cache(mesh.indices, mesh.vertex_count());
+            reorder_vertices_for_fetch(mesh);
+        }
+        return mesh;
+    }
+
+    /// 展开数组直接 glDrawArrays 时的开销：没有索引，每个顶点都要上传并着色一次
+    auto expanded_stats(const std::span<const float> expanded, const std::size_t floats_per_vertex) -> MeshStats {
+        const auto count = expanded.size() / floats_per_vertex;
+        return {.bytes_uploaded = expanded.size_bytes(), .vertices_shaded = count, .vertex_count = count,
+                .index_count = 0};
+    }
+} // namespace gl_common
@@ -4,8 +4,15 @@ out vec4 FragColor;
 in vec3 Normal;
 in vec3 FragPos;
 
+layout (std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+    float time;
+};
+
 uniform vec3 lightPos;
-uniform vec3 viewPos;
 uniform vec3 lightColor;
 uniform vec3 objectColor;
 
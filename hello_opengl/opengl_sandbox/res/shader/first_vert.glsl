@@ -5,9 +5,15 @@ layout (location = 1) in vec3 aNormal;
 out vec3 FragPos;
 out vec3 Normal;
 
+layout (std140) uniform FrameUniforms
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+    float time;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
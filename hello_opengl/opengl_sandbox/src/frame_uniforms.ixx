@@ -0,0 +1,72 @@
+module;
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string_view>
+
+export module opengl_sandbox.frame_uniforms;
+
+import opengl_sandbox.gl_stats;
+
+export namespace opengl_sandbox {
+    /// 着色器中 uniform block 的名字，Shader 链接时据此自动绑定
+    constexpr std::string_view FRAME_UNIFORMS_BLOCK_NAME = "FrameUniforms";
+    /// FrameUniforms 固定使用的 binding point
+    constexpr GLuint FRAME_UNIFORMS_BINDING = 0;
+
+    /**
+     * 每帧所有着色器共享的相机数据，布局与 GLSL 中的 std140 block 一一对应：
+     *
+     *     layout (std140) uniform FrameUniforms {
+     *         mat4 projection;
+     *         mat4 view;
+     *         vec3 viewPos;
+     *         float time;
+     *     };
+     *
+     * std140 下 float 可以紧跟在 vec3 的第四个分量位置，所以整个 block 为 144 字节
+     */
+    struct FrameUniforms {
+        glm::mat4 projection{1.0f};
+        glm::mat4 view{1.0f};
+        glm::vec3 view_pos{0.0f};
+        float time = 0.0f;
+    };
+
+    static_assert(offsetof(FrameUniforms, projection) == 0);
+    static_assert(offsetof(FrameUniforms, view) == 64);
+    static_assert(offsetof(FrameUniforms, view_pos) == 128);
+    static_assert(offsetof(FrameUniforms, time) == 140);
+    static_assert(sizeof(FrameUniforms) == 144);
+
+    /**
+     * 持有 FrameUniforms 的 UBO，创建时就绑定到 FRAME_UNIFORMS_BINDING 并一直保持
+     * 每帧只需 update() 一次，所有声明了该 block 的程序都会读到同一份数据
+     */
+    class FrameUniformBuffer {
+    public:
+        FrameUniformBuffer() {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
+        ~FrameUniformBuffer() { glDeleteBuffers(1, &buffer); }
+
+        FrameUniformBuffer(const FrameUniformBuffer &) = delete;
+        auto operator=(const FrameUniformBuffer &) -> FrameUniformBuffer & = delete;
+
+        auto update(const FrameUniforms &uniforms) const -> void {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+            GlCallCounter::add(2);
+        }
+
+        [[nodiscard]] auto get_id() const -> unsigned int { return buffer; }
+
+    private:
+        unsigned int buffer{};
+    };
+} // namespace opengl_sandbox
@@ -0,0 +1,65 @@
+module;
+#include <cstdint>
+
+export module opengl_sandbox.gl_stats;
+
+export namespace opengl_sandbox {
+    /**
+     * 统计每帧发出的 GL 调用次数，用来量化 uniform 缓存等优化减少了多少驱动往返，Window 在每帧结束时调用 end_frame()
+     * - add()：渲染本身需要的 GL 调用，只统计经过 add() 登记的调用
+     * - add_uniform_lookup()：按名字查找 uniform location 的次数；改成链接时反射之前，每次查找都是一次
+     *   glGetUniformLocation，所以两者相加就是优化前同样的渲染要发出的调用数
+     * - add_query()：GpuTimer 自己的计时查询，属于测量开销，单独统计，不计入 add() 的总数
+     */
+    class GlCallCounter {
+    public:
+        static auto add(const std::uint32_t count = 1) -> void { calls.current += count; }
+        static auto add_uniform_lookup() -> void { ++uniform_lookups.current; }
+        static auto add_query(const std::uint32_t count = 1) -> void { queries.current += count; }
+
+        static auto end_frame() -> void {
+            last_frame_calls = calls.current;
+            calls.end_frame();
+            uniform_lookups.end_frame();
+            queries.end_frame();
+            ++total_frames;
+        }
+
+        [[nodiscard]] static auto get_last_frame_calls() -> std::uint64_t { return last_frame_calls; }
+
+        [[nodiscard]] static auto get_average_calls() -> double { return calls.average(total_frames); }
+        [[nodiscard]] static auto get_average_uniform_lookups() -> double {
+            return uniform_lookups.average(total_frames);
+        }
+        [[nodiscard]] static auto get_average_queries() -> double { return queries.average(total_frames); }
+
+        static auto reset_average() -> void {
+            calls.total = 0;
+            uniform_lookups.total = 0;
+            queries.total = 0;
+            total_frames = 0;
+        }
+
+    private:
+        // 不写成员默认值：嵌套类的默认成员初始化要到外层类定义结束才可用，静态成员用 {} 值初始化
+        struct Tally {
+            std::uint64_t current;
+            std::uint64_t total;
+
+            auto end_frame() -> void {
+                total += current;
+                current = 0;
+            }
+
+            [[nodiscard]] auto average(const std::uint64_t frames) const -> double {
+                return frames == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(frames);
+            }
+        };
+
+        static inline Tally calls{};
+        static inline Tally uniform_lookups{};
+        static inline Tally queries{};
+        static inline std::uint64_t last_frame_calls = 0;
+        static inline std::uint64_t total_frames = 0;
+    };
+} // namespace opengl_sandbox
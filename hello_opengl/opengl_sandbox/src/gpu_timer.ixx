@@ -0,0 +1,166 @@
+module;
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+export module opengl_sandbox.gpu_timer;
+
+import app_runtime.trace;
+import opengl_sandbox.gl_stats;
+
+export namespace opengl_sandbox {
+    /**
+     * 用 GL_TIME_ELAPSED 查询测量一帧中各个阶段在 GPU 上的耗时，帧时间的尖峰可以对应到具体阶段
+     * 查询结果要等 GPU 执行完才能取回，查询对象按 FRAMES_IN_FLIGHT 帧轮换：begin_frame() 读取同一组对象上一轮的结果，
+     * 结果还没好就丢掉这一帧，绝不等待 GPU
+     * GL_TIME_ELAPSED 查询不能嵌套，阶段之间要先 end() 再 begin()；上下文不支持计时查询时所有函数什么也不做
+     * 记录 Chrome Trace 时，取回的耗时写到 "GPU" 时间线上，起点用这个阶段在 CPU 上提交的时间近似
+     * 查询本身的 GL 调用记在 GlCallCounter::add_query() 上，不混进渲染的调用数
+     */
+    class GpuTimer {
+    public:
+        static constexpr std::size_t FRAMES_IN_FLIGHT = 4;
+        static constexpr std::size_t MAX_STAGES = 8;
+
+        /// 需要当前线程上已经有 GL 上下文
+        GpuTimer() : available(GLAD_GL_VERSION_3_3 != 0) {
+            if (not available) {
+                SDL_Log("GL_TIME_ELAPSED queries are not available, GPU timing disabled");
+                return;
+            }
+            for (auto &frame: frames) {
+                glGenQueries(static_cast<GLsizei>(MAX_STAGES), frame.queries.data());
+            }
+        }
+
+        ~GpuTimer() {
+            if (available) {
+                for (auto &frame: frames) {
+                    glDeleteQueries(static_cast<GLsizei>(MAX_STAGES), frame.queries.data());
+                }
+            }
+        }
+
+        GpuTimer(const GpuTimer &) = delete;
+        auto operator=(const GpuTimer &) -> GpuTimer & = delete;
+
+        /// 每帧开始时调用一次
+        auto begin_frame() -> void {
+            if (not available) {
+                return;
+            }
+            frame_index = (frame_index + 1) % FRAMES_IN_FLIGHT;
+            collect(frames[frame_index]);
+            frames[frame_index].stage_count = 0;
+        }
+
+        /// stage 要求和 trace::Zone 的名字一样，例如字符串字面量；超过 MAX_STAGES 个阶段的部分不计时
+        auto begin(const char *stage) -> void {
+            auto &frame = frames[frame_index];
+            if (not available or frame.stage_count == MAX_STAGES) {
+                return;
+            }
+            frame.stages[frame.stage_count] = {.name = stage, .submit_ns = SDL_GetTicksNS()};
+            glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.stage_count]);
+            GlCallCounter::add_query();
+            timing = true;
+        }
+
+        auto end() -> void {
+            if (not timing) {
+                return;
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            GlCallCounter::add_query();
+            ++frames[frame_index].stage_count;
+            timing = false;
+        }
+
+        [[nodiscard]] auto is_available() const -> bool { return available; }
+
+        /// 取回结果的帧平均每帧的 GPU 耗时，单位毫秒
+        [[nodiscard]] auto get_average_ms() const -> double {
+            return collected_frames == 0 ? 0.0
+                                         : static_cast<double>(total_ns) / static_cast<double>(collected_frames) /
+                                                   static_cast<double>(SDL_NS_PER_MS);
+        }
+
+        /// 结果还没好、被丢掉的帧数
+        [[nodiscard]] auto get_dropped_frames() const -> std::uint64_t { return dropped_frames; }
+
+        auto reset_average() -> void {
+            total_ns = 0;
+            collected_frames = 0;
+            dropped_frames = 0;
+        }
+
+    private:
+        struct Stage {
+            const char *name = nullptr;
+            Uint64 submit_ns = 0;
+        };
+
+        struct Frame {
+            std::array<GLuint, MAX_STAGES> queries{};
+            std::array<Stage, MAX_STAGES> stages{};
+            std::size_t stage_count = 0;
+        };
+
+        auto collect(const Frame &frame) -> void {
+            if (frame.stage_count == 0) {
+                return;
+            }
+            // 查询按提交顺序完成，最后一个好了前面的也都好了
+            GLint ready = GL_FALSE;
+            glGetQueryObjectiv(frame.queries[frame.stage_count - 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+            GlCallCounter::add_query();
+            if (ready == GL_FALSE) {
+                ++dropped_frames;
+                return;
+            }
+            const auto recording = app_runtime::trace::is_recording();
+            if (recording and track == nullptr) {
+                track = &app_runtime::trace::create_track("GPU");
+            }
+            for (std::size_t i = 0; i < frame.stage_count; ++i) {
+                GLuint64 elapsed_ns = 0;
+                glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed_ns);
+                total_ns += elapsed_ns;
+                if (recording) {
+                    track->push({.name = frame.stages[i].name,
+                                 .start_ns = frame.stages[i].submit_ns,
+                                 .duration_ns = elapsed_ns});
+                }
+            }
+            GlCallCounter::add_query(static_cast<std::uint32_t>(frame.stage_count));
+            ++collected_frames;
+        }
+
+        const bool available;
+        std::array<Frame, FRAMES_IN_FLIGHT> frames{};
+        std::size_t frame_index = 0;
+        bool timing = false;
+        app_runtime::trace::Track *track = nullptr;
+
+        Uint64 total_ns = 0;
+        std::uint64_t collected_frames = 0;
+        std::uint64_t dropped_frames = 0;
+    };
+
+    /// 构造时 begin(stage)，析构时 end()，同时在当前线程的 Chrome Trace 时间线上记一个同名区段
+    class GpuZone {
+    public:
+        GpuZone(GpuTimer &timer, const char *stage) : timer(timer), zone(stage) { timer.begin(stage); }
+
+        ~GpuZone() { timer.end(); }
+
+        GpuZone(const GpuZone &) = delete;
+        auto operator=(const GpuZone &) -> GpuZone & = delete;
+
+    private:
+        GpuTimer &timer;
+        app_runtime::trace::Zone zone;
+    };
+} // namespace opengl_sandbox
@@ -2,6 +2,7 @@
 
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_main.h>
+#include <SDL3/SDL_timer.h>
 #include <exception>
 #include <memory>
 
@@ -11,18 +12,24 @@ import opengl_sandbox.sandbox;
 struct AppContext {
     std::unique_ptr<opengl_sandbox::Window> window;
     std::unique_ptr<opengl_sandbox::Sandbox> sandbox;
+    // 启动计时：从 SDL_AppInit 开始到第一帧 swap 完成，用来对比着色器缓存冷/热启动
+    Uint64 init_start_ns = 0;
+    bool first_frame_logged = false;
 };
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
     SDL_Log("SDL_AppInit called");
     try {
         auto context = new AppContext();
+        context->init_start_ns = SDL_GetTicksNS();
         context->window = std::make_unique<opengl_sandbox::Window>("opengl sandbox", 800,
                                                                    600); // Using previous default used in first_opengl
         context->sandbox = std::make_unique<opengl_sandbox::Sandbox>(*context->window);
 
         context->window->set_application(context->sandbox.get());
         context->sandbox->on_init();
+        SDL_Log("Startup: init finished in %.2f ms",
+                static_cast<double>(SDL_GetTicksNS() - context->init_start_ns) / 1e6);
 
         *appstate = context;
         SDL_Log("Application created successfully");
@@ -41,7 +48,13 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 
 SDL_AppResult SDL_AppIterate(void *appstate) {
     const auto context = static_cast<AppContext *>(appstate);
-    return context->window->handle_iterate();
+    const auto result = context->window->handle_iterate();
+    if (not context->first_frame_logged) {
+        context->first_frame_logged = true;
+        SDL_Log("Startup: time to first frame %.2f ms",
+                static_cast<double>(SDL_GetTicksNS() - context->init_start_ns) / 1e6);
+    }
+    return result;
 }
 
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
@@ -0,0 +1,191 @@
+module;
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glad/glad.h>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+export module opengl_sandbox.program_cache;
+
+export namespace opengl_sandbox {
+    /**
+     * 基于 glGetProgramBinary / glProgramBinary 的着色器程序缓存
+     * 缓存文件放在可执行文件旁边的 shader_cache/ 目录，文件名是源码与驱动信息的哈希，
+     * 驱动升级或者换显卡后哈希随之变化，旧文件自然失效；格式不匹配时删除文件并返回 0，由调用方重新编译
+     */
+    class ProgramCache {
+    public:
+        /// 写在每个缓存文件开头，用来识别文件以及本程序自身的格式变化
+        struct FileHeader {
+            std::uint32_t magic = MAGIC;
+            std::uint32_t version = VERSION;
+            std::uint32_t binary_format = 0;
+            std::uint32_t binary_length = 0;
+        };
+
+        static constexpr std::uint32_t MAGIC = 0x42504C47; // "GLPB"
+        static constexpr std::uint32_t VERSION = 1;
+
+        /**
+         * 由两份着色器源码以及 GL_VENDOR / GL_RENDERER / GL_VERSION 计算缓存键，需要有当前的 GL 上下文
+         */
+        [[nodiscard]] static auto make_key(const std::string_view vertex_source, const std::string_view fragment_source)
+                -> std::uint64_t {
+            std::uint64_t hash = FNV_OFFSET_BASIS;
+            const auto mix = [&hash](const std::string_view text) {
+                for (const auto c: text) {
+                    hash ^= static_cast<unsigned char>(c);
+                    hash *= FNV_PRIME;
+                }
+                // 分隔符，避免 "ab" + "c" 与 "a" + "bc" 得到相同的哈希
+                hash ^= 0xFF;
+                hash *= FNV_PRIME;
+            };
+
+            mix(vertex_source);
+            mix(fragment_source);
+            mix(gl_string(GL_VENDOR));
+            mix(gl_string(GL_RENDERER));
+            mix(gl_string(GL_VERSION));
+            return hash;
+        }
+
+        /// 驱动是否至少支持一种程序二进制格式
+        [[nodiscard]] static auto is_supported() -> bool {
+            GLint format_count = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+            return format_count > 0;
+        }
+
+        /**
+         * 从缓存加载并创建程序
+         * @return 成功时返回已链接的程序；缓存不存在或驱动拒绝该二进制时返回 0
+         */
+        [[nodiscard]] static auto load(const std::uint64_t key) -> GLuint {
+            if (not is_supported()) {
+                return 0;
+            }
+
+            const auto path = cache_path(key);
+            std::ifstream file{path, std::ios::binary};
+            if (not file.is_open()) {
+                return 0;
+            }
+
+            FileHeader header{};
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (not file || header.magic != MAGIC || header.version != VERSION || header.binary_length == 0) {
+                discard(path, "invalid header");
+                return 0;
+            }
+            // binary_length 来自文件，先和文件剩余的大小比较，损坏的缓存不会让这里申请巨量内存
+            std::error_code error;
+            const auto file_size = std::filesystem::file_size(path, error);
+            if (error || file_size < sizeof(header) || header.binary_length > file_size - sizeof(header)) {
+                discard(path, "truncated file");
+                return 0;
+            }
+
+            std::vector<char> binary(header.binary_length);
+            file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+            if (not file) {
+                discard(path, "truncated file");
+                return 0;
+            }
+
+            const auto program = glCreateProgram();
+            glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+            GLint success = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (not success) {
+                glDeleteProgram(program);
+                discard(path, "binary format rejected by driver");
+                return 0;
+            }
+            return program;
+        }
+
+        /**
+         * 把已链接的程序写入缓存；程序链接前应设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+         * 写入失败只记录日志，不影响运行
+         */
+        static auto store(const std::uint64_t key, const GLuint program) -> void {
+            if (not is_supported()) {
+                return;
+            }
+
+            GLint length = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+            if (length <= 0) {
+                return;
+            }
+
+            std::vector<char> binary(static_cast<std::size_t>(length));
+            GLsizei written = 0;
+            GLenum binary_format = 0;
+            glGetProgramBinary(program, length, &written, &binary_format, binary.data());
+            if (written <= 0) {
+                return;
+            }
+
+            std::error_code error;
+            std::filesystem::create_directories(cache_directory(), error);
+            if (error) {
+                SDL_Log("Failed to create shader cache directory: %s", error.message().c_str());
+                return;
+            }
+
+            // 先写临时文件再改名，避免中途退出留下半个文件
+            const auto path = cache_path(key);
+            auto temp_path = path;
+            temp_path += ".tmp";
+            {
+                std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+                const FileHeader header{.binary_format = binary_format,
+                                        .binary_length = static_cast<std::uint32_t>(written)};
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                file.write(binary.data(), written);
+                if (not file) {
+                    SDL_Log("Failed to write shader cache: %s", temp_path.string().c_str());
+                    return;
+                }
+            }
+            std::filesystem::rename(temp_path, path, error);
+            if (error) {
+                SDL_Log("Failed to write shader cache: %s", error.message().c_str());
+                std::filesystem::remove(temp_path, error);
+            }
+        }
+
+        /// 缓存目录：可执行文件所在目录下的 shader_cache/
+        [[nodiscard]] static auto cache_directory() -> std::filesystem::path {
+            const auto *base_path = SDL_GetBasePath();
+            return std::filesystem::path{base_path != nullptr ? base_path : "./"} / "shader_cache";
+        }
+
+        [[nodiscard]] static auto cache_path(const std::uint64_t key) -> std::filesystem::path {
+            return cache_directory() / std::format("{:016x}.bin", key);
+        }
+
+    private:
+        static constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+        static constexpr std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+        static auto gl_string(const GLenum name) -> std::string_view {
+            const auto *value = reinterpret_cast<const char *>(glGetString(name));
+            return value != nullptr ? std::string_view{value} : std::string_view{};
+        }
+
+        static auto discard(const std::filesystem::path &path, const char *reason) -> void {
+            SDL_Log("Discarding shader cache %s: %s", path.filename().string().c_str(), reason);
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    };
+} // namespace opengl_sandbox
@@ -1,5 +1,7 @@
 module;
 #include <SDL3/SDL.h>
+#include <array>
+#include <cstdint>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,10 +14,15 @@ module;
 
 export module opengl_sandbox.sandbox;
 
+import app_runtime.trace;
+import gl_common.mesh;
 import opengl_sandbox.app;
 import opengl_sandbox.window;
 import opengl_sandbox.shader;
 import opengl_sandbox.file_operation;
+import opengl_sandbox.frame_uniforms;
+import opengl_sandbox.gl_stats;
+import opengl_sandbox.gpu_timer;
 
 export namespace opengl_sandbox {
     class Sandbox : public Application {
@@ -25,6 +32,8 @@ export namespace opengl_sandbox {
         ~Sandbox() override = default;
 
         void on_init() override {
+            frame_uniform_buffer = std::make_unique<FrameUniformBuffer>();
+
             light_cube_shader =
                     std::make_shared<Shader>("./res/shader/first_vert.glsl", "./res/shader/first_frag.glsl");
             light_cube_shader->use();
@@ -33,73 +42,83 @@ export namespace opengl_sandbox {
                                                     "./res/shader/light_shader_cube_frag.glsl");
             light_shader->use();
 
-            // Set up vertex data and buffers and configure vertex attributes
-            glGenVertexArrays(1, &vertex_array_object);
-            glBindVertexArray(vertex_array_object);
-
-            glGenBuffers(1, &vertex_buffer_object);
-            glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-            // Position attribute
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), reinterpret_cast<void *>(0));
-            glEnableVertexAttribArray(0);
-
-            // Normal attribute
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                                  reinterpret_cast<void *>(3 * sizeof(float)));
-            glEnableVertexAttribArray(1);
-
-            glGenVertexArrays(1, &light_vertex_array_object);
-            glBindVertexArray(light_vertex_array_object);
-            glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object);
-
-            // Light VAO only needs position
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), reinterpret_cast<void *>(0));
-            glEnableVertexAttribArray(0);
+            // uniform 句柄只在初始化时解析一次，每帧直接复用
+            lighting_uniforms = {
+                    .object_color = light_cube_shader->uniform<glm::vec3>("objectColor"),
+                    .light_color = light_cube_shader->uniform<glm::vec3>("lightColor"),
+                    .light_pos = light_cube_shader->uniform<glm::vec3>("lightPos"),
+                    .model = light_cube_shader->uniform<glm::mat4>("model"),
+            };
+            lamp_uniforms = {
+                    .model = light_shader->uniform<glm::mat4>("model"),
+            };
 
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glBindVertexArray(0);
+            // 展开的 36 个顶点焊接成 24 个顶点 + 索引，法线打包为 10_10_10_2
+            // 物体与光源共用同一个网格，光源着色器只读取 location 0
+            using gl_common::AttributeFormat;
+            using gl_common::VertexAttribute;
+            constexpr std::array layout{
+                    VertexAttribute{.location = 0, .components = 3, .format = AttributeFormat::Float32},
+                    VertexAttribute{.location = 1, .components = 3, .format = AttributeFormat::Snorm10_10_10_2},
+            };
+            // 网格的 bind / draw 计入每帧的 GL 调用数
+            gl_common::set_gl_call_hook([](const std::uint32_t count) { GlCallCounter::add(count); });
+            cube_mesh = std::make_unique<gl_common::Mesh>(gl_common::build_indexed_mesh(vertices, 6), layout);
+
+            const auto before = gl_common::expanded_stats(vertices, 6);
+            const auto &after = cube_mesh->get_stats();
+            SDL_Log("Cube mesh: %zu -> %zu bytes uploaded, %zu -> %zu vertices shaded (%zu vertices, %zu indices)",
+                    before.bytes_uploaded, after.bytes_uploaded, before.vertices_shaded, after.vertices_shaded,
+                    after.vertex_count, after.index_count);
         }
 
         void on_update(double delta_time) override {
-            light_cube_shader->use();
+            const app_runtime::trace::Zone zone("on_update");
+            auto &gpu_timer = window.get_gpu_timer();
+            elapsed_time += delta_time;
+
+            // 相机数据写入共享的 UBO，每帧只上传一次，与着色器程序数量无关
+            const FrameUniforms frame{
+                    .projection = glm::perspective(glm::radians(45.0f),
+                                                   static_cast<float>(window.get_width()) /
+                                                           static_cast<float>(window.get_height()),
+                                                   0.1f, 100.0f),
+                    .view = glm::lookAt(camera_pos, camera_pos + camera_front, camera_up),
+                    .view_pos = camera_pos,
+                    .time = static_cast<float>(elapsed_time),
+            };
+            {
+                const GpuZone stage(gpu_timer, "frame_uniforms");
+                frame_uniform_buffer->update(frame);
+            }
 
-            light_cube_shader->set_vec3("objectColor", 1.0f, 0.5f, 0.31f);
-            light_cube_shader->set_vec3("lightColor", 1.0f, 1.0f, 1.0f);
-            light_cube_shader->set_vec3("lightPos", light_pos);
-            light_cube_shader->set_vec3("viewPos", camera_pos);
+            glm::mat4 model = glm::mat4(1.0f);
+            {
+                const GpuZone stage(gpu_timer, "draw_object");
+                light_cube_shader->use();
 
-            // Projection setup
-            glm::mat4 projection = glm::perspective(
-                    glm::radians(45.0f),
-                    static_cast<float>(window.get_width()) / static_cast<float>(window.get_height()), 0.1f, 100.0f);
-            light_cube_shader->set_mat4("projection", projection);
+                light_cube_shader->set(lighting_uniforms.object_color, glm::vec3{1.0f, 0.5f, 0.31f});
+                light_cube_shader->set(lighting_uniforms.light_color, glm::vec3{1.0f, 1.0f, 1.0f});
+                light_cube_shader->set(lighting_uniforms.light_pos, light_pos);
 
-            // View setup
-            glm::mat4 view = glm::lookAt(camera_pos, camera_pos + camera_front, camera_up);
-            light_cube_shader->set_mat4("view", view);
+                // World transformation
+                light_cube_shader->set(lighting_uniforms.model, model);
 
-            // World transformation
-            glm::mat4 model = glm::mat4(1.0f);
-            light_cube_shader->set_mat4("model", model);
-
-            // Render object
-            glBindVertexArray(vertex_array_object);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+                // Render object
+                cube_mesh->bind();
+                cube_mesh->draw();
+            }
 
             // Render light source
+            const GpuZone stage(gpu_timer, "draw_lamp");
             light_shader->use();
-            light_shader->set_mat4("projection", projection);
-            light_shader->set_mat4("view", view);
 
             model = glm::mat4(1.0f);
             model = glm::translate(model, light_pos);
             model = glm::scale(model, glm::vec3(0.2f));
-            light_shader->set_mat4("model", model);
+            light_shader->set(lamp_uniforms.model, model);
 
-            glBindVertexArray(light_vertex_array_object);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            cube_mesh->draw();
         }
 
         auto on_event(const SDL_Event &event) -> SDL_AppResult override {
@@ -155,17 +174,30 @@ export namespace opengl_sandbox {
         }
 
         void on_quit() override {
-            glDeleteVertexArrays(1, &vertex_array_object);
-            glDeleteBuffers(1, &vertex_buffer_object);
+            frame_uniform_buffer.reset();
+            cube_mesh.reset();
         }
 
     private:
+        struct LightingUniforms {
+            UniformHandle<glm::vec3> object_color;
+            UniformHandle<glm::vec3> light_color;
+            UniformHandle<glm::vec3> light_pos;
+            UniformHandle<glm::mat4> model;
+        };
+
+        struct LampUniforms {
+            UniformHandle<glm::mat4> model;
+        };
+
         Window &window;
         std::shared_ptr<Shader> light_cube_shader = nullptr;
         std::shared_ptr<Shader> light_shader = nullptr;
-        unsigned int vertex_array_object{};
-        unsigned int vertex_buffer_object{};
-        unsigned int light_vertex_array_object{};
+        LightingUniforms lighting_uniforms{};
+        LampUniforms lamp_uniforms{};
+        std::unique_ptr<FrameUniformBuffer> frame_uniform_buffer = nullptr;
+        double elapsed_time = 0.0;
+        std::unique_ptr<gl_common::Mesh> cube_mesh = nullptr;
 
         glm::vec3 camera_pos{0.0f, 0.0f, 3.0f};
         glm::vec3 camera_front{0.0f, 0.0f, -1.0f};
@@ -3,16 +3,35 @@
 //
 module;
 
+#include <SDL3/SDL.h>
+#include <algorithm>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 export module opengl_sandbox.shader;
 
 import opengl_sandbox.file_operation;
+import opengl_sandbox.frame_uniforms;
+import opengl_sandbox.gl_stats;
+import opengl_sandbox.program_cache;
+
+/**
+ * 链接后解析出来的 uniform 句柄，T 为 C++ 侧的值类型
+ * 在初始化时通过 Shader::uniform<T>() 获取一次，之后每帧直接复用，不再查询 location
+ */
+export template<typename T>
+struct UniformHandle {
+    GLint location = -1;
+
+    [[nodiscard]] auto valid() const -> bool { return location >= 0; }
+};
 
 export class Shader {
 public:
@@ -20,86 +39,231 @@ public:
     ~Shader() = default;
     auto get_id() const -> unsigned int { return id; }
     auto use() const -> void;
-    auto set_bool(const std::string &name, bool value) const -> void;
-    auto set_int(const std::string &name, int value) const -> void;
-    auto set_float(const std::string &name, float value) const -> void;
-    auto set_vec2(const std::string &name, const glm::vec2 &value) const -> void;
-    auto set_vec2(const std::string &name, float x, float y) const -> void;
-    auto set_vec3(const std::string &name, const glm::vec3 &value) const -> void;
-    auto set_vec3(const std::string &name, float x, float y, float z) const -> void;
-    auto set_vec4(const std::string &name, const glm::vec4 &value) const -> void;
-    auto set_vec4(const std::string &name, float x, float y, float z, float w) const -> void;
-    auto set_mat2(const std::string &name, const glm::mat2 &mat) const -> void;
-    auto set_mat3(const std::string &name, const glm::mat3 &mat) const -> void;
-    auto set_mat4(const std::string &name, const glm::mat4 &mat) const -> void;
+
+    /// 程序中是否声明了 FrameUniforms block（已自动绑定到 FRAME_UNIFORMS_BINDING）
+    [[nodiscard]] auto uses_frame_uniforms() const -> bool { return has_frame_uniforms; }
+
+    /**
+     * 在链接时反射得到的 name → location 表中查找，不会调用 glGetUniformLocation，
+     * 但仍计入 GlCallCounter 的 uniform 查找次数，和优化前每次 set_* 都查一次 location 的做法对比
+     * @return 找不到（或被驱动优化掉）时返回 -1
+     */
+    [[nodiscard]] auto get_location(std::string_view name) const -> GLint;
+
+    template<typename T>
+    [[nodiscard]] auto uniform(const std::string_view name) const -> UniformHandle<T> {
+        return UniformHandle<T>{get_location(name)};
+    }
+
+    template<typename T>
+    auto set(UniformHandle<T> handle, const T &value) const -> void;
+
+    auto set_bool(std::string_view name, bool value) const -> void;
+    auto set_int(std::string_view name, int value) const -> void;
+    auto set_float(std::string_view name, float value) const -> void;
+    auto set_vec2(std::string_view name, const glm::vec2 &value) const -> void;
+    auto set_vec2(std::string_view name, float x, float y) const -> void;
+    auto set_vec3(std::string_view name, const glm::vec3 &value) const -> void;
+    auto set_vec3(std::string_view name, float x, float y, float z) const -> void;
+    auto set_vec4(std::string_view name, const glm::vec4 &value) const -> void;
+    auto set_vec4(std::string_view name, float x, float y, float z, float w) const -> void;
+    auto set_mat2(std::string_view name, const glm::mat2 &mat) const -> void;
+    auto set_mat3(std::string_view name, const glm::mat3 &mat) const -> void;
+    auto set_mat4(std::string_view name, const glm::mat4 &mat) const -> void;
 
 private:
+    struct UniformEntry {
+        std::string name;
+        GLint location;
+    };
+
+    static auto compile_and_link(const std::string &vertexCode, const std::string &fragmentCode) -> unsigned int;
+    auto reflect_uniforms() -> void;
+    auto bind_uniform_blocks() -> void;
+
     unsigned int id{};
+    bool has_frame_uniforms = false;
+    // 按名字排序的扁平表，用 string_view 做二分查找，调用方不需要构造 std::string
+    std::vector<UniformEntry> uniforms;
 };
 
 Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath) {
+    const auto start_ns = SDL_GetTicksNS();
     const auto vertexCode = opengl_sandbox::read_source_code(vertexPath);
     const auto fragmentCode = opengl_sandbox::read_source_code(fragmentPath);
 
+    // 源码与驱动都没变时直接加载上次链接好的二进制，跳过编译和链接
+    const auto cache_key = opengl_sandbox::ProgramCache::make_key(vertexCode, fragmentCode);
+    id = opengl_sandbox::ProgramCache::load(cache_key);
+    const auto cache_hit = id != 0;
+    if (not cache_hit) {
+        id = compile_and_link(vertexCode, fragmentCode);
+        opengl_sandbox::ProgramCache::store(cache_key, id);
+    }
+
+    reflect_uniforms();
+    bind_uniform_blocks();
+
+    SDL_Log("Shader %s + %s: %s in %.2f ms", vertexPath.c_str(), fragmentPath.c_str(),
+            cache_hit ? "loaded from cache" : "compiled", static_cast<double>(SDL_GetTicksNS() - start_ns) / 1e6);
+}
+
+auto Shader::compile_and_link(const std::string &vertexCode, const std::string &fragmentCode) -> unsigned int {
     const auto &vertexShader = opengl_sandbox::shader_compiler(vertexCode, GL_VERTEX_SHADER);
     const auto &fragmentShader = opengl_sandbox::shader_compiler(fragmentCode, GL_FRAGMENT_SHADER);
 
-    id = glCreateProgram();
-    glAttachShader(id, vertexShader);
-    glAttachShader(id, fragmentShader);
-    glLinkProgram(id);
+    const auto program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
 
     GLint success;
-    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char infoLog[512];
-        glGetProgramInfoLog(id, 512, nullptr, infoLog);
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        glDeleteProgram(program);
         std::string errorMessage = "Shader program linking failed: ";
         errorMessage += infoLog;
         throw std::runtime_error(errorMessage);
     }
+    return program;
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+auto Shader::bind_uniform_blocks() -> void {
+    const std::string block_name{opengl_sandbox::FRAME_UNIFORMS_BLOCK_NAME};
+    const auto block_index = glGetUniformBlockIndex(id, block_name.c_str());
+    has_frame_uniforms = block_index != GL_INVALID_INDEX;
+    if (has_frame_uniforms) {
+        glUniformBlockBinding(id, block_index, opengl_sandbox::FRAME_UNIFORMS_BINDING);
+    }
 }
 
-auto Shader::use() const -> void { glUseProgram(id); }
+auto Shader::reflect_uniforms() -> void {
+    GLint uniform_count = 0;
+    GLint max_name_length = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    std::string name_buffer(static_cast<std::size_t>(std::max(max_name_length, 1)), '\0');
+    uniforms.clear();
+    uniforms.reserve(static_cast<std::size_t>(uniform_count));
 
-auto Shader::set_bool(const std::string &name, const bool value) const -> void {
-    glUniform1i(glGetUniformLocation(id, name.c_str()), static_cast<int>(value));
+    for (GLint i = 0; i < uniform_count; ++i) {
+        GLsizei name_length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id, static_cast<GLuint>(i), max_name_length, &name_length, &size, &type,
+                           name_buffer.data());
+        std::string name{name_buffer.data(), static_cast<std::size_t>(name_length)};
+
+        // uniform block 中的成员没有 location，跳过
+        const auto location = glGetUniformLocation(id, name.c_str());
+        opengl_sandbox::GlCallCounter::add();
+        if (location < 0) {
+            continue;
+        }
+
+        // 数组 uniform 会以 "name[0]" 的形式返回，同时登记不带下标的名字
+        if (name.ends_with("[0]")) {
+            uniforms.push_back({name.substr(0, name.size() - 3), location});
+        }
+        uniforms.push_back({std::move(name), location});
+    }
+
+    std::ranges::sort(uniforms, {}, &UniformEntry::name);
+}
+
+auto Shader::get_location(const std::string_view name) const -> GLint {
+    opengl_sandbox::GlCallCounter::add_uniform_lookup();
+    const auto it = std::ranges::lower_bound(uniforms, name, {},
+                                             [](const UniformEntry &entry) { return std::string_view{entry.name}; });
+    if (it == uniforms.end() || it->name != name) {
+        return -1;
+    }
+    return it->location;
 }
 
-auto Shader::set_int(const std::string &name, const int value) const -> void {
-    glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+auto Shader::use() const -> void {
+    glUseProgram(id);
+    opengl_sandbox::GlCallCounter::add();
 }
 
-auto Shader::set_float(const std::string &name, const float value) const -> void {
-    glUniform1f(glGetUniformLocation(id, name.c_str()), value);
+template<typename T>
+auto Shader::set(const UniformHandle<T> handle, const T &value) const -> void {
+    if (not handle.valid()) {
+        return;
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+        glUniform1i(handle.location, static_cast<int>(value));
+    }
+    else if constexpr (std::is_same_v<T, int>) {
+        glUniform1i(handle.location, value);
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+        glUniform1f(handle.location, value);
+    }
+    else if constexpr (std::is_same_v<T, glm::vec2>) {
+        glUniform2fv(handle.location, 1, glm::value_ptr(value));
+    }
+    else if constexpr (std::is_same_v<T, glm::vec3>) {
+        glUniform3fv(handle.location, 1, glm::value_ptr(value));
+    }
+    else if constexpr (std::is_same_v<T, glm::vec4>) {
+        glUniform4fv(handle.location, 1, glm::value_ptr(value));
+    }
+    else if constexpr (std::is_same_v<T, glm::mat2>) {
+        glUniformMatrix2fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+    else if constexpr (std::is_same_v<T, glm::mat3>) {
+        glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+    else if constexpr (std::is_same_v<T, glm::mat4>) {
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+    else {
+        static_assert(sizeof(T) == 0, "Unsupported uniform type");
+    }
+    opengl_sandbox::GlCallCounter::add();
+}
+
+auto Shader::set_bool(const std::string_view name, const bool value) const -> void {
+    set(uniform<bool>(name), value);
+}
+
+auto Shader::set_int(const std::string_view name, const int value) const -> void { set(uniform<int>(name), value); }
+
+auto Shader::set_float(const std::string_view name, const float value) const -> void {
+    set(uniform<float>(name), value);
 }
-auto Shader::set_vec2(const std::string &name, const glm::vec2 &value) const -> void {
-    glUniform2fv(glGetUniformLocation(id, name.c_str()), 1, &value[0]);
+auto Shader::set_vec2(const std::string_view name, const glm::vec2 &value) const -> void {
+    set(uniform<glm::vec2>(name), value);
 }
-auto Shader::set_vec2(const std::string &name, float x, float y) const -> void {
-    glUniform2f(glGetUniformLocation(id, name.c_str()), x, y);
+auto Shader::set_vec2(const std::string_view name, float x, float y) const -> void {
+    set(uniform<glm::vec2>(name), glm::vec2{x, y});
 }
-auto Shader::set_vec3(const std::string &name, const glm::vec3 &value) const -> void {
-    glUniform3fv(glGetUniformLocation(id, name.c_str()), 1, &value[0]);
+auto Shader::set_vec3(const std::string_view name, const glm::vec3 &value) const -> void {
+    set(uniform<glm::vec3>(name), value);
 }
-auto Shader::set_vec3(const std::string &name, float x, float y, float z) const -> void {
-    glUniform3f(glGetUniformLocation(id, name.c_str()), x, y, z);
+auto Shader::set_vec3(const std::string_view name, float x, float y, float z) const -> void {
+    set(uniform<glm::vec3>(name), glm::vec3{x, y, z});
 }
-auto Shader::set_vec4(const std::string &name, const glm::vec4 &value) const -> void {
-    glUniform4fv(glGetUniformLocation(id, name.c_str()), 1, &value[0]);
+auto Shader::set_vec4(const std::string_view name, const glm::vec4 &value) const -> void {
+    set(uniform<glm::vec4>(name), value);
 }
-auto Shader::set_vec4(const std::string &name, float x, float y, float z, float w) const -> void {
-    glUniform4f(glGetUniformLocation(id, name.c_str()), x, y, z, w);
+auto Shader::set_vec4(const std::string_view name, float x, float y, float z, float w) const -> void {
+    set(uniform<glm::vec4>(name), glm::vec4{x, y, z, w});
 }
-auto Shader::set_mat2(const std::string &name, const glm::mat2 &mat) const -> void {
-    glUniformMatrix2fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+auto Shader::set_mat2(const std::string_view name, const glm::mat2 &mat) const -> void {
+    set(uniform<glm::mat2>(name), mat);
 }
-auto Shader::set_mat3(const std::string &name, const glm::mat3 &mat) const -> void {
-    glUniformMatrix3fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+auto Shader::set_mat3(const std::string_view name, const glm::mat3 &mat) const -> void {
+    set(uniform<glm::mat3>(name), mat);
 }
-auto Shader::set_mat4(const std::string &name, const glm::mat4 &mat) const -> void {
-    glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+auto Shader::set_mat4(const std::string_view name, const glm::mat4 &mat) const -> void {
+    set(uniform<glm::mat4>(name), mat);
 }
@@ -9,7 +9,11 @@ module;
 
 export module opengl_sandbox.window;
 
+import app_runtime.profiler;
+import app_runtime.trace;
 import opengl_sandbox.app;
+import opengl_sandbox.gl_stats;
+import opengl_sandbox.gpu_timer;
 
 export namespace opengl_sandbox {
     class Window {
@@ -27,6 +31,7 @@ export namespace opengl_sandbox {
         [[nodiscard]] auto get_width() const -> int { return window_width; }
         [[nodiscard]] auto get_height() const -> int { return window_height; }
         [[nodiscard]] auto get_native_window() const -> SDL_Window * { return window; }
+        [[nodiscard]] auto get_gpu_timer() -> GpuTimer & { return *gpu_timer; }
 
     private:
         std::string window_title;
@@ -38,11 +43,22 @@ export namespace opengl_sandbox {
 
         Application *application = nullptr;
 
+        // 和 hello_sdl 的示例一样按帧计时，支持 APP_RUNTIME_TRACE 和 APP_RUNTIME_FRAMES
+        app_runtime::FrameCapture capture;
+        // 设置了 APP_RUNTIME_CHROME_TRACE 时，退出时写出各个阶段的 CPU 和 GPU 耗时
+        app_runtime::trace::Session trace_session;
+        // 需要 GL 上下文，在 window_init() 中创建，在销毁上下文之前销毁
+        std::unique_ptr<GpuTimer> gpu_timer;
+
+        Uint64 last_stats_report = 0;
+
         auto window_init() -> void;
+        auto render_frame() -> void;
+        auto report_stats() -> void;
     };
 
     Window::Window(const std::string_view &title, const int width, const int height) :
-        window_title(title), window_width(width), window_height(height) {
+        window_title(title), window_width(width), window_height(height), capture(window_title) {
         window_init();
     }
 
@@ -50,6 +66,7 @@ export namespace opengl_sandbox {
         if (application) {
             application->on_quit();
         }
+        gpu_timer.reset();
         SDL_GL_DestroyContext(gl_context);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -77,9 +94,28 @@ export namespace opengl_sandbox {
     }
 
     auto Window::handle_iterate() -> SDL_AppResult {
+        const app_runtime::trace::Zone zone("handle_iterate");
+        capture.begin_frame();
+        {
+            const app_runtime::ScopedTimer timer(capture.get_profiler(), app_runtime::FrameCapture::ITERATION_SCOPE);
+            render_frame();
+        }
+        const auto finished = capture.end_frame();
+        report_stats();
+        // 设置了 APP_RUNTIME_FRAMES 时跑满帧数就退出，无头基准靠它结束
+        return finished ? SDL_APP_SUCCESS : SDL_APP_CONTINUE;
+    }
+
+    auto Window::render_frame() -> void {
+        gpu_timer->begin_frame();
+
         // Clear background
-        glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            const GpuZone clear_zone(*gpu_timer, "clear");
+            glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            GlCallCounter::add(2);
+        }
 
         if (application) {
             const auto current_time = SDL_GetTicks();
@@ -94,9 +130,32 @@ export namespace opengl_sandbox {
             application->on_update(delta_time);
         }
 
-        SDL_GL_SwapWindow(window);
+        {
+            // 开了垂直同步时等待通常落在这里
+            const app_runtime::trace::Zone swap_zone("swap");
+            SDL_GL_SwapWindow(window);
+        }
+        GlCallCounter::end_frame();
+    }
 
-        return SDL_APP_CONTINUE;
+    auto Window::report_stats() -> void {
+        // 每秒输出一次平均每帧的 GL 调用数和 GPU 耗时；uniform 查找在优化前各是一次 glGetUniformLocation
+        if (const auto now = SDL_GetTicks(); now - last_stats_report >= 1000) {
+            if (gpu_timer->is_available()) {
+                SDL_Log("GL calls per frame: %.1f, uniform lookups %.1f, GPU %.3f ms per frame "
+                        "(%.1f timer query calls, %llu frames dropped)",
+                        GlCallCounter::get_average_calls(), GlCallCounter::get_average_uniform_lookups(),
+                        gpu_timer->get_average_ms(), GlCallCounter::get_average_queries(),
+                        static_cast<unsigned long long>(gpu_timer->get_dropped_frames()));
+                gpu_timer->reset_average();
+            }
+            else {
+                SDL_Log("GL calls per frame: %.1f, uniform lookups %.1f", GlCallCounter::get_average_calls(),
+                        GlCallCounter::get_average_uniform_lookups());
+            }
+            GlCallCounter::reset_average();
+            last_stats_report = now;
+        }
     }
 
     auto Window::window_init() -> void {
@@ -131,5 +190,7 @@ export namespace opengl_sandbox {
 
         SDL_SetWindowRelativeMouseMode(window, true);
         SDL_GL_SetSwapInterval(1);
+
+        gpu_timer = std::make_unique<GpuTimer>();
     }
 } // namespace opengl_sandbox
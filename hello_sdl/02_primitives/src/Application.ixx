@@ -8,67 +8,55 @@ module;
 
 export module Primitives.Application;
 
+import app_runtime;
+
 export class Application {
 public:
     explicit Application(const std::string_view &title, int width, int height);
-    ~Application();
     auto update() -> SDL_AppResult;
     auto handle_event(const SDL_Event *event) -> void;
 
 private:
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
-    std::array<SDL_FPoint, 100> points{};
-
     const std::string_view window_title;
     const int window_width;
     const int window_height;
+
+    // 窗口和渲染器由 runtime 创建和销毁
+    app_runtime::Runtime runtime;
+    std::array<SDL_FPoint, 100> points{};
+
+    auto draw(SDL_Renderer *renderer) -> void;
 };
 
 Application::Application(const std::string_view &title, const int width, const int height) :
-    window_title(title), window_width(width), window_height(height) {
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        const auto result = std::format("SDL initialization failed: {}", SDL_GetError());
-        throw std::runtime_error(result);
-    }
-    if (not SDL_CreateWindowAndRenderer(window_title.data(), window_width, window_height, SDL_WINDOW_RESIZABLE, &window,
-                                        &renderer)) {
-        const auto result = std::format("SDL CreateWindowAndRenderer failed: {}", SDL_GetError());
-        SDL_Quit();
-        throw std::runtime_error(result);
-    }
-    SDL_SetRenderLogicalPresentation(renderer, window_width, window_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-
+    window_title(title), window_width(width), window_height(height),
+    runtime({.title = title, .width = width, .height = height}) {
     for (auto &[x, y]: points) {
         x = (SDL_randf() * 440.0f) + 100.0f;
         y = (SDL_randf() * 280.0f) + 100.0f;
     }
 }
 
-
-Application::~Application() {
-    if (renderer) {
-        SDL_DestroyRenderer(renderer);
-    }
-    if (window) {
-        SDL_DestroyWindow(window);
-    }
-    SDL_Quit();
+auto Application::update() -> SDL_AppResult {
+    return runtime.iterate([this] {
+        draw(runtime.get_renderer());
+        return SDL_APP_CONTINUE;
+    });
 }
 
-auto Application::update() -> SDL_AppResult {
+auto Application::draw(SDL_Renderer *renderer) -> void {
     SDL_FRect rect;
 
     /* as you can see from this, rendering draws over whatever was drawn before it. */
-    SDL_SetRenderDrawColor(renderer, 48, 52, 70, SDL_ALPHA_OPAQUE); /* dark gray, full alpha */
-    SDL_RenderClear(renderer); /* start with a blank canvas. */
+    app_runtime::set_draw_color(renderer, 48, 52, 70, SDL_ALPHA_OPAQUE); /* dark gray, full alpha */
+    app_runtime::clear(renderer); /* start with a blank canvas. */
 
     /* draw a filled rectangle in the middle of the canvas. */
-    SDL_SetRenderDrawColor(renderer, 65, 69, 89, SDL_ALPHA_OPAQUE); /* blue, full alpha */
+    app_runtime::set_draw_color(renderer, 65, 69, 89, SDL_ALPHA_OPAQUE); /* blue, full alpha */
     rect.x = rect.y = 0;
     rect.w = this->window_width;
     rect.h = this->window_height;
-    SDL_RenderFillRect(renderer, &rect);
+    app_runtime::render_fill_rect(renderer, &rect);
 
     /* draw some points across the canvas with gradient colors and alpha. */
     const auto ticks = SDL_GetTicks();
@@ -87,29 +75,28 @@ auto Application::update() -> SDL_AppResult {
         // Vary alpha to create transparency effect
         const auto alpha = static_cast<Uint8>(128 + 127 * SDL_sin(time_offset * 2.0 + point_offset * SDL_PI_D * 2.0));
 
-        SDL_SetRenderDrawColor(renderer, red, green, blue, alpha);
-        SDL_RenderPoint(renderer, points[i].x, points[i].y);
+        app_runtime::set_draw_color(renderer, red, green, blue, alpha);
+        app_runtime::render_point(renderer, points[i].x, points[i].y);
     }
 
     /* draw a unfilled rectangle in-set a little bit. */
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE); /* green, full alpha */
+    app_runtime::set_draw_color(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE); /* green, full alpha */
     rect.x += 30;
     rect.y += 30;
     rect.w -= 60;
     rect.h -= 60;
-    SDL_RenderRect(renderer, &rect);
+    app_runtime::render_rect(renderer, &rect);
 
     /* draw two lines in an X across the whole canvas. */
     // SDL_SetRenderDrawColor(renderer, 255, 255, 0, SDL_ALPHA_OPAQUE);  /* yellow, full alpha */
     // SDL_RenderLine(renderer, 0, 0, 640, 480);
     // SDL_RenderLine(renderer, 0, 480, 640, 0);
 
-    SDL_RenderPresent(renderer); /* put it all on the screen! */
-
-    return SDL_APP_CONTINUE;
+    runtime.present(); /* put it all on the screen! */
 }
 
 
 auto Application::handle_event(const SDL_Event *event) -> void {
     // Currently no special event handling; quit is managed in main loop.
+    runtime.handle_event(event);
 }
@@ -5,57 +5,46 @@ module;
 
 export module Lines.Application;
 
+import app_runtime;
+
 export class Application {
 public:
     explicit Application(const std::string_view &title, int width, int height);
-    ~Application();
     auto update() -> SDL_AppResult;
     auto handle_event(const SDL_Event *event) -> void;
 
 
 private:
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
     const std::string_view window_title;
     const int window_width;
     const int window_height;
+    // 窗口和渲染器由 runtime 创建和销毁
+    app_runtime::Runtime runtime;
     std::array<SDL_FPoint, 100> points{};
+
+    auto draw(SDL_Renderer *renderer) -> void;
 };
 
 Application::Application(const std::string_view &title, const int width, const int height) :
-    window_title(title), window_width(width), window_height(height) {
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        const auto result = "SDL initialization failed: " + std::string(SDL_GetError());
-        throw std::runtime_error(result);
-    }
-    if (not SDL_CreateWindowAndRenderer(window_title.data(), window_width, window_height, SDL_WINDOW_RESIZABLE, &window,
-                                        &renderer)) {
-        const auto result = "SDL CreateWindowAndRenderer failed: " + std::string(SDL_GetError());
-        SDL_Quit();
-        throw std::runtime_error(result);
-    }
-    SDL_SetRenderLogicalPresentation(renderer, window_width, window_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-
+    window_title(title), window_width(width), window_height(height),
+    runtime({.title = title, .width = width, .height = height}) {
     for (auto &[x, y]: points) {
         x = (SDL_randf() * window_width);
         y = (SDL_randf() * window_height);
     }
 }
 
-Application::~Application() {
-    if (renderer) {
-        SDL_DestroyRenderer(renderer);
-    }
-    if (window) {
-        SDL_DestroyWindow(window);
-    }
-    SDL_Quit();
+auto Application::update() -> SDL_AppResult {
+    return runtime.iterate([this] {
+        draw(runtime.get_renderer());
+        return SDL_APP_CONTINUE;
+    });
 }
 
-auto Application::update() -> SDL_AppResult {
+auto Application::draw(SDL_Renderer *renderer) -> void {
     // a basic window with background color which like night
-    SDL_SetRenderDrawColor(renderer, 10, 10, 30, 255);
-    SDL_RenderClear(renderer);
+    app_runtime::set_draw_color(renderer, 10, 10, 30, 255);
+    app_runtime::clear(renderer);
 
     const auto ticks = SDL_GetTicks();
     const auto current_time = static_cast<double>(ticks) / 1000.0f;
@@ -70,7 +59,7 @@ auto Application::update() -> SDL_AppResult {
         const auto blue = static_cast<Uint8>(255 * (0.7 + 0.3 * SDL_sin(time_offset + point_offset * SDL_PI_D * 3.0)));
         const auto alpha = static_cast<Uint8>(128 + 127 * SDL_sin(time_offset * 2.0 + point_offset * SDL_PI_D * 2.0));
 
-        SDL_SetRenderDrawColor(renderer, red, green, blue, alpha);
+        app_runtime::set_draw_color(renderer, red, green, blue, alpha);
 
         // Draw larger stars using small cross pattern
         const float x = points[i].x;
@@ -78,13 +67,13 @@ auto Application::update() -> SDL_AppResult {
         const float size = 2.0f;
 
         // Draw center point
-        SDL_RenderPoint(renderer, x, y);
+        app_runtime::render_point(renderer, x, y);
         // Draw cross arms
-        SDL_RenderLine(renderer, x - size, y, x + size, y);
-        SDL_RenderLine(renderer, x, y - size, x, y + size);
+        app_runtime::render_line(renderer, x - size, y, x + size, y);
+        app_runtime::render_line(renderer, x, y - size, x, y + size);
         // Add diagonal lines for sparkle effect
-        SDL_RenderLine(renderer, x - size * 0.7f, y - size * 0.7f, x + size * 0.7f, y + size * 0.7f);
-        SDL_RenderLine(renderer, x - size * 0.7f, y + size * 0.7f, x + size * 0.7f, y - size * 0.7f);
+        app_runtime::render_line(renderer, x - size * 0.7f, y - size * 0.7f, x + size * 0.7f, y + size * 0.7f);
+        app_runtime::render_line(renderer, x - size * 0.7f, y + size * 0.7f, x + size * 0.7f, y - size * 0.7f);
     }
 
     // Draw Christmas Tree
@@ -92,13 +81,13 @@ auto Application::update() -> SDL_AppResult {
     const float baseY = window_height - 100.0f;
 
     // Draw tree trunk (brown)
-    SDL_SetRenderDrawColor(renderer, 139, 69, 19, 255);
+    app_runtime::set_draw_color(renderer, 139, 69, 19, 255);
     for (int i = 0; i < 30; i++) {
-        SDL_RenderLine(renderer, centerX - 15, baseY - i, centerX + 15, baseY - i);
+        app_runtime::render_line(renderer, centerX - 15, baseY - i, centerX + 15, baseY - i);
     }
 
     // Draw three layers of tree foliage (green triangles)
-    SDL_SetRenderDrawColor(renderer, 34, 139, 34, 255);
+    app_runtime::set_draw_color(renderer, 34, 139, 34, 255);
 
     // Bottom layer - widest at bottom, narrower at top
     float layerBottom = baseY - 30;
@@ -107,7 +96,7 @@ auto Application::update() -> SDL_AppResult {
     for (float y = layerBottom - layerHeight; y < layerBottom; y += 1.0f) {
         float progress = (layerBottom - y) / layerHeight; // 1.0 at top, 0.0 at bottom
         float width = maxWidth * (1.0f - progress); // wider at bottom
-        SDL_RenderLine(renderer, centerX - width, y, centerX + width, y);
+        app_runtime::render_line(renderer, centerX - width, y, centerX + width, y);
     }
 
     // Middle layer
@@ -117,7 +106,7 @@ auto Application::update() -> SDL_AppResult {
     for (float y = layerBottom - layerHeight; y < layerBottom; y += 1.0f) {
         float progress = (layerBottom - y) / layerHeight;
         float width = maxWidth * (1.0f - progress);
-        SDL_RenderLine(renderer, centerX - width, y, centerX + width, y);
+        app_runtime::render_line(renderer, centerX - width, y, centerX + width, y);
     }
 
     // Top layer
@@ -127,29 +116,31 @@ auto Application::update() -> SDL_AppResult {
     for (float y = layerBottom - layerHeight; y < layerBottom; y += 1.0f) {
         float progress = (layerBottom - y) / layerHeight;
         float width = maxWidth * (1.0f - progress);
-        SDL_RenderLine(renderer, centerX - width, y, centerX + width, y);
+        app_runtime::render_line(renderer, centerX - width, y, centerX + width, y);
     }
 
     // Draw star on top (golden yellow, with animation)
     const float starPulse = 0.5f + 0.5f * SDL_sin(current_time * 3.0);
     const Uint8 starBrightness = static_cast<Uint8>(200 + 55 * starPulse);
-    SDL_SetRenderDrawColor(renderer, starBrightness, starBrightness, 50, 255);
+    app_runtime::set_draw_color(renderer, starBrightness, starBrightness, 50, 255);
 
     float starTop = baseY - 210;
     float starSize = 20;
     // Draw a 5-pointed star
-    SDL_RenderLine(renderer, centerX, starTop, centerX - starSize * 0.3f, starTop + starSize * 0.8f);
-    SDL_RenderLine(renderer, centerX - starSize * 0.3f, starTop + starSize * 0.8f, centerX - starSize,
-                   starTop + starSize * 0.3f);
-    SDL_RenderLine(renderer, centerX - starSize, starTop + starSize * 0.3f, centerX - starSize * 0.5f,
-                   starTop + starSize * 1.2f);
-    SDL_RenderLine(renderer, centerX - starSize * 0.5f, starTop + starSize * 1.2f, centerX, starTop + starSize);
-    SDL_RenderLine(renderer, centerX, starTop + starSize, centerX + starSize * 0.5f, starTop + starSize * 1.2f);
-    SDL_RenderLine(renderer, centerX + starSize * 0.5f, starTop + starSize * 1.2f, centerX + starSize,
-                   starTop + starSize * 0.3f);
-    SDL_RenderLine(renderer, centerX + starSize, starTop + starSize * 0.3f, centerX + starSize * 0.3f,
-                   starTop + starSize * 0.8f);
-    SDL_RenderLine(renderer, centerX + starSize * 0.3f, starTop + starSize * 0.8f, centerX, starTop);
+    app_runtime::render_line(renderer, centerX, starTop, centerX - starSize * 0.3f, starTop + starSize * 0.8f);
+    app_runtime::render_line(renderer, centerX - starSize * 0.3f, starTop + starSize * 0.8f, centerX - starSize,
+                             starTop + starSize * 0.3f);
+    app_runtime::render_line(renderer, centerX - starSize, starTop + starSize * 0.3f, centerX - starSize * 0.5f,
+                             starTop + starSize * 1.2f);
+    app_runtime::render_line(renderer, centerX - starSize * 0.5f, starTop + starSize * 1.2f, centerX,
+                             starTop + starSize);
+    app_runtime::render_line(renderer, centerX, starTop + starSize, centerX + starSize * 0.5f,
+                             starTop + starSize * 1.2f);
+    app_runtime::render_line(renderer, centerX + starSize * 0.5f, starTop + starSize * 1.2f, centerX + starSize,
+                             starTop + starSize * 0.3f);
+    app_runtime::render_line(renderer, centerX + starSize, starTop + starSize * 0.3f, centerX + starSize * 0.3f,
+                             starTop + starSize * 0.8f);
+    app_runtime::render_line(renderer, centerX + starSize * 0.3f, starTop + starSize * 0.8f, centerX, starTop);
 
     // Draw colorful twinkling light bulbs
     const int ornamentPositions[][2] = {{-70, -80}, {70, -80},   {-50, -120}, {50, -120}, {0, -150},
@@ -211,7 +202,7 @@ auto Application::update() -> SDL_AppResult {
                 r = g = b = static_cast<Uint8>(255 * twinkle);
         }
 
-        SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+        app_runtime::set_draw_color(renderer, r, g, b, 255);
 
         // Draw bulb shape (circle filled with lines)
         const float bulbRadius = 6.0f;
@@ -220,26 +211,26 @@ auto Application::update() -> SDL_AppResult {
             const float y1 = ornY + bulbRadius * SDL_sin(angle);
             const float x2 = ornX + bulbRadius * SDL_cos(angle + 0.2f);
             const float y2 = ornY + bulbRadius * SDL_sin(angle + 0.2f);
-            SDL_RenderLine(renderer, x1, y1, x2, y2);
+            app_runtime::render_line(renderer, x1, y1, x2, y2);
         }
 
         // Add bright center highlight when bulb is bright
         if (twinkle > 0.7f) {
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 200);
+            app_runtime::set_draw_color(renderer, 255, 255, 255, 200);
             for (float angle = 0; angle < 2 * SDL_PI_D; angle += 0.3f) {
                 const float x1 = ornX + 2.5f * SDL_cos(angle);
                 const float y1 = ornY + 2.5f * SDL_sin(angle);
                 const float x2 = ornX + 2.5f * SDL_cos(angle + 0.3f);
                 const float y2 = ornY + 2.5f * SDL_sin(angle + 0.3f);
-                SDL_RenderLine(renderer, x1, y1, x2, y2);
+                app_runtime::render_line(renderer, x1, y1, x2, y2);
             }
         }
     }
 
-    SDL_RenderPresent(renderer);
-    return SDL_APP_CONTINUE;
+    runtime.present();
 }
 
 auto Application::handle_event(const SDL_Event *event) -> void {
     // currently no event to handle
+    runtime.handle_event(event);
 }
@@ -3,15 +3,29 @@
 //
 module;
 #include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
 #include <format>
+#include <memory>
 #include <string_view>
-#include <vector>
 
 export module Points.Application;
 
+import app_runtime;
+import app_runtime.jobs;
+import Points.ParallelSimulation;
+import Points.Simulation;
+import Points.SnowRenderer;
+
 export class Application {
 public:
-    explicit Application(const std::string_view &title, int width, int height);
+    static constexpr int DEFAULT_NUM_POINTS = 1200;
+
+    /// worker_count 为 0 时只在当前线程模拟；seed 为 0 时使用随机种子
+    explicit Application(const std::string_view &title, int width, int height,
+                         int point_count = DEFAULT_NUM_POINTS,
+                         unsigned int worker_count = app_runtime::JobSystem::default_worker_count(),
+                         std::uint64_t seed = 0);
     ~Application();
     auto handle_event(const SDL_Event *event) -> SDL_AppResult;
     auto update() -> SDL_AppResult;
@@ -21,12 +35,14 @@ private:
     const int window_width;
     const int window_height;
 
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
+    // 窗口和渲染器由 runtime 创建和销毁，必须比 snow_renderer 里的纹理活得久
+    app_runtime::Runtime runtime;
+
+    std::unique_ptr<SnowRenderer> snow_renderer = nullptr;
 
     Uint64 last_time = 0;
     Uint64 last_wind_change = 0;
-    const int num_points = 1200; // 增加粒子数量
+    const int num_points; // 粒子数量，可通过 --flakes 指定
     const int min_pixel_per_second = 20;
     const int max_pixel_per_second = 120;
 
@@ -39,56 +55,38 @@ private:
     const int wind_change_interval = 3000; // 风向改变间隔（毫秒）
     const float wind_transition_speed = 0.5f; // 风向过渡速度
 
-    std::vector<SDL_FPoint> points{};
-    std::vector<float> point_speeds{};
-    std::vector<float> point_sizes{}; // 雪花大小
-    std::vector<Uint8> point_alphas{}; // 雪花透明度
-    std::vector<float> point_swing_phase{}; // 摆动相位
-    std::vector<float> point_swing_amplitude{}; // 摆动幅度
-};
-
-Application::Application(const std::string_view &title, const int width, const int height) :
-    window_title{title}, window_width{width}, window_height{height} {
-    SDL_SetAppMetadata("Example Renderer Points", "1.0", "com.claude-rainer.renderer-points");
-
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        const auto result = std::format("Couldn't initialize SDL {}", SDL_GetError());
-        SDL_Log(result.data());
-        throw std::runtime_error(result);
-    }
-
-    if (not SDL_CreateWindowAndRenderer(title.data(), width, height, 0, &window, &renderer)) {
-        const auto result = std::format("Couldn't create window and renderer: {}", SDL_GetError());
-        SDL_Log(result.data());
-        throw std::runtime_error(result);
-    }
-
-    SDL_SetRenderLogicalPresentation(renderer, width, height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-
-    points.resize(num_points);
-    point_speeds.resize(num_points);
-    point_sizes.resize(num_points);
-    point_alphas.resize(num_points);
-    point_swing_phase.resize(num_points);
-    point_swing_amplitude.resize(num_points);
-
-    for (int i = 0; i < num_points; ++i) {
-        points.at(i).x = SDL_randf() * static_cast<float>(window_width);
-        points.at(i).y = SDL_randf() * static_cast<float>(window_height);
-        point_speeds.at(i) = min_pixel_per_second + SDL_randf() * (max_pixel_per_second - min_pixel_per_second);
+    // 粒子按块在作业系统上并行模拟，渲染只读已经完成的快照；job_system 必须比 simulation 活得久
+    std::unique_ptr<app_runtime::JobSystem> job_system = nullptr;
+    std::unique_ptr<points::ParallelSimulation> simulation = nullptr;
 
-        // 不同大小的雪花 (1.0 到 4.0)
-        point_sizes.at(i) = 1.0f + SDL_randf() * 3.0f;
-
-        // 不同透明度，大的雪花更不透明（更近），小的更透明（更远）
-        point_alphas.at(i) = static_cast<Uint8>(150 + (point_sizes.at(i) / 4.0f) * 105);
+    auto step(SDL_Renderer *renderer) -> void;
+    /// runtime 每秒更新一次帧时间统计，更新后写到窗口标题和日志里
+    auto report_frame_time() -> void;
+};
 
-        // 随机摆动相位
-        point_swing_phase.at(i) = SDL_randf() * 6.28f; // 0 到 2π
+Application::Application(const std::string_view &title, const int width, const int height, const int point_count,
+                         const unsigned int worker_count, std::uint64_t seed) :
+    window_title{title}, window_width{width}, window_height{height},
+    runtime({.title = title, .width = width, .height = height, .window_flags = 0}), num_points{point_count} {
+    auto *renderer = runtime.get_renderer();
+    snow_renderer = std::make_unique<SnowRenderer>(renderer);
+    SDL_Log("Renderer: %s, %d flakes", SDL_GetRendererName(renderer), num_points);
 
-        // 摆动幅度与大小相关，小雪花摆动更明显
-        point_swing_amplitude.at(i) = (5.0f - point_sizes.at(i)) * 8.0f;
+    if (seed == 0) {
+        seed = SDL_GetPerformanceCounter();
     }
+    const points::SimulationParams simulation_params{
+            .width = static_cast<float>(window_width),
+            .height = static_cast<float>(window_height),
+            .min_speed = static_cast<float>(min_pixel_per_second),
+            .max_speed = static_cast<float>(max_pixel_per_second),
+    };
+    job_system = std::make_unique<app_runtime::JobSystem>(worker_count);
+    simulation = std::make_unique<points::ParallelSimulation>(*job_system, static_cast<std::size_t>(num_points),
+                                                              simulation_params, seed);
+    SDL_Log("Simulation: %s backend, %zu chunks on %zu threads, seed %llu",
+            points::backend_name(points::best_backend()).data(), simulation->get_chunk_count(),
+            job_system->get_thread_count(), static_cast<unsigned long long>(seed));
 
     last_time = SDL_GetTicks();
     last_wind_change = last_time;
@@ -101,28 +99,32 @@ Application::Application(const std::string_view &title, const int width, const i
 }
 
 Application::~Application() {
-    if (renderer) {
-        SDL_DestroyRenderer(renderer);
-        renderer = nullptr;
-    }
-    if (window) {
-        SDL_DestroyWindow(window);
-        window = nullptr;
-    }
-    SDL_Quit();
+    simulation.reset();
+    job_system.reset();
+    snow_renderer.reset();
 }
 
 auto Application::handle_event(const SDL_Event *event) -> SDL_AppResult {
     if (event->type == SDL_EVENT_QUIT) {
         return SDL_APP_SUCCESS;
     }
+    runtime.handle_event(event);
     return SDL_APP_CONTINUE;
 }
 
 auto Application::update() -> SDL_AppResult {
+    const auto result = runtime.iterate([this] {
+        step(runtime.get_renderer());
+        return SDL_APP_CONTINUE;
+    });
+    report_frame_time();
+    return result;
+}
+
+auto Application::step(SDL_Renderer *renderer) -> void {
     // a basic window with background color which like night
-    SDL_SetRenderDrawColor(renderer, 10, 10, 30, 255);
-    SDL_RenderClear(renderer);
+    app_runtime::set_draw_color(renderer, 10, 10, 30, 255);
+    app_runtime::clear(renderer);
 
     const auto now = SDL_GetTicks();
     const auto elapsed = static_cast<float>(now - last_time) / 1000.0f; /* in seconds */
@@ -140,60 +142,36 @@ auto Application::update() -> SDL_AppResult {
     wind_direction_x += (target_wind_direction_x - wind_direction_x) * wind_transition_speed * elapsed;
     wind_speed += (target_wind_speed - wind_speed) * wind_transition_speed * elapsed;
 
-    // 更新每个粒子的位置
-    for (int i = 0; i < num_points; ++i) {
-        // 垂直方向：主要受重力影响（向下）
-        const auto vertical_distance = elapsed * point_speeds.at(i);
-        points.at(i).y += vertical_distance;
-
-        // 水平方向：受风影响
-        const auto horizontal_distance = elapsed * wind_speed * wind_direction_x;
-        points.at(i).x += horizontal_distance;
-
-        // 添加正弦摆动效果
-        point_swing_phase.at(i) += elapsed * 2.0f; // 摆动速度
-        const auto swing_offset = SDL_sinf(point_swing_phase.at(i)) * point_swing_amplitude.at(i) * elapsed;
-        points.at(i).x += swing_offset;
-
-        // 当粒子超出屏幕边界时，重新从顶部随机位置生成
-        if (points.at(i).y > window_height || points.at(i).x < -50 || points.at(i).x > window_width + 50) {
-            // 从顶部随机位置重新生成
-            points.at(i).x = SDL_randf() * static_cast<float>(window_width);
-            points.at(i).y = -20.0f; // 从顶部稍微上方开始
-            // 随机化下落速度
-            point_speeds.at(i) = min_pixel_per_second + SDL_randf() * (max_pixel_per_second - min_pixel_per_second);
-            // 重新随机化摆动相位
-            point_swing_phase.at(i) = SDL_randf() * 6.28f;
-        }
-
-        // 根据大小和透明度绘制雪花
-        const auto size = point_sizes.at(i);
-        const auto alpha = point_alphas.at(i);
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, alpha);
-
-        if (size <= 1.5f) {
-            // 小雪花：单个点
-            SDL_RenderPoint(renderer, points.at(i).x, points.at(i).y);
-        }
-        else {
-            // 大雪花：绘制小圆形
-            const auto center_x = points.at(i).x;
-            const auto center_y = points.at(i).y;
-            const auto radius = static_cast<int>(size);
-
-            // 绘制填充圆（使用简单的点阵方法）
-            for (int dy = -radius; dy <= radius; ++dy) {
-                for (int dx = -radius; dx <= radius; ++dx) {
-                    if (dx * dx + dy * dy <= radius * radius) {
-                        SDL_RenderPoint(renderer, center_x + dx, center_y + dy);
-                    }
-                }
-            }
-        }
+    // 收下上一帧派发的模拟结果，再派发这一帧的模拟（下落、风、正弦摆动、重新生成），
+    // 工作线程推进粒子的同时，当前线程绘制刚刚完成的快照
+    {
+        const auto timer = runtime.scope("simulate");
+        simulation->finish();
+        simulation->step_async({.dt = elapsed, .wind_dx = wind_speed * wind_direction_x});
     }
 
+    // 只把雪花追加进批次，整帧一次 SDL_RenderGeometry 提交
+    const auto timer = runtime.scope("draw");
+    const auto &snapshot = simulation->get_snapshot();
+    const auto &field = simulation->get_field();
+    snow_renderer->begin(field.count);
+    for (std::size_t i = 0; i < field.count; ++i) {
+        snow_renderer->add(snapshot.x[i], snapshot.y[i], SnowRenderer::radius_for_size(field.size[i]),
+                           field.alpha[i]);
+    }
+    snow_renderer->submit();
+
     last_time = now;
 
-    SDL_RenderPresent(renderer); /* put it all on the screen! */
-    return SDL_APP_CONTINUE;
+    runtime.present(); /* put it all on the screen! */
+}
+
+auto Application::report_frame_time() -> void {
+    if (not runtime.consume_stats_update()) {
+        return;
+    }
+    const auto average_ms = runtime.get_stats().frame_ms.mean;
+    const auto title = std::format("{} | {} flakes | {:.2f} ms/frame", window_title, num_points, average_ms);
+    SDL_SetWindowTitle(runtime.get_window(), title.c_str());
+    SDL_Log("Frame time: %.2f ms (%d flakes)", average_ms, num_points);
 }
@@ -0,0 +1,110 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+export module Points.ParallelSimulation;
+
+import app_runtime.jobs;
+import Points.Simulation;
+
+export namespace points {
+    /// 给渲染阶段读取的一份位置快照，大小和透明度在模拟中不变，直接从 SnowField 读取
+    struct SnowSnapshot {
+        AlignedVector<float> x;
+        AlignedVector<float> y;
+    };
+
+    /**
+     * 把 SnowField 切成固定大小的块在 app_runtime::JobSystem 上并行模拟
+     * 每块有自己的随机数流 (seed, 块下标)，结果只取决于种子和块大小，与线程数、调度顺序无关
+     * 每一步把位置写进后台快照，finish() 之后交换，渲染阶段只读前台快照，可以和下一步模拟同时进行
+     */
+    class ParallelSimulation {
+    public:
+        /// 16 的倍数，每块的起点都落在 64 字节缓存行边界上，相邻块不会写同一个缓存行
+        static constexpr std::size_t CHUNK_SIZE = 16384;
+
+        ParallelSimulation(app_runtime::JobSystem &job_system, const std::size_t particle_count,
+                           const SimulationParams &params, const std::uint64_t seed,
+                           const Backend backend = best_backend()) :
+            jobs(job_system), simulation_params(params), simulation_backend(backend) {
+            auto rng = RngStream::from_seed(seed);
+            seed_field(field, particle_count, params, rng);
+
+            const auto chunk_count = (field.padded_count() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            chunks.resize(chunk_count);
+            for (std::size_t i = 0; i < chunk_count; ++i) {
+                chunks[i].rng = RngStream::from_seed(seed, i + 1);
+            }
+
+            for (auto &snapshot: snapshots) {
+                snapshot.x.assign(field.x.begin(), field.x.end());
+                snapshot.y.assign(field.y.begin(), field.y.end());
+            }
+        }
+
+        ~ParallelSimulation() { finish(); }
+
+        ParallelSimulation(const ParallelSimulation &) = delete;
+        auto operator=(const ParallelSimulation &) -> ParallelSimulation & = delete;
+
+        /// 派发一步模拟后立即返回，结果写入后台快照
+        auto step_async(const StepParams &step) -> void {
+            finish();
+            current_step = step;
+            in_flight = true;
+            jobs.dispatch(chunks.size(), [this](const std::size_t chunk) { simulate_chunk(chunk); });
+        }
+
+        /// 等待正在进行的一步完成并交换快照，没有正在进行的模拟时什么也不做
+        auto finish() -> void {
+            if (not in_flight) {
+                return;
+            }
+            jobs.wait();
+            front = 1 - front;
+            in_flight = false;
+        }
+
+        auto step(const StepParams &step) -> void {
+            step_async(step);
+            finish();
+        }
+
+        /// 最近一次完成的模拟结果，在下一次 finish() 之前保持不变
+        [[nodiscard]] auto get_snapshot() const -> const SnowSnapshot & { return snapshots[front]; }
+
+        /// 只有 size、alpha 可以在模拟进行时读取，其余字段正在被工作线程写入
+        [[nodiscard]] auto get_field() const -> const SnowField & { return field; }
+
+        [[nodiscard]] auto get_chunk_count() const -> std::size_t { return chunks.size(); }
+
+    private:
+        struct alignas(SIMD_ALIGNMENT) Chunk {
+            RngStream rng;
+        };
+
+        auto simulate_chunk(const std::size_t chunk) -> void {
+            const auto begin = chunk * CHUNK_SIZE;
+            const auto end = std::min(begin + CHUNK_SIZE, field.padded_count());
+            simulate(field, begin, end, simulation_params, current_step, chunks[chunk].rng, simulation_backend);
+
+            auto &back = snapshots[1 - front];
+            std::memcpy(&back.x[begin], &field.x[begin], (end - begin) * sizeof(float));
+            std::memcpy(&back.y[begin], &field.y[begin], (end - begin) * sizeof(float));
+        }
+
+        app_runtime::JobSystem &jobs;
+        SimulationParams simulation_params;
+        Backend simulation_backend;
+        SnowField field{};
+        std::vector<Chunk> chunks{};
+        SnowSnapshot snapshots[2]{};
+        std::size_t front = 0;
+        StepParams current_step{};
+        bool in_flight = false;
+    };
+} // namespace points
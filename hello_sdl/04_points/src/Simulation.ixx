@@ -0,0 +1,469 @@
+module;
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define POINTS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && not defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC / Clang 需要给使用 AVX2 / SSE4.1 指令的函数单独打开目标特性，MSVC 不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define POINTS_TARGET(features) __attribute__((target(features)))
+#else
+#define POINTS_TARGET(features)
+#endif
+
+export module Points.Simulation;
+
+export namespace points {
+    /// 每个 SIMD 批次处理的粒子数（AVX2 一个寄存器 8 个 float），粒子数组按它补齐
+    constexpr std::size_t SIMD_LANES = 8;
+    /// 数组按缓存行对齐，同时满足 AVX2 对齐加载的要求
+    constexpr std::size_t SIMD_ALIGNMENT = 64;
+
+    template<typename T>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        AlignedAllocator() = default;
+        template<typename U>
+        explicit AlignedAllocator(const AlignedAllocator<U> &) {}
+
+        auto allocate(const std::size_t count) -> T * {
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{SIMD_ALIGNMENT}));
+        }
+
+        auto deallocate(T *pointer, std::size_t) -> void {
+            ::operator delete(pointer, std::align_val_t{SIMD_ALIGNMENT});
+        }
+
+        template<typename U>
+        auto operator==(const AlignedAllocator<U> &) const -> bool {
+            return true;
+        }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    /**
+     * 雪花粒子的 SoA 存储，每个数组长度都补齐到 SIMD_LANES 的倍数
+     * 补齐出来的粒子照常参与模拟，但不参与绘制
+     */
+    struct SnowField {
+        AlignedVector<float> x;
+        AlignedVector<float> y;
+        AlignedVector<float> speed;
+        AlignedVector<float> phase;
+        AlignedVector<float> amplitude;
+        AlignedVector<float> size;
+        AlignedVector<std::uint8_t> alpha;
+        std::size_t count = 0;
+
+        auto resize(const std::size_t particle_count) -> void {
+            count = particle_count;
+            const auto padded = padded_count();
+            x.resize(padded);
+            y.resize(padded);
+            speed.resize(padded);
+            phase.resize(padded);
+            amplitude.resize(padded);
+            size.resize(padded);
+            alpha.resize(padded);
+        }
+
+        [[nodiscard]] auto padded_count() const -> std::size_t {
+            return (count + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;
+        }
+    };
+
+    /// 整个模拟过程中不变的参数
+    struct SimulationParams {
+        float width = 0.0f;
+        float height = 0.0f;
+        float min_speed = 20.0f;
+        float max_speed = 120.0f;
+    };
+
+    /// 每一步的参数：时间步长和已经合成好的水平风速（风速 * 风向）
+    struct StepParams {
+        float dt = 0.0f;
+        float wind_dx = 0.0f;
+    };
+
+    /**
+     * 每个 SIMD 通道一个 xorshift32 状态，SIMD 和标量实现按同样的通道顺序消费随机数，
+     * 所以同一个种子、同一种后端得到的结果完全一致
+     */
+    struct alignas(32) RngStream {
+        std::array<std::uint32_t, SIMD_LANES> lanes{};
+
+        /// 用 splitmix64 把 (seed, stream) 展开成各通道的初始状态，不同 stream 互不相关
+        static auto from_seed(const std::uint64_t seed, const std::uint64_t stream = 0) -> RngStream {
+            RngStream rng;
+            auto state = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+            for (auto &lane: rng.lanes) {
+                state += 0x9E3779B97F4A7C15ULL;
+                auto z = state;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                z ^= z >> 31;
+                lane = static_cast<std::uint32_t>(z) | 1u; // xorshift 的状态不能为 0
+            }
+            return rng;
+        }
+
+        /// [0, 1) 均匀分布
+        auto next_float(const std::size_t lane) -> float {
+            auto s = lanes[lane];
+            s ^= s << 13;
+            s ^= s >> 17;
+            s ^= s << 5;
+            lanes[lane] = s;
+            return static_cast<float>(s >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    enum class Backend {
+        Scalar,
+        Sse41,
+        Avx2,
+    };
+
+    auto backend_name(const Backend backend) -> std::string_view {
+        switch (backend) {
+            case Backend::Avx2:
+                return "AVX2";
+            case Backend::Sse41:
+                return "SSE4.1";
+            case Backend::Scalar:
+            default:
+                return "scalar";
+        }
+    }
+
+    auto is_backend_supported(Backend backend) -> bool;
+    auto best_backend() -> Backend;
+    auto available_backends() -> std::vector<Backend>;
+
+    /**
+     * 用随机数初始化 particle_count 个粒子（包括补齐部分）
+     */
+    auto seed_field(SnowField &field, std::size_t particle_count, const SimulationParams &params, RngStream &rng)
+            -> void;
+
+    /**
+     * 推进 [begin, end) 范围内的粒子一步：下落、风、正弦摆动，飞出屏幕的粒子用掩码选择重新生成
+     * begin / end 必须是 SIMD_LANES 的倍数
+     */
+    auto simulate(SnowField &field, std::size_t begin, std::size_t end, const SimulationParams &params,
+                  const StepParams &step, RngStream &rng, Backend backend = best_backend()) -> void;
+} // namespace points
+
+namespace points {
+    constexpr float PI = 3.14159265358979f;
+    constexpr float TWO_PI = 6.28318530717959f;
+    constexpr float INV_TWO_PI = 1.0f / TWO_PI;
+    constexpr float RESPAWN_PHASE_RANGE = 6.28f;
+    constexpr float RESPAWN_Y = -20.0f;
+    constexpr float OFFSCREEN_MARGIN = 50.0f;
+    constexpr float SWING_SPEED = 2.0f;
+
+    // 抛物线近似 sin(x)，x ∈ [-π, π)，再做一次加权修正，最大误差约 0.001
+    constexpr float SINE_B = 4.0f / PI;
+    constexpr float SINE_C = -4.0f / (PI * PI);
+    constexpr float SINE_P = 0.225f;
+
+    auto fast_sine(const float x) -> float {
+        auto y = SINE_B * x + SINE_C * x * std::fabs(x);
+        y = SINE_P * (y * std::fabs(y) - y) + y;
+        return y;
+    }
+
+    auto wrap_phase(const float phase) -> float {
+        return phase - TWO_PI * std::floor((phase + PI) * INV_TWO_PI);
+    }
+
+    auto cpu_supports(const Backend backend) -> bool {
+#if defined(POINTS_X86)
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        switch (backend) {
+            case Backend::Avx2:
+                return __builtin_cpu_supports("avx2");
+            case Backend::Sse41:
+                return __builtin_cpu_supports("sse4.1");
+            default:
+                return true;
+        }
+#else
+        int info[4]{};
+        __cpuid(info, 1);
+        const bool sse41 = (info[2] & (1 << 19)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        const bool avx2 = osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        switch (backend) {
+            case Backend::Avx2:
+                return avx2;
+            case Backend::Sse41:
+                return sse41;
+            default:
+                return true;
+        }
+#endif
+#else
+        return backend == Backend::Scalar;
+#endif
+    }
+
+    auto is_backend_supported(const Backend backend) -> bool {
+        static const bool sse41 = cpu_supports(Backend::Sse41);
+        static const bool avx2 = cpu_supports(Backend::Avx2);
+        switch (backend) {
+            case Backend::Avx2:
+                return avx2;
+            case Backend::Sse41:
+                return sse41;
+            default:
+                return true;
+        }
+    }
+
+    auto best_backend() -> Backend {
+        if (is_backend_supported(Backend::Avx2)) {
+            return Backend::Avx2;
+        }
+        if (is_backend_supported(Backend::Sse41)) {
+            return Backend::Sse41;
+        }
+        return Backend::Scalar;
+    }
+
+    auto available_backends() -> std::vector<Backend> {
+        std::vector<Backend> backends{Backend::Scalar};
+        for (const auto backend: {Backend::Sse41, Backend::Avx2}) {
+            if (is_backend_supported(backend)) {
+                backends.push_back(backend);
+            }
+        }
+        return backends;
+    }
+
+    auto seed_field(SnowField &field, const std::size_t particle_count, const SimulationParams &params,
+                    RngStream &rng) -> void {
+        field.resize(particle_count);
+        for (std::size_t i = 0; i < field.padded_count(); ++i) {
+            const auto lane = i % SIMD_LANES;
+            field.x[i] = rng.next_float(lane) * params.width;
+            field.y[i] = rng.next_float(lane) * params.height;
+            field.speed[i] = params.min_speed + rng.next_float(lane) * (params.max_speed - params.min_speed);
+
+            // 不同大小的雪花 (1.0 到 4.0)，大的雪花更不透明（更近），小的更透明（更远）
+            field.size[i] = 1.0f + rng.next_float(lane) * 3.0f;
+            field.alpha[i] = static_cast<std::uint8_t>(150 + (field.size[i] / 4.0f) * 105);
+
+            field.phase[i] = rng.next_float(lane) * RESPAWN_PHASE_RANGE;
+            // 摆动幅度与大小相关，小雪花摆动更明显
+            field.amplitude[i] = (5.0f - field.size[i]) * 8.0f;
+        }
+    }
+
+    auto simulate_scalar(SnowField &field, const std::size_t begin, const std::size_t end,
+                         const SimulationParams &params, const StepParams &step, RngStream &rng) -> void {
+        const auto wind_step = step.dt * step.wind_dx;
+        const auto phase_step = step.dt * SWING_SPEED;
+        const auto speed_range = params.max_speed - params.min_speed;
+
+        for (auto i = begin; i < end; ++i) {
+            const auto lane = i % SIMD_LANES;
+            auto x = field.x[i] + wind_step;
+            auto y = field.y[i] + step.dt * field.speed[i];
+            auto phase = wrap_phase(field.phase[i] + phase_step);
+            x += fast_sine(phase) * field.amplitude[i] * step.dt;
+
+            // 与 SIMD 版本一样，无论是否重新生成都消耗三个随机数
+            const auto r_x = rng.next_float(lane);
+            const auto r_speed = rng.next_float(lane);
+            const auto r_phase = rng.next_float(lane);
+            if (y > params.height || x < -OFFSCREEN_MARGIN || x > params.width + OFFSCREEN_MARGIN) {
+                x = r_x * params.width;
+                y = RESPAWN_Y;
+                field.speed[i] = params.min_speed + r_speed * speed_range;
+                phase = r_phase * RESPAWN_PHASE_RANGE;
+            }
+
+            field.x[i] = x;
+            field.y[i] = y;
+            field.phase[i] = phase;
+        }
+    }
+
+#if defined(POINTS_X86)
+    /// 4 个通道同时推进一次 xorshift32，与 RngStream::next_float 的结果逐位相同
+    POINTS_TARGET("sse4.1")
+    inline auto next_float_sse41(__m128i &state, const __m128 to_unit) -> __m128 {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state, 8)), to_unit);
+    }
+
+    POINTS_TARGET("avx2")
+    inline auto next_float_avx2(__m256i &state, const __m256 to_unit) -> __m256 {
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+        state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(state, 8)), to_unit);
+    }
+
+    POINTS_TARGET("sse4.1")
+    auto simulate_sse41(SnowField &field, const std::size_t begin, const std::size_t end,
+                        const SimulationParams &params, const StepParams &step, RngStream &rng) -> void {
+        const auto dt = _mm_set1_ps(step.dt);
+        const auto wind_step = _mm_set1_ps(step.dt * step.wind_dx);
+        const auto phase_step = _mm_set1_ps(step.dt * SWING_SPEED);
+        const auto pi = _mm_set1_ps(PI);
+        const auto two_pi = _mm_set1_ps(TWO_PI);
+        const auto inv_two_pi = _mm_set1_ps(INV_TWO_PI);
+        const auto sine_b = _mm_set1_ps(SINE_B);
+        const auto sine_c = _mm_set1_ps(SINE_C);
+        const auto sine_p = _mm_set1_ps(SINE_P);
+        const auto sign_mask = _mm_set1_ps(-0.0f);
+        const auto height = _mm_set1_ps(params.height);
+        const auto left_edge = _mm_set1_ps(-OFFSCREEN_MARGIN);
+        const auto right_edge = _mm_set1_ps(params.width + OFFSCREEN_MARGIN);
+        const auto width = _mm_set1_ps(params.width);
+        const auto respawn_y = _mm_set1_ps(RESPAWN_Y);
+        const auto min_speed = _mm_set1_ps(params.min_speed);
+        const auto speed_range = _mm_set1_ps(params.max_speed - params.min_speed);
+        const auto phase_range = _mm_set1_ps(RESPAWN_PHASE_RANGE);
+        const auto to_unit = _mm_set1_ps(1.0f / 16777216.0f);
+
+        // 8 个通道的随机数状态拆成前后两半，分别对应每个批次的前 4 个和后 4 个粒子
+        __m128i states[2] = {
+                _mm_load_si128(reinterpret_cast<const __m128i *>(rng.lanes.data())),
+                _mm_load_si128(reinterpret_cast<const __m128i *>(rng.lanes.data() + 4)),
+        };
+
+        for (auto i = begin; i < end; i += 4) {
+            auto &state = states[(i / 4) % 2];
+            auto x = _mm_add_ps(_mm_load_ps(&field.x[i]), wind_step);
+            auto y = _mm_add_ps(_mm_load_ps(&field.y[i]), _mm_mul_ps(dt, _mm_load_ps(&field.speed[i])));
+            auto phase = _mm_add_ps(_mm_load_ps(&field.phase[i]), phase_step);
+            phase = _mm_sub_ps(phase, _mm_mul_ps(two_pi, _mm_floor_ps(_mm_mul_ps(_mm_add_ps(phase, pi), inv_two_pi))));
+
+            auto sine = _mm_add_ps(_mm_mul_ps(sine_b, phase),
+                                   _mm_mul_ps(_mm_mul_ps(sine_c, phase), _mm_andnot_ps(sign_mask, phase)));
+            sine = _mm_add_ps(
+                    _mm_mul_ps(sine_p, _mm_sub_ps(_mm_mul_ps(sine, _mm_andnot_ps(sign_mask, sine)), sine)), sine);
+            x = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(sine, _mm_load_ps(&field.amplitude[i])), dt));
+
+            const auto r_x = next_float_sse41(state, to_unit);
+            const auto r_speed = next_float_sse41(state, to_unit);
+            const auto r_phase = next_float_sse41(state, to_unit);
+            const auto respawn = _mm_or_ps(_mm_cmpgt_ps(y, height),
+                                           _mm_or_ps(_mm_cmplt_ps(x, left_edge), _mm_cmpgt_ps(x, right_edge)));
+
+            x = _mm_blendv_ps(x, _mm_mul_ps(r_x, width), respawn);
+            y = _mm_blendv_ps(y, respawn_y, respawn);
+            const auto speed = _mm_blendv_ps(_mm_load_ps(&field.speed[i]),
+                                             _mm_add_ps(min_speed, _mm_mul_ps(r_speed, speed_range)), respawn);
+            phase = _mm_blendv_ps(phase, _mm_mul_ps(r_phase, phase_range), respawn);
+
+            _mm_store_ps(&field.x[i], x);
+            _mm_store_ps(&field.y[i], y);
+            _mm_store_ps(&field.speed[i], speed);
+            _mm_store_ps(&field.phase[i], phase);
+        }
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(rng.lanes.data()), states[0]);
+        _mm_store_si128(reinterpret_cast<__m128i *>(rng.lanes.data() + 4), states[1]);
+    }
+
+    POINTS_TARGET("avx2")
+    auto simulate_avx2(SnowField &field, const std::size_t begin, const std::size_t end,
+                       const SimulationParams &params, const StepParams &step, RngStream &rng) -> void {
+        const auto dt = _mm256_set1_ps(step.dt);
+        const auto wind_step = _mm256_set1_ps(step.dt * step.wind_dx);
+        const auto phase_step = _mm256_set1_ps(step.dt * SWING_SPEED);
+        const auto pi = _mm256_set1_ps(PI);
+        const auto two_pi = _mm256_set1_ps(TWO_PI);
+        const auto inv_two_pi = _mm256_set1_ps(INV_TWO_PI);
+        const auto sine_b = _mm256_set1_ps(SINE_B);
+        const auto sine_c = _mm256_set1_ps(SINE_C);
+        const auto sine_p = _mm256_set1_ps(SINE_P);
+        const auto sign_mask = _mm256_set1_ps(-0.0f);
+        const auto height = _mm256_set1_ps(params.height);
+        const auto left_edge = _mm256_set1_ps(-OFFSCREEN_MARGIN);
+        const auto right_edge = _mm256_set1_ps(params.width + OFFSCREEN_MARGIN);
+        const auto width = _mm256_set1_ps(params.width);
+        const auto respawn_y = _mm256_set1_ps(RESPAWN_Y);
+        const auto min_speed = _mm256_set1_ps(params.min_speed);
+        const auto speed_range = _mm256_set1_ps(params.max_speed - params.min_speed);
+        const auto phase_range = _mm256_set1_ps(RESPAWN_PHASE_RANGE);
+        const auto to_unit = _mm256_set1_ps(1.0f / 16777216.0f);
+
+        auto state = _mm256_load_si256(reinterpret_cast<const __m256i *>(rng.lanes.data()));
+
+        for (auto i = begin; i < end; i += SIMD_LANES) {
+            auto x = _mm256_add_ps(_mm256_load_ps(&field.x[i]), wind_step);
+            auto y = _mm256_add_ps(_mm256_load_ps(&field.y[i]), _mm256_mul_ps(dt, _mm256_load_ps(&field.speed[i])));
+            auto phase = _mm256_add_ps(_mm256_load_ps(&field.phase[i]), phase_step);
+            phase = _mm256_sub_ps(
+                    phase, _mm256_mul_ps(two_pi, _mm256_floor_ps(_mm256_mul_ps(_mm256_add_ps(phase, pi), inv_two_pi))));
+
+            auto sine = _mm256_add_ps(_mm256_mul_ps(sine_b, phase),
+                                      _mm256_mul_ps(_mm256_mul_ps(sine_c, phase), _mm256_andnot_ps(sign_mask, phase)));
+            sine = _mm256_add_ps(
+                    _mm256_mul_ps(sine_p, _mm256_sub_ps(_mm256_mul_ps(sine, _mm256_andnot_ps(sign_mask, sine)), sine)),
+                    sine);
+            x = _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(sine, _mm256_load_ps(&field.amplitude[i])), dt));
+
+            const auto r_x = next_float_avx2(state, to_unit);
+            const auto r_speed = next_float_avx2(state, to_unit);
+            const auto r_phase = next_float_avx2(state, to_unit);
+            const auto respawn = _mm256_or_ps(
+                    _mm256_cmp_ps(y, height, _CMP_GT_OQ),
+                    _mm256_or_ps(_mm256_cmp_ps(x, left_edge, _CMP_LT_OQ), _mm256_cmp_ps(x, right_edge, _CMP_GT_OQ)));
+
+            x = _mm256_blendv_ps(x, _mm256_mul_ps(r_x, width), respawn);
+            y = _mm256_blendv_ps(y, respawn_y, respawn);
+            const auto speed = _mm256_blendv_ps(_mm256_load_ps(&field.speed[i]),
+                                                _mm256_add_ps(min_speed, _mm256_mul_ps(r_speed, speed_range)), respawn);
+            phase = _mm256_blendv_ps(phase, _mm256_mul_ps(r_phase, phase_range), respawn);
+
+            _mm256_store_ps(&field.x[i], x);
+            _mm256_store_ps(&field.y[i], y);
+            _mm256_store_ps(&field.speed[i], speed);
+            _mm256_store_ps(&field.phase[i], phase);
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(rng.lanes.data()), state);
+    }
+#endif
+
+    auto simulate(SnowField &field, const std::size_t begin, const std::size_t end, const SimulationParams &params,
+                  const StepParams &step, RngStream &rng, const Backend backend) -> void {
+#if defined(POINTS_X86)
+        if (backend == Backend::Avx2 && is_backend_supported(Backend::Avx2)) {
+            simulate_avx2(field, begin, end, params, step, rng);
+            return;
+        }
+        if (backend == Backend::Sse41 && is_backend_supported(Backend::Sse41)) {
+            simulate_sse41(field, begin, end, params, step, rng);
+            return;
+        }
+#endif
+        simulate_scalar(field, begin, end, params, step, rng);
+    }
+} // namespace points
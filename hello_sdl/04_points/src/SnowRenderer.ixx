@@ -0,0 +1,146 @@
+module;
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+export module Points.SnowRenderer;
+
+import app_runtime.render_stats;
+
+export class SnowRenderer {
+public:
+    /// 图集中的圆盘半径 0 ~ MAX_RADIUS，半径 0 就是单个像素
+    static constexpr int MAX_RADIUS = 4;
+
+    explicit SnowRenderer(SDL_Renderer *target);
+    ~SnowRenderer();
+
+    SnowRenderer(const SnowRenderer &) = delete;
+    auto operator=(const SnowRenderer &) -> SnowRenderer & = delete;
+
+    /// 开始新的一帧，预留 flake_count 个雪花的顶点
+    auto begin(std::size_t flake_count) -> void;
+
+    /**
+     * 追加一个雪花：以 (x, y) 为中心、半径为 radius 的实心圆，透明度写在顶点颜色里
+     * 只往顶点数组里写数据，不调用任何 SDL 渲染函数
+     */
+    auto add(float x, float y, int radius, Uint8 alpha) -> void {
+        const auto &sprite = sprites[radius];
+        const auto left = x - static_cast<float>(radius);
+        const auto top = y - static_cast<float>(radius);
+        const auto extent = static_cast<float>(radius * 2 + 1);
+        const SDL_FColor color{1.0f, 1.0f, 1.0f, static_cast<float>(alpha) / 255.0f};
+
+        vertices.push_back({{left, top}, color, {sprite.u0, sprite.v0}});
+        vertices.push_back({{left + extent, top}, color, {sprite.u1, sprite.v0}});
+        vertices.push_back({{left + extent, top + extent}, color, {sprite.u1, sprite.v1}});
+        vertices.push_back({{left, top + extent}, color, {sprite.u0, sprite.v1}});
+    }
+
+    /// 把本帧所有雪花作为一个批次提交
+    auto submit() -> void;
+
+    /// 雪花大小（1.0 ~ 4.0）到图集半径的映射，与原先逐点绘制时的规则一致
+    static auto radius_for_size(const float size) -> int {
+        return size <= 1.5f ? 0 : SDL_min(static_cast<int>(size), MAX_RADIUS);
+    }
+
+private:
+    struct Sprite {
+        float u0, v0, u1, v1;
+    };
+
+    SDL_Renderer *renderer = nullptr;
+    SDL_Texture *atlas = nullptr;
+    std::array<Sprite, MAX_RADIUS + 1> sprites{};
+    std::vector<SDL_Vertex> vertices{};
+    // 每个四边形的 6 个索引是固定的，只在容量增长时重建
+    std::vector<int> indices{};
+
+    auto build_atlas() -> void;
+    auto ensure_indices(std::size_t quad_count) -> void;
+};
+
+SnowRenderer::SnowRenderer(SDL_Renderer *target) : renderer(target) { build_atlas(); }
+
+SnowRenderer::~SnowRenderer() {
+    if (atlas) {
+        SDL_DestroyTexture(atlas);
+        atlas = nullptr;
+    }
+}
+
+/**
+ * 预先光栅化半径 0 ~ MAX_RADIUS 的白色圆盘，水平排成一行：
+ * 每个圆盘占 (2r + 1) x (2r + 1)，圆外像素 alpha 为 0
+ */
+auto SnowRenderer::build_atlas() -> void {
+    int atlas_width = 0;
+    for (int radius = 0; radius <= MAX_RADIUS; ++radius) {
+        atlas_width += radius * 2 + 1;
+    }
+    constexpr int atlas_height = MAX_RADIUS * 2 + 1;
+
+    std::vector<Uint32> pixels(static_cast<std::size_t>(atlas_width * atlas_height), 0);
+    int origin_x = 0;
+    for (int radius = 0; radius <= MAX_RADIUS; ++radius) {
+        const auto extent = radius * 2 + 1;
+        for (int dy = -radius; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                if (dx * dx + dy * dy <= radius * radius) {
+                    pixels[static_cast<std::size_t>((dy + radius) * atlas_width + origin_x + dx + radius)] =
+                            0xFFFFFFFF;
+                }
+            }
+        }
+        sprites[radius] = {
+                static_cast<float>(origin_x) / static_cast<float>(atlas_width),
+                0.0f,
+                static_cast<float>(origin_x + extent) / static_cast<float>(atlas_width),
+                static_cast<float>(extent) / static_cast<float>(atlas_height),
+        };
+        origin_x += extent;
+    }
+
+    atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, atlas_width,
+                              atlas_height);
+    if (atlas == nullptr) {
+        const auto result = std::format("Couldn't create snow atlas: {}", SDL_GetError());
+        SDL_Log(result.data());
+        throw std::runtime_error(result);
+    }
+    SDL_UpdateTexture(atlas, nullptr, pixels.data(), atlas_width * static_cast<int>(sizeof(Uint32)));
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(atlas, SDL_SCALEMODE_NEAREST);
+}
+
+auto SnowRenderer::ensure_indices(const std::size_t quad_count) -> void {
+    const auto existing = indices.size() / 6;
+    if (existing >= quad_count) {
+        return;
+    }
+    indices.reserve(quad_count * 6);
+    for (auto quad = existing; quad < quad_count; ++quad) {
+        const auto base = static_cast<int>(quad * 4);
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+}
+
+auto SnowRenderer::begin(const std::size_t flake_count) -> void {
+    vertices.clear();
+    vertices.reserve(flake_count * 4);
+}
+
+auto SnowRenderer::submit() -> void {
+    const auto quad_count = vertices.size() / 4;
+    if (quad_count == 0) {
+        return;
+    }
+    ensure_indices(quad_count);
+    app_runtime::render_geometry(renderer, atlas, vertices.data(), static_cast<int>(vertices.size()), indices.data(),
+                                 static_cast<int>(quad_count * 6));
+}
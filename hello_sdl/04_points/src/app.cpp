@@ -2,12 +2,37 @@
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
+#include <cstdint>
 #include <memory>
+#include <string_view>
 
+import app_runtime.jobs;
 import Points.Application;
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
-    auto application = std::make_unique<Application>("some points", 1366, 768);
+    // --flakes N：雪花数量；--software：强制使用 SDL 的软件渲染器，用来测量最坏情况下的帧时间
+    // --threads N：模拟用的工作线程数（0 表示只用主线程）；--seed N：固定随机种子，便于复现
+    int flake_count = Application::DEFAULT_NUM_POINTS;
+    unsigned int worker_count = app_runtime::JobSystem::default_worker_count();
+    std::uint64_t seed = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument{argv[i]};
+        if (argument == "--flakes" && i + 1 < argc) {
+            flake_count = SDL_max(SDL_atoi(argv[++i]), 1);
+        }
+        else if (argument == "--threads" && i + 1 < argc) {
+            worker_count = static_cast<unsigned int>(SDL_max(SDL_atoi(argv[++i]), 0));
+        }
+        else if (argument == "--seed" && i + 1 < argc) {
+            seed = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--software") {
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        }
+    }
+
+    SDL_SetAppMetadata("Example Renderer Points", "1.0", "com.claude-rainer.renderer-points");
+    auto application = std::make_unique<Application>("some points", 1366, 768, flake_count, worker_count, seed);
 
     if (not application) {
         SDL_Log("Failed to create Application instance!");
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+import app_runtime.jobs;
+import Points.ParallelSimulation;
+import Points.Simulation;
+
+namespace {
+    constexpr double MIN_SECONDS = 0.5;
+    constexpr int MIN_STEPS = 5;
+    constexpr int WARMUP_STEPS = 3;
+
+    struct Result {
+        double particles_per_second;
+        double ns_per_step;
+        double checksum;
+    };
+
+    /**
+     * 不打开窗口，只跑模拟内核：每种规模至少跑 MIN_SECONDS 秒，
+     * checksum 只用来防止编译器把结果优化掉（步数由时间决定，不同后端的 checksum 不可比较）
+     */
+    auto run(const std::size_t particle_count, const points::Backend backend) -> Result {
+        const points::SimulationParams params{.width = 1366.0f, .height = 768.0f};
+        auto rng = points::RngStream::from_seed(42);
+        points::SnowField field;
+        points::seed_field(field, particle_count, params, rng);
+
+        const points::StepParams step{.dt = 1.0f / 60.0f, .wind_dx = 25.0f};
+        for (int i = 0; i < WARMUP_STEPS; ++i) {
+            points::simulate(field, 0, field.padded_count(), params, step, rng, backend);
+        }
+
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        int steps = 0;
+        double elapsed = 0.0;
+        while (steps < MIN_STEPS || elapsed < MIN_SECONDS) {
+            points::simulate(field, 0, field.padded_count(), params, step, rng, backend);
+            ++steps;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        double checksum = 0.0;
+        for (std::size_t i = 0; i < field.count; ++i) {
+            checksum += field.x[i] + field.y[i];
+        }
+        return {
+                .particles_per_second = static_cast<double>(particle_count) * steps / elapsed,
+                .ns_per_step = elapsed * 1e9 / steps,
+                .checksum = checksum,
+        };
+    }
+
+    /// 用 thread_count 个线程（含调用线程）跑分块并行模拟，后端固定为当前 CPU 最快的一种
+    auto run_parallel(const std::size_t particle_count, const unsigned int thread_count) -> Result {
+        const points::SimulationParams params{.width = 1366.0f, .height = 768.0f};
+        app_runtime::JobSystem jobs{thread_count - 1};
+        points::ParallelSimulation simulation{jobs, particle_count, params, 42};
+
+        const points::StepParams step{.dt = 1.0f / 60.0f, .wind_dx = 25.0f};
+        for (int i = 0; i < WARMUP_STEPS; ++i) {
+            simulation.step(step);
+        }
+
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        int steps = 0;
+        double elapsed = 0.0;
+        while (steps < MIN_STEPS || elapsed < MIN_SECONDS) {
+            simulation.step(step);
+            ++steps;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        double checksum = 0.0;
+        const auto &snapshot = simulation.get_snapshot();
+        for (std::size_t i = 0; i < particle_count; ++i) {
+            checksum += snapshot.x[i] + snapshot.y[i];
+        }
+        return {
+                .particles_per_second = static_cast<double>(particle_count) * steps / elapsed,
+                .ns_per_step = elapsed * 1e9 / steps,
+                .checksum = checksum,
+        };
+    }
+} // namespace
+
+auto main(const int argc, char **argv) -> int {
+    // 可选参数：最大粒子数，默认跑 1e4 ~ 1e7
+    const std::size_t max_particles = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+    std::printf("%-10s %-8s %16s %14s %18s\n", "particles", "backend", "particles/sec", "ms/step", "checksum");
+    for (std::size_t count = 10'000; count <= max_particles; count *= 10) {
+        for (const auto backend: points::available_backends()) {
+            const auto result = run(count, backend);
+            std::printf("%-10zu %-8s %16.3e %14.3f %18.3f\n", count, points::backend_name(backend).data(),
+                        result.particles_per_second, result.ns_per_step / 1e6, result.checksum);
+        }
+    }
+
+    // 多线程扩展性：线程数按 2 的幂增加到硬件线程数
+    const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int threads = 1; threads < hardware_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(hardware_threads);
+
+    std::printf("\n%-10s %-8s %16s %14s %9s\n", "particles", "threads", "particles/sec", "ms/step", "speedup");
+    for (std::size_t count = 10'000; count <= max_particles; count *= 10) {
+        double single_thread_ns = 0.0;
+        for (const auto threads: thread_counts) {
+            const auto result = run_parallel(count, threads);
+            if (threads == 1) {
+                single_thread_ns = result.ns_per_step;
+            }
+            std::printf("%-10zu %-8u %16.3e %14.3f %8.2fx\n", count, threads, result.particles_per_second,
+                        result.ns_per_step / 1e6, single_thread_ns / result.ns_per_step);
+        }
+    }
+    return 0;
+}
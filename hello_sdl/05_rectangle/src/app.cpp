@@ -7,6 +7,7 @@
 import SomeRectangle.Application;
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
+    SDL_SetAppMetadata("Example Renderer Rectangle", "1.0", "com.claude-rainer.renderer-rectangle");
     auto apple = std::make_unique<Application>("Some Rectangle", 800, 600);
     if (not apple) {
         SDL_Log("Failed to create Application instance!");
@@ -18,18 +19,12 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
 
 SDL_AppResult SDL_AppEvent(void *app_state, SDL_Event *event) {
     auto *application = static_cast<Application *>(app_state);
-    const auto result = application->handle_event(event);
-    if (result != SDL_APP_CONTINUE) {
-        return result;
-    }
-    application->handle_event(event);
-    return SDL_APP_CONTINUE;
+    return application->handle_event(event);
 }
 
 SDL_AppResult SDL_AppIterate(void *app_state) {
     auto *application = static_cast<Application *>(app_state);
-    application->update();
-    return SDL_APP_CONTINUE;
+    return application->update();
 }
 
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
@@ -7,6 +7,8 @@ module;
 
 export module texture06.application;
 
+import app_runtime;
+
 export class Application {
 public:
     explicit Application(std::string_view title, int width, int height);
@@ -19,28 +21,19 @@ private:
     const int window_width = 800;
     const int window_height = 600;
 
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
+    // 窗口和渲染器由 runtime 创建和销毁
+    app_runtime::Runtime runtime;
     SDL_Texture *texture = nullptr;
 
     int texture_width = 0;
     int texture_height = 0;
+
+    void draw(SDL_Renderer *renderer);
 };
 
 Application::Application(const std::string_view title, const int width, const int height) :
-    window_title(title), window_width(width), window_height(height) {
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        SDL_Log("Could not initialize SDL: %s", SDL_GetError());
-        throw std::runtime_error("Could not initialize SDL");
-    }
-    if (not SDL_CreateWindowAndRenderer(window_title.data(), window_width, window_height, SDL_WINDOW_RESIZABLE, &window,
-                                        &renderer)) {
-        SDL_Log("Could not create window and renderer: %s", SDL_GetError());
-        throw std::runtime_error("Could not create window and renderer");
-    }
-
-    SDL_SetRenderLogicalPresentation(renderer, window_width, window_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-
+    window_title(title), window_width(width), window_height(height),
+    runtime({.title = title, .width = width, .height = height}) {
     const std::string texture_path = "./res/sample.png";
     SDL_Surface* surface = IMG_Load(texture_path.c_str());
     if (!surface) {
@@ -48,7 +41,7 @@ Application::Application(const std::string_view title, const int width, const in
         return;
     }
 
-    texture = SDL_CreateTextureFromSurface(renderer, surface);
+    texture = SDL_CreateTextureFromSurface(runtime.get_renderer(), surface);
     if (!texture) {
         SDL_Log("Could not create texture: %s", SDL_GetError());
         SDL_DestroySurface(surface);
@@ -61,23 +54,27 @@ Application::Application(const std::string_view title, const int width, const in
 }
 
 Application::~Application() {
-    if (renderer)
-        SDL_DestroyRenderer(renderer);
-    if (window)
-        SDL_DestroyWindow(window);
+    // 纹理要在 runtime 销毁渲染器之前销毁
     if (texture)
         SDL_DestroyTexture(texture);
-    SDL_Quit();
 }
 
 SDL_AppResult Application::handle_event(SDL_Event *event) {
     if (event->type == SDL_EVENT_QUIT) {
         return SDL_APP_SUCCESS;
     }
+    runtime.handle_event(event);
     return SDL_APP_CONTINUE;
 }
 
 SDL_AppResult Application::handle_iteration() {
+    return runtime.iterate([this] {
+        draw(runtime.get_renderer());
+        return SDL_APP_CONTINUE;
+    });
+}
+
+void Application::draw(SDL_Renderer *renderer) {
     // SDL3: SDL_GetTicks returns Uint64 milliseconds
     const double now = static_cast<double>(SDL_GetTicks()) / 1000.0;
 
@@ -87,9 +84,9 @@ SDL_AppResult Application::handle_iteration() {
     const auto blue = static_cast<float>(0.5 + 0.5 * SDL_sin(now + SDL_PI_D * 4.0 / 3.0));
 
     // SDL3: Use SetRenderDrawColorFloat (0.0~1.0 range)
-    SDL_SetRenderDrawColorFloat(renderer, red, green, blue, SDL_ALPHA_OPAQUE_FLOAT);
+    app_runtime::set_draw_color_float(renderer, red, green, blue, SDL_ALPHA_OPAQUE_FLOAT);
 
-    SDL_RenderClear(renderer);
+    app_runtime::clear(renderer);
 
     const auto ticks = SDL_GetTicks();
     const auto direction = ((ticks % 2000) >= 1000) ? 1.0f : -1.0f;
@@ -102,23 +99,21 @@ SDL_AppResult Application::handle_iteration() {
     rect.y = 0.0f;
     rect.w = static_cast<float>(texture_width);
     rect.h = static_cast<float>(texture_height);
-    SDL_RenderTexture(renderer, texture, nullptr, &rect);
+    app_runtime::render_texture(renderer, texture, nullptr, &rect);
 
     /* bottom right */
     rect.x = static_cast<float>(window_width - texture_width) - (100.0f * scale);
     rect.y = static_cast<float>(window_height - texture_height);
     rect.w = static_cast<float>(texture_width);
     rect.h = static_cast<float>(texture_height);
-    SDL_RenderTexture(renderer, texture, nullptr, &rect);
+    app_runtime::render_texture(renderer, texture, nullptr, &rect);
 
     /* center this one. */
     rect.x = (window_width - texture_width) / 2.0f;
     rect.y = (window_height - texture_height) / 2.0f;
     rect.w = static_cast<float>(texture_width) * static_cast<float>(scale);
     rect.h = static_cast<float>(texture_height) * static_cast<float>(scale);
-    SDL_RenderTexture(renderer, texture, nullptr, &rect);
+    app_runtime::render_texture(renderer, texture, nullptr, &rect);
 
-    SDL_RenderPresent(renderer);
-
-    return SDL_APP_CONTINUE;
+    runtime.present();
 }
@@ -6,6 +6,8 @@ module;
 
 export module streaming_texture.application;
 
+import app_runtime;
+
 
 export class Application {
 public:
@@ -19,30 +21,22 @@ private:
     const std::string_view window_title;
     const int window_width;
     const int window_height;
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
+    // 窗口和渲染器由 runtime 创建和销毁
+    app_runtime::Runtime runtime;
     SDL_Texture *texture = nullptr;
 
     SDL_Texture *img = nullptr;
     int img_width = 0;
     int img_height = 0;
+
+    void draw(SDL_Renderer *renderer);
 };
 
 
 Application::Application(std::string_view title, int width, int height) :
-    window_title{title}, window_width{width}, window_height{height} {
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        SDL_Log("Could not initialize SDL: %s", SDL_GetError());
-        throw std::runtime_error("Could not initialize SDL");
-    }
-    if (not SDL_CreateWindowAndRenderer(window_title.data(), window_width, window_height, SDL_WINDOW_RESIZABLE, &window,
-                                        &renderer)) {
-        SDL_Log("Could not create window and renderer: %s", SDL_GetError());
-        throw std::runtime_error("Could not create window and renderer");
-    }
-
-    SDL_SetRenderLogicalPresentation(renderer, window_width, window_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-
+    window_title{title}, window_width{width}, window_height{height},
+    runtime({.title = title, .width = width, .height = height}) {
+    auto *renderer = runtime.get_renderer();
     texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, 150, 150);
     if (not texture) {
         SDL_Log("Could not create texture: %s", SDL_GetError());
@@ -67,23 +61,29 @@ Application::Application(std::string_view title, int width, int height) :
 }
 
 Application::~Application() {
-    if (renderer)
-        SDL_DestroyRenderer(renderer);
-    if (window)
-        SDL_DestroyWindow(window);
+    // 纹理要在 runtime 销毁渲染器之前销毁
     if (texture)
         SDL_DestroyTexture(texture);
-    SDL_Quit();
+    if (img)
+        SDL_DestroyTexture(img);
 }
 
 SDL_AppResult Application::handle_event(SDL_Event *event) {
     if (event->type == SDL_EVENT_QUIT) {
         return SDL_APP_SUCCESS;
     }
+    runtime.handle_event(event);
     return SDL_APP_CONTINUE;
 }
 
 SDL_AppResult Application::handle_iteration() {
+    return runtime.iterate([this] {
+        draw(runtime.get_renderer());
+        return SDL_APP_CONTINUE;
+    });
+}
+
+void Application::draw(SDL_Renderer *renderer) {
     // SDL3: SDL_GetTicks returns Uint64 milliseconds
     const double now = static_cast<double>(SDL_GetTicks()) / 1000.0;
 
@@ -93,15 +93,15 @@ SDL_AppResult Application::handle_iteration() {
     const auto blue = static_cast<float>(0.5 + 0.5 * SDL_sin(now + SDL_PI_D * 4.0 / 3.0));
 
     // SDL3: Use SetRenderDrawColorFloat (0.0~1.0 range)
-    SDL_SetRenderDrawColorFloat(renderer, red, green, blue, SDL_ALPHA_OPAQUE_FLOAT);
+    app_runtime::set_draw_color_float(renderer, red, green, blue, SDL_ALPHA_OPAQUE_FLOAT);
 
-    SDL_RenderClear(renderer);
+    app_runtime::clear(renderer);
 
     const SDL_FRect rect{.x = 0,
                    .y = 0,
                    .w = static_cast<float>(window_width) * 1.0f,
                    .h = static_cast<float>(window_height) * 1.0f};
-    SDL_RenderTexture(renderer, img, nullptr, &rect);
+    app_runtime::render_texture(renderer, img, nullptr, &rect);
 
 
     const auto ticks = SDL_GetTicks();
@@ -126,9 +126,7 @@ SDL_AppResult Application::handle_iteration() {
     dst_rect.x = static_cast<float>(window_width - 150) / 2.0f;
     dst_rect.y = static_cast<float>(window_height - 150) / 2.0f;
     dst_rect.w = dst_rect.h = window_height / 2.0f;
-    SDL_RenderTexture(renderer, texture, nullptr, &dst_rect);
+    app_runtime::render_texture(renderer, texture, nullptr, &dst_rect);
 
-    SDL_RenderPresent(renderer);
-
-    return SDL_APP_CONTINUE;
+    runtime.present();
 }
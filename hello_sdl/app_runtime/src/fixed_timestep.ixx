@@ -0,0 +1,137 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+export module app_runtime.fixed_timestep;
+
+export namespace app_runtime {
+    /**
+     * 固定步长调度器，snake 和 woodeneye 的 fixed-step 模式共用：
+     * - begin_frame() 把经过的真实时间累加进累加器，返回这一帧应该执行的模拟步数，
+     *   落后太多时最多追赶 max_catch_up_steps 步，其余的积压直接丢弃，避免卡顿后越追越慢；
+     *   自己计时的调用方（例如 woodeneye 的 FramePacer）直接把帧间隔交给 advance()
+     * - get_alpha() 是累加器中剩余时间占一步的比例，渲染时用来在上一步和当前步之间插值
+     * - end_frame() 在下一帧或下一步到期之前用 SDL_WaitEventTimeout 等待，有输入事件时立即醒来，
+     *   不会在两步之间空转占满一个核心
+     */
+    class FixedTimestep {
+    public:
+        static constexpr int DEFAULT_MAX_CATCH_UP_STEPS = 5;
+        /// 不限制渲染帧率时传给 end_frame，只等到下一步到期
+        static constexpr Uint64 UNTIL_NEXT_STEP = UINT64_MAX;
+
+        explicit FixedTimestep(const Uint64 step_duration_ns,
+                               const int max_catch_up_steps = DEFAULT_MAX_CATCH_UP_STEPS) :
+            step_ns(step_duration_ns), max_steps(max_catch_up_steps) {}
+
+        /// 帧开始时调用，返回这一帧需要执行的模拟步数
+        auto begin_frame() -> int {
+            const auto now = SDL_GetTicksNS();
+            frame_start_ns = now;
+            if (last_frame_ns == 0) {
+                last_frame_ns = now;
+                stats_start_ns = now;
+                return 0;
+            }
+            const auto elapsed_ns = now - last_frame_ns;
+            last_frame_ns = now;
+            return advance(elapsed_ns);
+        }
+
+        /// 把 elapsed_ns 累加进累加器，返回需要执行的模拟步数；不读时钟，begin_frame() 也是通过它推进的
+        auto advance(const Uint64 elapsed_ns) -> int {
+            accumulator_ns += elapsed_ns;
+            auto steps = static_cast<int>(accumulator_ns / step_ns);
+            if (steps > max_steps) {
+                dropped_steps += static_cast<std::uint64_t>(steps - max_steps);
+                accumulator_ns %= step_ns;
+                steps = max_steps;
+            }
+            else {
+                accumulator_ns -= static_cast<Uint64>(steps) * step_ns;
+            }
+            window_steps += static_cast<std::uint64_t>(steps);
+            return steps;
+        }
+
+        /// 渲染插值系数，范围 [0, 1)
+        [[nodiscard]] auto get_alpha() const -> float {
+            return static_cast<float>(static_cast<double>(accumulator_ns) / static_cast<double>(step_ns));
+        }
+
+        [[nodiscard]] auto time_until_next_step_ns() const -> Uint64 {
+            const auto elapsed = accumulator_ns + (SDL_GetTicksNS() - last_frame_ns);
+            return elapsed >= step_ns ? 0 : step_ns - elapsed;
+        }
+
+        /**
+         * 帧结束时调用：最多等到 frame_start + frame_interval_ns，但不会越过下一步的到期时间，
+         * 期间有事件到达会立刻返回，事件随后由 SDL_AppEvent 处理
+         */
+        auto end_frame(const Uint64 frame_interval_ns) -> void {
+            const auto now = SDL_GetTicksNS();
+            busy_ns += now - frame_start_ns;
+            ++window_frames;
+
+            auto wait_ns = time_until_next_step_ns();
+            if (frame_interval_ns != UNTIL_NEXT_STEP) {
+                const auto frame_end_ns = frame_start_ns + frame_interval_ns;
+                wait_ns = std::min(wait_ns, frame_end_ns > now ? frame_end_ns - now : 0);
+            }
+            // SDL_WaitEventTimeout 以毫秒为单位，不足 1 ms 的部分不再等待
+            if (const auto wait_ms = static_cast<Sint32>(std::min<Uint64>(wait_ns / SDL_NS_PER_MS, INT32_MAX));
+                wait_ms > 0) {
+                SDL_WaitEventTimeout(nullptr, wait_ms);
+            }
+
+            update_stats();
+        }
+
+        /// 最近一秒内每秒执行的模拟步数
+        [[nodiscard]] auto get_steps_per_second() const -> double { return steps_per_second; }
+        /// 最近一秒内每秒渲染的帧数
+        [[nodiscard]] auto get_frames_per_second() const -> double { return frames_per_second; }
+        /// 最近一秒内调用线程处于忙碌（非等待）状态的时间比例，0 ~ 1
+        [[nodiscard]] auto get_cpu_utilisation() const -> double { return cpu_utilisation; }
+        /// 因为落后太多而被丢弃的步数
+        [[nodiscard]] auto get_dropped_steps() const -> std::uint64_t { return dropped_steps; }
+        /// 统计数据每秒更新一次，更新后返回 true 一次
+        auto consume_stats_update() -> bool { return std::exchange(stats_updated, false); }
+
+    private:
+        auto update_stats() -> void {
+            const auto now = SDL_GetTicksNS();
+            const auto elapsed_ns = now - stats_start_ns;
+            if (elapsed_ns < SDL_NS_PER_SECOND) {
+                return;
+            }
+            const auto seconds = static_cast<double>(elapsed_ns) / static_cast<double>(SDL_NS_PER_SECOND);
+            steps_per_second = static_cast<double>(window_steps) / seconds;
+            frames_per_second = static_cast<double>(window_frames) / seconds;
+            cpu_utilisation = static_cast<double>(busy_ns) / static_cast<double>(elapsed_ns);
+            window_steps = 0;
+            window_frames = 0;
+            busy_ns = 0;
+            stats_start_ns = now;
+            stats_updated = true;
+        }
+
+        const Uint64 step_ns;
+        const int max_steps;
+        Uint64 accumulator_ns = 0;
+        Uint64 last_frame_ns = 0;
+        Uint64 frame_start_ns = 0;
+
+        Uint64 stats_start_ns = 0;
+        Uint64 busy_ns = 0;
+        std::uint64_t window_steps = 0;
+        std::uint64_t window_frames = 0;
+        std::uint64_t dropped_steps = 0;
+        double steps_per_second = 0.0;
+        double frames_per_second = 0.0;
+        double cpu_utilisation = 0.0;
+        bool stats_updated = false;
+    };
+} // namespace app_runtime
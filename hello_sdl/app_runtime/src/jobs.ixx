@@ -0,0 +1,150 @@
+module;
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module app_runtime.jobs;
+
+import app_runtime.trace;
+
+export namespace app_runtime {
+    /**
+     * 简单的 fork-join 作业系统：一次派发一批编号为 [0, job_count) 的作业，
+     * 工作线程和调用 wait() 的线程一起用原子计数器领取作业，直到整批完成
+     * 作业之间不能互相等待，同一时刻只有一批作业在执行
+     * 工作线程在 Chrome Trace 里命名为 worker <编号>
+     */
+    class JobSystem {
+    public:
+        using Job = std::function<void(std::size_t job_index)>;
+
+        /// 默认每个硬件线程一个工作线程，调用 wait() 的线程也会参与，所以留出一个核心
+        static auto default_worker_count() -> unsigned int {
+            const auto hardware = std::thread::hardware_concurrency();
+            return hardware > 1 ? hardware - 1 : 0;
+        }
+
+        explicit JobSystem(const unsigned int worker_count = default_worker_count()) {
+            workers.reserve(worker_count);
+            for (unsigned int i = 0; i < worker_count; ++i) {
+                workers.emplace_back([this, i](const std::stop_token &stop) {
+                    app_runtime::trace::set_thread_name(std::format("worker {}", i));
+                    worker_loop(stop);
+                });
+            }
+        }
+
+        ~JobSystem() {
+            wait();
+            for (auto &worker: workers) {
+                worker.request_stop();
+            }
+            workers.clear();
+        }
+
+        JobSystem(const JobSystem &) = delete;
+        auto operator=(const JobSystem &) -> JobSystem & = delete;
+
+        /**
+         * 派发一批作业后立即返回，上一批还没完成时会先等它结束
+         * job 会在多个线程上并发调用，每个下标恰好调用一次
+         */
+        auto dispatch(const std::size_t job_count, Job job) -> void {
+            run_jobs(current_job, batch_size);
+            {
+                // 等上一批结束和改写这一批的状态必须在同一次加锁里：醒得晚的工作线程只能在拿锁后登记 active_workers，
+                // 这里看到 active_workers == 0 之后，直到放锁都不会有工作线程读 current_job 和 batch_size
+                std::unique_lock lock{mutex};
+                finished.wait(lock, [this] { return is_idle(); });
+                current_job = std::move(job);
+                batch_size = job_count;
+                next_job.store(0, std::memory_order_relaxed);
+                remaining.store(job_count, std::memory_order_relaxed);
+                ++generation;
+            }
+            wake.notify_all();
+        }
+
+        /// 调用线程一起执行剩余的作业，然后等待整批完成
+        auto wait() -> void {
+            run_jobs(current_job, batch_size);
+            std::unique_lock lock{mutex};
+            finished.wait(lock, [this] { return is_idle(); });
+        }
+
+        auto parallel_for(const std::size_t job_count, Job job) -> void {
+            dispatch(job_count, std::move(job));
+            wait();
+        }
+
+        /// 参与执行作业的线程数，包括调用 wait() 的线程
+        [[nodiscard]] auto get_thread_count() const -> std::size_t { return workers.size() + 1; }
+
+    private:
+        /// 需要持有 mutex
+        [[nodiscard]] auto is_idle() const -> bool {
+            return remaining.load(std::memory_order_acquire) == 0 && active_workers == 0;
+        }
+
+        auto worker_loop(const std::stop_token &stop) -> void {
+            std::uint64_t seen_generation = 0;
+            while (true) {
+                const Job *job = nullptr;
+                std::size_t job_count = 0;
+                {
+                    // 在锁内取这一批的作业和大小：登记了 active_workers 之后，dispatch() 要等它退出才会改写这两项
+                    std::unique_lock lock{mutex};
+                    if (not wake.wait(lock, stop, [&] { return generation != seen_generation; })) {
+                        return;
+                    }
+                    seen_generation = generation;
+                    job = &current_job;
+                    job_count = batch_size;
+                    ++active_workers;
+                }
+                run_jobs(*job, job_count);
+                {
+                    std::lock_guard lock{mutex};
+                    --active_workers;
+                }
+                finished.notify_all();
+            }
+        }
+
+        /// 工作线程传入在锁内取到的作业；调用线程就是派发者，直接传成员
+        auto run_jobs(const Job &job, const std::size_t job_count) -> void {
+            while (true) {
+                const auto index = next_job.fetch_add(1, std::memory_order_relaxed);
+                if (index >= job_count) {
+                    return;
+                }
+                job(index);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    // 先拿一次锁，避免 wait() 检查条件后、睡眠前错过通知
+                    { std::lock_guard lock{mutex}; }
+                    finished.notify_all();
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable_any wake;
+        std::condition_variable_any finished;
+        Job current_job;
+        std::size_t batch_size = 0;
+        std::uint64_t generation = 0;
+        std::size_t active_workers = 0;
+        std::atomic<std::size_t> next_job{0};
+        std::atomic<std::size_t> remaining{0};
+        // 最后声明，析构时最先 join
+        std::vector<std::jthread> workers;
+    };
+} // namespace app_runtime
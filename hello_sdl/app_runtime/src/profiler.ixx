@@ -0,0 +1,377 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module app_runtime.profiler;
+
+import app_runtime.render_stats;
+import app_runtime.trace;
+
+export namespace app_runtime {
+    /// 一组耗时的均值和分位数，单位毫秒
+    struct Distribution {
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    /// 一段连续帧的汇总
+    struct Summary {
+        std::uint64_t frames = 0;
+        double seconds = 0.0;
+        double fps = 0.0;
+        Distribution frame_ms;
+        std::vector<Distribution> scope_ms;
+        std::array<double, RENDER_CALL_KINDS> calls_per_frame{};
+        std::array<double, RENDER_CALL_KINDS> items_per_frame{};
+    };
+
+    /**
+     * 按帧记录各个计时区段的 CPU 时间和渲染调用计数
+     * 区段按名字登记，每帧的记录存在定长的环形缓冲区里，只保留最近 MAX_FRAMES 帧，运行多久都不会继续分配
+     * 退出时可以把保留的帧写成 CSV（每帧一行），把汇总写成 JSON
+     */
+    class Profiler {
+    public:
+        static constexpr std::size_t MAX_SCOPES = 8;
+        static constexpr std::size_t MAX_FRAMES = 16384;
+
+        struct FrameRecord {
+            Uint64 start_ns = 0;
+            /// 与上一帧开始时间的间隔，包括帧之间的等待
+            Uint64 interval_ns = 0;
+            std::array<Uint64, MAX_SCOPES> scope_ns{};
+            RenderCounts counts;
+        };
+
+        Profiler();
+
+        /// 返回名为 name 的区段的下标，第一次出现时登记；区段已满时抛出异常
+        auto scope_index(std::string_view name) -> std::size_t;
+
+        auto begin_frame() -> void;
+
+        auto add_time(const std::size_t scope, const Uint64 elapsed_ns) -> void {
+            current.scope_ns[scope] += elapsed_ns;
+        }
+
+        auto end_frame(const RenderCounts &counts) -> void;
+
+        /// 总共记录过的帧数，包括已经被环形缓冲区覆盖的
+        [[nodiscard]] auto get_frame_count() const -> std::uint64_t { return frame_count; }
+        [[nodiscard]] auto get_scope_names() const -> const std::vector<std::string> & { return scope_names; }
+
+        /// 汇总 [first_frame, get_frame_count()) 中仍然保留的帧
+        [[nodiscard]] auto summarize(std::uint64_t first_frame) const -> Summary;
+
+        auto write_csv(const std::filesystem::path &path) const -> void;
+        auto write_json(const std::filesystem::path &path, std::string_view title) const -> void;
+
+    private:
+        [[nodiscard]] auto oldest_frame() const -> std::uint64_t {
+            return frame_count > MAX_FRAMES ? frame_count - MAX_FRAMES : 0;
+        }
+
+        [[nodiscard]] auto record_at(const std::uint64_t frame) const -> const FrameRecord & {
+            return records[frame % MAX_FRAMES];
+        }
+
+        std::vector<std::string> scope_names;
+        std::vector<FrameRecord> records;
+        FrameRecord current;
+        Uint64 last_start_ns = 0;
+        std::uint64_t frame_count = 0;
+    };
+
+    /// 构造时开始计时，析构时把经过的时间记到 profiler 的 scope 区段
+    class ScopedTimer {
+    public:
+        ScopedTimer(Profiler &profiler, const std::size_t scope) :
+            profiler(profiler), scope(scope), start_ns(SDL_GetTicksNS()) {}
+
+        ~ScopedTimer() { profiler.add_time(scope, SDL_GetTicksNS() - start_ns); }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+
+    private:
+        Profiler &profiler;
+        const std::size_t scope;
+        const Uint64 start_ns;
+    };
+
+    /**
+     * 把 Profiler 和两个环境变量接在一起，Runtime 和不使用 SDL_Renderer 的 OpenGL 示例共用：
+     * - APP_RUNTIME_TRACE：析构时把每帧记录和汇总写到 <path>.csv 和 <path>.json（trace_path 非空时优先）
+     * - APP_RUNTIME_FRAMES：记录满这么多帧后 end_frame() 返回 true，示例据此退出，无头基准用它跑固定帧数
+     * 第 ITERATION_SCOPE 个区段固定是整次迭代
+     */
+    class FrameCapture {
+    public:
+        static constexpr std::size_t ITERATION_SCOPE = 0;
+
+        explicit FrameCapture(std::string title, std::filesystem::path trace_path = {});
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture &) = delete;
+        auto operator=(const FrameCapture &) -> FrameCapture & = delete;
+
+        [[nodiscard]] auto get_profiler() -> Profiler & { return profiler; }
+        [[nodiscard]] auto get_profiler() const -> const Profiler & { return profiler; }
+
+        auto begin_frame() -> void { profiler.begin_frame(); }
+
+        /// 结束一帧，帧数达到 APP_RUNTIME_FRAMES 时返回 true
+        auto end_frame(const RenderCounts &counts = {}) -> bool {
+            profiler.end_frame(counts);
+            return frame_limit != 0 && profiler.get_frame_count() >= frame_limit;
+        }
+
+    private:
+        auto write_trace() const -> void;
+
+        const std::string title;
+        Profiler profiler;
+        std::filesystem::path trace_path;
+        std::uint64_t frame_limit = 0;
+    };
+} // namespace app_runtime
+
+namespace app_runtime {
+    namespace {
+        constexpr double NS_PER_MS = static_cast<double>(SDL_NS_PER_MS);
+
+        /// 会打乱 samples 的顺序
+        auto distribution(std::vector<double> &samples) -> Distribution {
+            if (samples.empty()) {
+                return {};
+            }
+            Distribution result;
+            for (const auto sample: samples) {
+                result.mean += sample;
+            }
+            result.mean /= static_cast<double>(samples.size());
+            const auto percentile = [&samples](const double fraction) {
+                const auto index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+                std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(index));
+                return samples[index];
+            };
+            result.p50 = percentile(0.50);
+            result.p99 = percentile(0.99);
+            result.max = std::ranges::max(samples);
+            return result;
+        }
+
+        auto write_distribution(std::ofstream &out, const Distribution &value) -> void {
+            out << std::format(R"({{"mean": {:.4f}, "p50": {:.4f}, "p99": {:.4f}, "max": {:.4f}}})", value.mean,
+                               value.p50, value.p99, value.max);
+        }
+
+        /// CSV 字段里出现逗号、引号或换行时整个字段用引号包起来，内部的引号写两遍
+        auto write_csv_field(std::ofstream &out, const std::string_view text) -> void {
+            if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+                out << text;
+                return;
+            }
+            out << '"';
+            for (const auto c: text) {
+                if (c == '"') {
+                    out << '"';
+                }
+                out << c;
+            }
+            out << '"';
+        }
+
+        auto open_output(const std::filesystem::path &path) -> std::ofstream {
+            if (path.has_parent_path()) {
+                std::filesystem::create_directories(path.parent_path());
+            }
+            std::ofstream out(path);
+            if (not out) {
+                throw std::runtime_error(std::format("Failed to open {} for writing", path.string()));
+            }
+            return out;
+        }
+    } // namespace
+
+    Profiler::Profiler() : records(MAX_FRAMES) { scope_names.reserve(MAX_SCOPES); }
+
+    auto Profiler::scope_index(const std::string_view name) -> std::size_t {
+        if (const auto it = std::ranges::find(scope_names, name); it != scope_names.end()) {
+            return static_cast<std::size_t>(it - scope_names.begin());
+        }
+        if (scope_names.size() == MAX_SCOPES) {
+            throw std::runtime_error(std::format("Too many profiler scopes, cannot add {}", name));
+        }
+        scope_names.emplace_back(name);
+        return scope_names.size() - 1;
+    }
+
+    auto Profiler::begin_frame() -> void {
+        const auto now = SDL_GetTicksNS();
+        current = {};
+        current.start_ns = now;
+        current.interval_ns = last_start_ns == 0 ? 0 : now - last_start_ns;
+        last_start_ns = now;
+    }
+
+    auto Profiler::end_frame(const RenderCounts &counts) -> void {
+        current.counts = counts;
+        records[frame_count % MAX_FRAMES] = current;
+        ++frame_count;
+    }
+
+    auto Profiler::summarize(const std::uint64_t first_frame) const -> Summary {
+        const auto begin = std::max(first_frame, oldest_frame());
+        Summary summary;
+        summary.scope_ms.resize(scope_names.size());
+        if (begin >= frame_count) {
+            return summary;
+        }
+        summary.frames = frame_count - begin;
+
+        std::vector<double> samples;
+        samples.reserve(summary.frames);
+        // 第一帧没有间隔，不计入帧时间
+        for (auto frame = begin; frame < frame_count; ++frame) {
+            if (const auto interval_ns = record_at(frame).interval_ns; interval_ns != 0) {
+                samples.push_back(static_cast<double>(interval_ns) / NS_PER_MS);
+            }
+        }
+        for (const auto sample: samples) {
+            summary.seconds += sample / 1000.0;
+        }
+        summary.fps = summary.seconds > 0.0 ? static_cast<double>(samples.size()) / summary.seconds : 0.0;
+        summary.frame_ms = distribution(samples);
+
+        for (std::size_t scope = 0; scope < scope_names.size(); ++scope) {
+            samples.clear();
+            for (auto frame = begin; frame < frame_count; ++frame) {
+                samples.push_back(static_cast<double>(record_at(frame).scope_ns[scope]) / NS_PER_MS);
+            }
+            summary.scope_ms[scope] = distribution(samples);
+        }
+
+        for (auto frame = begin; frame < frame_count; ++frame) {
+            const auto &counts = record_at(frame).counts;
+            for (std::size_t kind = 0; kind < RENDER_CALL_KINDS; ++kind) {
+                summary.calls_per_frame[kind] += counts.calls[kind];
+                summary.items_per_frame[kind] += counts.items[kind];
+            }
+        }
+        for (std::size_t kind = 0; kind < RENDER_CALL_KINDS; ++kind) {
+            summary.calls_per_frame[kind] /= static_cast<double>(summary.frames);
+            summary.items_per_frame[kind] /= static_cast<double>(summary.frames);
+        }
+        return summary;
+    }
+
+    auto Profiler::write_csv(const std::filesystem::path &path) const -> void {
+        auto out = open_output(path);
+        out << "frame,start_ms,interval_ms";
+        for (const auto &name: scope_names) {
+            out << ',';
+            write_csv_field(out, name + "_ms");
+        }
+        for (std::size_t kind = 0; kind < RENDER_CALL_KINDS; ++kind) {
+            const auto name = to_string(static_cast<RenderCall>(kind));
+            out << ',' << name << "_calls," << name << "_items";
+        }
+        out << '\n';
+
+        const auto first_start_ns = frame_count == 0 ? 0 : record_at(oldest_frame()).start_ns;
+        for (auto frame = oldest_frame(); frame < frame_count; ++frame) {
+            const auto &record = record_at(frame);
+            out << std::format("{},{:.4f},{:.4f}", frame,
+                               static_cast<double>(record.start_ns - first_start_ns) / NS_PER_MS,
+                               static_cast<double>(record.interval_ns) / NS_PER_MS);
+            for (std::size_t scope = 0; scope < scope_names.size(); ++scope) {
+                out << std::format(",{:.4f}", static_cast<double>(record.scope_ns[scope]) / NS_PER_MS);
+            }
+            for (std::size_t kind = 0; kind < RENDER_CALL_KINDS; ++kind) {
+                out << ',' << record.counts.calls[kind] << ',' << record.counts.items[kind];
+            }
+            out << '\n';
+        }
+    }
+
+    auto Profiler::write_json(const std::filesystem::path &path, const std::string_view title) const -> void {
+        const auto summary = summarize(0);
+        auto out = open_output(path);
+        out << "{\n";
+        out << "  \"title\": \"";
+        trace::write_json_escaped(out, title);
+        out << "\",\n";
+        out << std::format("  \"frames\": {},\n", summary.frames);
+        out << std::format("  \"seconds\": {:.3f},\n", summary.seconds);
+        out << std::format("  \"fps\": {:.2f},\n", summary.fps);
+        out << "  \"frame_ms\": ";
+        write_distribution(out, summary.frame_ms);
+        out << ",\n  \"scopes_ms\": {";
+        for (std::size_t scope = 0; scope < scope_names.size(); ++scope) {
+            out << (scope == 0 ? "\n    \"" : ",\n    \"");
+            trace::write_json_escaped(out, scope_names[scope]);
+            out << "\": ";
+            write_distribution(out, summary.scope_ms[scope]);
+        }
+        out << "\n  },\n  \"render_calls_per_frame\": {";
+        for (std::size_t kind = 0; kind < RENDER_CALL_KINDS; ++kind) {
+            const auto name = to_string(static_cast<RenderCall>(kind));
+            out << (kind == 0 ? "\n    " : ",\n    ")
+                << std::format(R"("{}": {{"calls": {:.2f}, "items": {:.2f}}})", name, summary.calls_per_frame[kind],
+                               summary.items_per_frame[kind]);
+        }
+        out << "\n  }\n}\n";
+    }
+
+    FrameCapture::FrameCapture(std::string title, std::filesystem::path trace_path) :
+        title(std::move(title)), trace_path(std::move(trace_path)) {
+        if (this->trace_path.empty()) {
+            if (const auto *environment = SDL_getenv("APP_RUNTIME_TRACE"); environment != nullptr) {
+                this->trace_path = environment;
+            }
+        }
+        if (const auto *environment = SDL_getenv("APP_RUNTIME_FRAMES"); environment != nullptr) {
+            frame_limit = SDL_strtoull(environment, nullptr, 10);
+        }
+        profiler.scope_index("iteration");
+    }
+
+    FrameCapture::~FrameCapture() {
+        if (trace_path.empty()) {
+            return;
+        }
+        try {
+            write_trace();
+        }
+        catch (const std::exception &e) {
+            SDL_Log("%s", e.what());
+        }
+    }
+
+    auto FrameCapture::write_trace() const -> void {
+        auto csv_path = trace_path;
+        csv_path += ".csv";
+        auto json_path = trace_path;
+        json_path += ".json";
+        profiler.write_csv(csv_path);
+        profiler.write_json(json_path, title);
+        const auto frames = std::min<std::uint64_t>(profiler.get_frame_count(), Profiler::MAX_FRAMES);
+        SDL_Log("Wrote %llu frames to %s and %s", static_cast<unsigned long long>(frames), csv_path.string().c_str(),
+                json_path.string().c_str());
+    }
+} // namespace app_runtime
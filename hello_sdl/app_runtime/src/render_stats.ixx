@@ -0,0 +1,158 @@
+module;
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+export module app_runtime.render_stats;
+
+export namespace app_runtime {
+    /// 统计的渲染调用类别
+    enum class RenderCall : std::uint8_t {
+        DrawColor,
+        Clear,
+        Point,
+        Line,
+        Rect,
+        FillRect,
+        Texture,
+        Geometry,
+    };
+
+    constexpr std::size_t RENDER_CALL_KINDS = 8;
+
+    [[nodiscard]] constexpr auto to_string(const RenderCall call) -> std::string_view {
+        constexpr std::array<std::string_view, RENDER_CALL_KINDS> names{
+                "draw_color", "clear", "point", "line", "rect", "fill_rect", "texture", "geometry"};
+        return names[static_cast<std::size_t>(call)];
+    }
+
+    /**
+     * 一帧里每类渲染调用的次数，以及这些调用画出的图元数量：
+     * 点、线段、矩形按个数计，纹理按次数计，几何体按顶点数计
+     * 例如一次 SDL_RenderFillRects 画 16 个矩形，calls 加 1，items 加 16
+     */
+    struct RenderCounts {
+        std::array<std::uint32_t, RENDER_CALL_KINDS> calls{};
+        std::array<std::uint32_t, RENDER_CALL_KINDS> items{};
+
+        [[nodiscard]] auto get_calls(const RenderCall call) const -> std::uint32_t {
+            return calls[static_cast<std::size_t>(call)];
+        }
+
+        [[nodiscard]] auto get_items(const RenderCall call) const -> std::uint32_t {
+            return items[static_cast<std::size_t>(call)];
+        }
+
+        [[nodiscard]] auto total_calls() const -> std::uint32_t {
+            std::uint32_t total = 0;
+            for (const auto count: calls) {
+                total += count;
+            }
+            return total;
+        }
+    };
+
+    /**
+     * 统计每帧的渲染调用，只统计经过下面这些包装函数的调用
+     * SDL 的渲染函数只能在主线程上调用，所以计数不需要原子操作；Runtime 在每帧结束时调用 end_frame()
+     */
+    class RenderCounter {
+    public:
+        static auto add(const RenderCall call, const std::uint32_t items = 1) -> void {
+            current.calls[static_cast<std::size_t>(call)] += 1;
+            current.items[static_cast<std::size_t>(call)] += items;
+        }
+
+        /// 返回这一帧的计数并清零
+        static auto end_frame() -> RenderCounts {
+            const auto counts = current;
+            current = {};
+            return counts;
+        }
+
+    private:
+        static inline RenderCounts current{};
+    };
+
+    // 与同名 SDL 函数参数、返回值相同，调用前先计数
+
+    auto set_draw_color(SDL_Renderer *renderer, const Uint8 r, const Uint8 g, const Uint8 b, const Uint8 a) -> bool {
+        RenderCounter::add(RenderCall::DrawColor);
+        return SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    }
+
+    auto set_draw_color_float(SDL_Renderer *renderer, const float r, const float g, const float b, const float a)
+            -> bool {
+        RenderCounter::add(RenderCall::DrawColor);
+        return SDL_SetRenderDrawColorFloat(renderer, r, g, b, a);
+    }
+
+    auto clear(SDL_Renderer *renderer) -> bool {
+        RenderCounter::add(RenderCall::Clear);
+        return SDL_RenderClear(renderer);
+    }
+
+    auto render_point(SDL_Renderer *renderer, const float x, const float y) -> bool {
+        RenderCounter::add(RenderCall::Point);
+        return SDL_RenderPoint(renderer, x, y);
+    }
+
+    auto render_points(SDL_Renderer *renderer, const SDL_FPoint *points, const int count) -> bool {
+        RenderCounter::add(RenderCall::Point, static_cast<std::uint32_t>(SDL_max(count, 0)));
+        return SDL_RenderPoints(renderer, points, count);
+    }
+
+    auto render_line(SDL_Renderer *renderer, const float x1, const float y1, const float x2, const float y2) -> bool {
+        RenderCounter::add(RenderCall::Line);
+        return SDL_RenderLine(renderer, x1, y1, x2, y2);
+    }
+
+    /// 与 SDL_RenderLines 一样画首尾相连的折线，count 个点是 count - 1 条线段
+    auto render_lines(SDL_Renderer *renderer, const SDL_FPoint *points, const int count) -> bool {
+        RenderCounter::add(RenderCall::Line, static_cast<std::uint32_t>(SDL_max(count - 1, 0)));
+        return SDL_RenderLines(renderer, points, count);
+    }
+
+    auto render_rect(SDL_Renderer *renderer, const SDL_FRect *rect) -> bool {
+        RenderCounter::add(RenderCall::Rect);
+        return SDL_RenderRect(renderer, rect);
+    }
+
+    auto render_rects(SDL_Renderer *renderer, const SDL_FRect *rects, const int count) -> bool {
+        RenderCounter::add(RenderCall::Rect, static_cast<std::uint32_t>(SDL_max(count, 0)));
+        return SDL_RenderRects(renderer, rects, count);
+    }
+
+    auto render_fill_rect(SDL_Renderer *renderer, const SDL_FRect *rect) -> bool {
+        RenderCounter::add(RenderCall::FillRect);
+        return SDL_RenderFillRect(renderer, rect);
+    }
+
+    auto render_fill_rects(SDL_Renderer *renderer, const SDL_FRect *rects, const int count) -> bool {
+        RenderCounter::add(RenderCall::FillRect, static_cast<std::uint32_t>(SDL_max(count, 0)));
+        return SDL_RenderFillRects(renderer, rects, count);
+    }
+
+    auto render_texture(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_FRect *source,
+                        const SDL_FRect *destination) -> bool {
+        RenderCounter::add(RenderCall::Texture);
+        return SDL_RenderTexture(renderer, texture, source, destination);
+    }
+
+    auto render_geometry(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Vertex *vertices,
+                         const int vertex_count, const int *indices, const int index_count) -> bool {
+        RenderCounter::add(RenderCall::Geometry, static_cast<std::uint32_t>(SDL_max(vertex_count, 0)));
+        return SDL_RenderGeometry(renderer, texture, vertices, vertex_count, indices, index_count);
+    }
+
+    auto render_geometry_raw(SDL_Renderer *renderer, SDL_Texture *texture, const float *xy, const int xy_stride,
+                             const SDL_FColor *color, const int color_stride, const float *uv, const int uv_stride,
+                             const int vertex_count, const void *indices, const int index_count,
+                             const int size_indices) -> bool {
+        RenderCounter::add(RenderCall::Geometry, static_cast<std::uint32_t>(SDL_max(vertex_count, 0)));
+        return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride,
+                                     vertex_count, indices, index_count, size_indices);
+    }
+} // namespace app_runtime
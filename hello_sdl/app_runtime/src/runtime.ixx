@@ -0,0 +1,243 @@
+module;
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+export module app_runtime;
+
+export import app_runtime.profiler;
+export import app_runtime.render_stats;
+export import app_runtime.trace;
+
+export namespace app_runtime {
+    struct Options {
+        std::string_view title = "hello_sdl";
+        int width = 640;
+        int height = 480;
+        SDL_WindowFlags window_flags = SDL_WINDOW_RESIZABLE;
+        /// 为 true 时按 width x height 的逻辑分辨率加黑边缩放
+        bool logical_presentation = true;
+        /// 启动时是否显示统计叠加层，运行时按 F3 切换
+        bool show_overlay = false;
+        /**
+         * 非空时退出时写出 <trace_path>.csv 和 <trace_path>.json
+         * 为空时读取环境变量 APP_RUNTIME_TRACE，这样每个示例不用改命令行就能以同样的方式采集，见 FrameCapture
+         */
+        std::filesystem::path trace_path{};
+        /// 非空时退出时把各个线程的计时区段写成 Chrome Trace JSON；为空时读取环境变量 APP_RUNTIME_CHROME_TRACE
+        std::filesystem::path chrome_trace_path{};
+    };
+
+    /// scope() 返回的计时对象，同一段时间既记到 Profiler 的区段里，也记到 Chrome Trace 的时间线上
+    struct Scope {
+        ScopedTimer timer;
+        trace::Zone zone;
+    };
+
+    /**
+     * 所有 hello_sdl 示例共用的运行时：
+     * - 负责 SDL_Init、窗口和渲染器的创建与销毁
+     * - iterate() 包住每一次 handle_iteration，记录帧间隔、CPU 时间和经过 render_stats 包装函数的渲染调用
+     * - scope() 给一帧中的某一段单独计时，例如更新和绘制，同时在 Chrome Trace 里记一个区段
+     * - present() 在 SDL_RenderPresent 之前画出统计叠加层，叠加层每秒更新一次
+     * 析构时如果设置了 trace_path，把每帧记录和汇总写到文件里
+     * 设置了环境变量 APP_RUNTIME_FRAMES 时，跑满这么多帧后 iterate() 返回 SDL_APP_SUCCESS，示例随之退出
+     */
+    class Runtime {
+    public:
+        explicit Runtime(const Options &options);
+        ~Runtime();
+
+        Runtime(const Runtime &) = delete;
+        auto operator=(const Runtime &) -> Runtime & = delete;
+
+        [[nodiscard]] auto get_window() const -> SDL_Window * { return window; }
+        [[nodiscard]] auto get_renderer() const -> SDL_Renderer * { return renderer; }
+        [[nodiscard]] auto get_profiler() const -> const Profiler & { return capture.get_profiler(); }
+
+        /// 处理运行时自己的按键（F3 切换叠加层），处理了就返回 true，示例不需要再处理这个事件
+        auto handle_event(const SDL_Event *event) -> bool;
+
+        /// 把一次 handle_iteration 作为一帧计时，body 返回的结果原样返回，帧数达到 APP_RUNTIME_FRAMES 时除外
+        template<typename Body>
+        auto iterate(Body &&body) -> SDL_AppResult {
+            capture.begin_frame();
+            SDL_AppResult result;
+            {
+                const ScopedTimer timer(profiler, FrameCapture::ITERATION_SCOPE);
+                const trace::Zone zone("iteration");
+                result = std::forward<Body>(body)();
+            }
+            const auto finished = capture.end_frame(RenderCounter::end_frame());
+            refresh_stats();
+            return finished && result == SDL_APP_CONTINUE ? SDL_APP_SUCCESS : result;
+        }
+
+        /// 为名为 name 的区段计时，直到返回的对象析构；name 要求和 trace::Zone 一样，例如字符串字面量
+        [[nodiscard]] auto scope(const char *name) -> Scope {
+            return {{profiler, profiler.scope_index(name)}, trace::Zone(name)};
+        }
+
+        /// 画统计叠加层（如果打开了）然后 SDL_RenderPresent
+        auto present() -> bool;
+
+        /// 最近一秒的汇总，每秒更新一次
+        [[nodiscard]] auto get_stats() const -> const Summary & { return stats; }
+        /// 汇总每秒更新一次，更新后返回 true 一次
+        auto consume_stats_update() -> bool { return std::exchange(stats_updated, false); }
+
+    private:
+        static constexpr std::size_t OVERLAY_LINES = 4;
+        static constexpr std::size_t OVERLAY_LINE_LENGTH = 128;
+
+        auto refresh_stats() -> void;
+        auto format_overlay() -> void;
+        auto draw_overlay() -> void;
+
+        const std::string title;
+        SDL_Window *window = nullptr;
+        SDL_Renderer *renderer = nullptr;
+
+        FrameCapture capture;
+        Profiler &profiler = capture.get_profiler();
+        trace::Session trace_session;
+
+        bool show_overlay = false;
+        Summary stats;
+        bool stats_updated = false;
+        Uint64 stats_start_ns = 0;
+        std::uint64_t stats_first_frame = 0;
+        std::array<std::array<char, OVERLAY_LINE_LENGTH>, OVERLAY_LINES> overlay{};
+    };
+} // namespace app_runtime
+
+namespace app_runtime {
+    Runtime::Runtime(const Options &options) :
+        title(options.title), capture(title, options.trace_path), trace_session(options.chrome_trace_path),
+        show_overlay(options.show_overlay) {
+        if (not SDL_Init(SDL_INIT_VIDEO)) {
+            const auto result = std::format("SDL_Init Error: {}", SDL_GetError());
+            SDL_Log("%s", result.c_str());
+            throw std::runtime_error(result);
+        }
+        if (not SDL_CreateWindowAndRenderer(title.c_str(), options.width, options.height, options.window_flags,
+                                            &window, &renderer)) {
+            const auto result = std::format("SDL_CreateWindowAndRenderer Error: {}", SDL_GetError());
+            SDL_Log("%s", result.c_str());
+            SDL_Quit();
+            throw std::runtime_error(result);
+        }
+        if (options.logical_presentation) {
+            SDL_SetRenderLogicalPresentation(renderer, options.width, options.height,
+                                             SDL_LOGICAL_PRESENTATION_LETTERBOX);
+        }
+    }
+
+    Runtime::~Runtime() {
+        if (renderer) {
+            SDL_DestroyRenderer(renderer);
+        }
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+    }
+
+    auto Runtime::handle_event(const SDL_Event *event) -> bool {
+        if (event->type == SDL_EVENT_KEY_DOWN && event->key.scancode == SDL_SCANCODE_F3 && not event->key.repeat) {
+            show_overlay = not show_overlay;
+            return true;
+        }
+        return false;
+    }
+
+    auto Runtime::present() -> bool {
+        if (show_overlay) {
+            draw_overlay();
+        }
+        return SDL_RenderPresent(renderer);
+    }
+
+    auto Runtime::refresh_stats() -> void {
+        const auto now = SDL_GetTicksNS();
+        if (stats_start_ns == 0) {
+            stats_start_ns = now;
+            return;
+        }
+        if (now - stats_start_ns < SDL_NS_PER_SECOND) {
+            return;
+        }
+        stats = profiler.summarize(stats_first_frame);
+        stats_first_frame = profiler.get_frame_count();
+        stats_start_ns = now;
+        stats_updated = true;
+        format_overlay();
+    }
+
+    auto Runtime::format_overlay() -> void {
+        const auto write_line = [this](const std::size_t line, const std::string &text) {
+            auto &buffer = overlay[line];
+            const auto result = std::format_to_n(buffer.data(), static_cast<std::ptrdiff_t>(buffer.size() - 1), "{}",
+                                                 text);
+            *result.out = '\0';
+        };
+        const auto calls = [this](const RenderCall call) {
+            return stats.calls_per_frame[static_cast<std::size_t>(call)];
+        };
+        // 调用次数 / 图元数量
+        const auto per_frame = [this, &calls](const RenderCall call) {
+            return std::format("{:.0f}/{:.0f}", calls(call), stats.items_per_frame[static_cast<std::size_t>(call)]);
+        };
+
+        write_line(0, std::format("{:.0f} fps  frame p50 {:.2f}  p99 {:.2f}  max {:.2f} ms", stats.fps,
+                                  stats.frame_ms.p50, stats.frame_ms.p99, stats.frame_ms.max));
+        std::string scopes;
+        const auto &names = profiler.get_scope_names();
+        for (std::size_t scope = 0; scope < names.size(); ++scope) {
+            scopes += std::format("{}{} {:.2f}", scope == 0 ? "cpu ms  " : "  ", names[scope],
+                                  stats.scope_ms[scope].mean);
+        }
+        write_line(1, scopes);
+        write_line(2, std::format("color {:.0f}  clear {:.0f}  point {}  line {}", calls(RenderCall::DrawColor),
+                                  calls(RenderCall::Clear), per_frame(RenderCall::Point), per_frame(RenderCall::Line)));
+        write_line(3, std::format("rect {}  fill {}  texture {}  geometry {}", per_frame(RenderCall::Rect),
+                                  per_frame(RenderCall::FillRect), per_frame(RenderCall::Texture),
+                                  per_frame(RenderCall::Geometry)));
+    }
+
+    auto Runtime::draw_overlay() -> void {
+        // 叠加层画在左下角，不计入渲染调用统计，也不改变示例设置的绘制颜色
+        int width = 0;
+        int height = 0;
+        SDL_RendererLogicalPresentation mode;
+        SDL_GetRenderLogicalPresentation(renderer, &width, &height, &mode);
+        if (mode == SDL_LOGICAL_PRESENTATION_DISABLED) {
+            SDL_GetCurrentRenderOutputSize(renderer, &width, &height);
+        }
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+        SDL_BlendMode blend_mode;
+        SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+        SDL_SetRenderClipRect(renderer, nullptr);
+
+        constexpr float line_height = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE + 2.0f;
+        const auto top = static_cast<float>(height) - line_height * static_cast<float>(OVERLAY_LINES) - 2.0f;
+        const SDL_FRect background{0.0f, top - 2.0f, static_cast<float>(width), line_height * OVERLAY_LINES + 4.0f};
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+        SDL_RenderFillRect(renderer, &background);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+        for (std::size_t line = 0; line < OVERLAY_LINES; ++line) {
+            SDL_RenderDebugText(renderer, 2.0f, top + line_height * static_cast<float>(line), overlay[line].data());
+        }
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+    }
+} // namespace app_runtime
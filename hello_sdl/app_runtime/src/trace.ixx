@@ -0,0 +1,285 @@
+module;
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// CMake 选项 APP_RUNTIME_ENABLE_CHROME_TRACE 关掉时定义为 0
+#ifndef APP_RUNTIME_ENABLE_CHROME_TRACE
+#define APP_RUNTIME_ENABLE_CHROME_TRACE 1
+#endif
+
+export module app_runtime.trace;
+
+export namespace app_runtime::trace {
+    /// 编译期开关，为 false 时 Zone、record 都是空函数，热路径上不留任何代码
+    constexpr bool COMPILED_IN = APP_RUNTIME_ENABLE_CHROME_TRACE != 0;
+
+    /// 一段耗时（Chrome Trace 的 "ph": "X" 事件），name 必须指向静态存储期的字符串，例如字符串字面量
+    struct Event {
+        const char *name = nullptr;
+        Uint64 start_ns = 0;
+        Uint64 duration_ns = 0;
+    };
+
+    /**
+     * 一条时间线（Chrome Trace 里的一个 tid）上的定长环形缓冲区，写满后覆盖最旧的事件
+     * 只允许一个线程写入，写入不加锁：先写事件，再用 release 推进 head
+     * 写出文件时用 acquire 读 head，这时写入线程应当已经停止写入
+     */
+    class Track {
+    public:
+        static constexpr std::size_t CAPACITY = std::size_t{1} << 16;
+
+        Track(const std::uint32_t id, std::string name) : id(id), name(std::move(name)), events(CAPACITY) {}
+
+        auto push(const Event &event) -> void {
+            const auto index = head.load(std::memory_order_relaxed);
+            events[index % CAPACITY] = event;
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        [[nodiscard]] auto get_id() const -> std::uint32_t { return id; }
+        [[nodiscard]] auto get_name() const -> const std::string & { return name; }
+        auto set_name(const std::string_view track_name) -> void { name = track_name; }
+
+        /// 按时间顺序访问仍然保留的事件，返回访问的个数
+        template<typename Visitor>
+        auto for_each_event(Visitor &&visitor) const -> std::size_t {
+            const auto end = head.load(std::memory_order_acquire);
+            const auto begin = end > CAPACITY ? end - CAPACITY : 0;
+            for (auto index = begin; index < end; ++index) {
+                visitor(events[index % CAPACITY]);
+            }
+            return end - begin;
+        }
+
+    private:
+        const std::uint32_t id;
+        std::string name;
+        std::vector<Event> events;
+        std::atomic<std::uint64_t> head{0};
+    };
+} // namespace app_runtime::trace
+
+namespace app_runtime::trace {
+    std::atomic<bool> recording{false};
+    thread_local Track *thread_track = nullptr;
+
+    /// 第一次在某个线程上记录时为它创建时间线
+    auto create_thread_track() -> Track *;
+} // namespace app_runtime::trace
+
+export namespace app_runtime::trace {
+    [[nodiscard]] inline auto is_recording() -> bool {
+        if constexpr (COMPILED_IN) {
+            return recording.load(std::memory_order_relaxed);
+        }
+        else {
+            return false;
+        }
+    }
+
+    /// 在当前线程的时间线上记录一段耗时
+    inline auto record(const char *name, const Uint64 start_ns, const Uint64 duration_ns) -> void {
+        if constexpr (COMPILED_IN) {
+            if (thread_track == nullptr) {
+                thread_track = create_thread_track();
+            }
+            thread_track->push({.name = name, .start_ns = start_ns, .duration_ns = duration_ns});
+        }
+    }
+
+    /// 给当前线程的时间线命名，没有命名的线程显示为 thread <id>
+    auto set_thread_name(std::string_view thread_name) -> void;
+
+    /**
+     * 创建一条不属于任何线程的时间线，例如 GPU 耗时；返回的时间线在进程结束前一直有效
+     * 调用者要保证同一时刻只有一个线程写它
+     */
+    auto create_track(std::string_view track_name) -> Track &;
+
+    /// 把 text 按 JSON 字符串的规则转义后写出（不含两端的引号），profiler 的 JSON 汇总也用它
+    auto write_json_escaped(std::ostream &out, std::string_view text) -> void;
+
+    /// 把所有时间线上保留的事件写成 Chrome Trace Event JSON，返回写出的事件数；打不开文件时抛出异常
+    auto write_chrome_trace(const std::filesystem::path &path) -> std::size_t;
+
+    /**
+     * 作用域计时：构造时记下开始时间，析构时把这一段写到当前线程的时间线上
+     * 没有在记录时只读一次原子变量，name 必须指向静态存储期的字符串
+     */
+    class Zone {
+    public:
+        explicit Zone(const char *name) {
+            if constexpr (COMPILED_IN) {
+                if (is_recording()) {
+                    this->name = name;
+                    start_ns = SDL_GetTicksNS();
+                }
+            }
+        }
+
+        ~Zone() {
+            if constexpr (COMPILED_IN) {
+                if (name != nullptr) {
+                    record(name, start_ns, SDL_GetTicksNS() - start_ns);
+                }
+            }
+        }
+
+        Zone(const Zone &) = delete;
+        auto operator=(const Zone &) -> Zone & = delete;
+
+    private:
+        const char *name = nullptr;
+        Uint64 start_ns = 0;
+    };
+
+    /**
+     * 一次采集：path 为空时读取环境变量 APP_RUNTIME_CHROME_TRACE，仍为空就不采集
+     * 构造时开始记录并把当前线程命名为 main，析构时停止记录并写出文件，可以直接拖进 chrome://tracing 或 Perfetto
+     * 析构前其他线程应当已经退出或空闲，否则它们正在写的最后几个事件可能不完整
+     */
+    class Session {
+    public:
+        explicit Session(std::filesystem::path path = {});
+        ~Session();
+
+        Session(const Session &) = delete;
+        auto operator=(const Session &) -> Session & = delete;
+
+        [[nodiscard]] auto is_active() const -> bool { return not path.empty(); }
+
+    private:
+        std::filesystem::path path;
+    };
+} // namespace app_runtime::trace
+
+namespace app_runtime::trace {
+    namespace {
+        std::mutex tracks_mutex;
+        std::vector<std::unique_ptr<Track>> tracks;
+        thread_local std::string pending_thread_name;
+
+        auto add_track(std::string name) -> Track & {
+            std::lock_guard lock{tracks_mutex};
+            const auto id = static_cast<std::uint32_t>(tracks.size() + 1);
+            if (name.empty()) {
+                name = std::format("thread {}", id);
+            }
+            return *tracks.emplace_back(std::make_unique<Track>(id, std::move(name)));
+        }
+    } // namespace
+
+    auto create_thread_track() -> Track * { return &add_track(pending_thread_name); }
+
+    auto write_json_escaped(std::ostream &out, const std::string_view text) -> void {
+        for (const auto c: text) {
+            if (c == '"' or c == '\\') {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                out << std::format("\\u{:04x}", static_cast<unsigned int>(c));
+            }
+            else {
+                out << c;
+            }
+        }
+    }
+
+    auto set_thread_name(const std::string_view thread_name) -> void {
+        if constexpr (COMPILED_IN) {
+            pending_thread_name = thread_name;
+            if (thread_track != nullptr) {
+                std::lock_guard lock{tracks_mutex};
+                thread_track->set_name(thread_name);
+            }
+        }
+    }
+
+    auto create_track(const std::string_view track_name) -> Track & { return add_track(std::string(track_name)); }
+
+    auto write_chrome_trace(const std::filesystem::path &path) -> std::size_t {
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+        std::ofstream out(path);
+        if (not out) {
+            throw std::runtime_error(std::format("Failed to open {} for writing", path.string()));
+        }
+
+        std::lock_guard lock{tracks_mutex};
+        std::size_t event_count = 0;
+        out << R"({"displayTimeUnit": "ms", "traceEvents": [)";
+        const auto *separator = "\n";
+        for (const auto &track: tracks) {
+            const auto id = track->get_id();
+            out << separator << R"({"ph": "M", "name": "thread_name", "pid": 1, "tid": )" << id
+                << R"(, "args": {"name": ")";
+            write_json_escaped(out, track->get_name());
+            out << "\"}},\n"
+                << std::format(R"({{"ph": "M", "name": "thread_sort_index", "pid": 1, "tid": {}, )"
+                               R"("args": {{"sort_index": {}}}}})",
+                               id, id);
+            separator = ",\n";
+
+            event_count += track->for_each_event([&out, separator, id](const Event &event) {
+                out << separator << R"({"ph": "X", "name": ")";
+                write_json_escaped(out, event.name);
+                out << std::format(R"(", "pid": 1, "tid": {}, "ts": {:.3f}, "dur": {:.3f}}})", id,
+                                   static_cast<double>(event.start_ns) / SDL_NS_PER_US,
+                                   static_cast<double>(event.duration_ns) / SDL_NS_PER_US);
+            });
+        }
+        out << "\n]}\n";
+        return event_count;
+    }
+
+    Session::Session(std::filesystem::path path) : path(std::move(path)) {
+        if constexpr (not COMPILED_IN) {
+            this->path.clear();
+            return;
+        }
+        if (this->path.empty()) {
+            if (const auto *environment = SDL_getenv("APP_RUNTIME_CHROME_TRACE"); environment != nullptr) {
+                this->path = environment;
+            }
+        }
+        if (this->path.empty()) {
+            return;
+        }
+        // 主线程的时间线先创建，在查看器里排在最上面
+        set_thread_name("main");
+        if (thread_track == nullptr) {
+            thread_track = create_thread_track();
+        }
+        recording.store(true, std::memory_order_relaxed);
+    }
+
+    Session::~Session() {
+        if (path.empty()) {
+            return;
+        }
+        recording.store(false, std::memory_order_relaxed);
+        try {
+            const auto event_count = write_chrome_trace(path);
+            SDL_Log("Wrote %zu trace events to %s", event_count, path.string().c_str());
+        }
+        catch (const std::exception &e) {
+            SDL_Log("%s", e.what());
+        }
+    }
+} // namespace app_runtime::trace
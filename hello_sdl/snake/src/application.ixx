@@ -1,219 +1,257 @@
 module;
 #include <SDL3/SDL.h>
 #include <entt/entt.hpp>
+#include <exception>
+#include <filesystem>
 #include <format>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 export module snake.application;
 
+import app_runtime;
+import app_runtime.fixed_timestep;
 import snake;
+import snake.game;
+import snake.replay;
 
 export class Application {
 public:
-    explicit Application(std::string_view window_title = "Snake", int width = 640, int height = 480);
+    /// seed 为 0 时使用随机种子；record_path 不为空时退出时把本局输入保存为录像
+    /// autopilot 为 true 时蛇从左上角出发沿哈密顿回路自动前进，无头基准用它跑满帧数而不会撞死
+    explicit Application(std::string_view window_title = "Snake", int width = 640, int height = 480, Uint64 seed = 0,
+                         std::filesystem::path record_path = {}, bool autopilot = false);
     ~Application();
     auto handle_event(SDL_Event *event) -> SDL_AppResult;
     auto handle_iteration() -> SDL_AppResult;
 
 private:
-    auto render(entt::registry &registry, SDL_Renderer *renderer) -> void;
+    auto steer(int dx, int dy) -> void;
+    auto steer_autopilot() -> void;
+    /// 一帧中推进游戏和渲染的部分，由 runtime 计时
+    auto iterate() -> SDL_AppResult;
+    [[nodiscard]] auto is_visible() const -> bool;
+    auto render(entt::registry &registry, SDL_Renderer *renderer, float alpha) -> void;
+    auto update_title() -> void;
+    static auto cell_rect(const Position &position) -> SDL_FRect;
+    static auto lerp_cell_rect(const Position &from, const Position &to, float alpha) -> SDL_FRect;
+    static auto fill_rects(SDL_Renderer *renderer, const std::vector<SDL_FRect> &rects, Uint8 r, Uint8 g, Uint8 b)
+            -> void;
 
     const std::string_view window_title;
     const int window_width = 640;
     const int window_height = 480;
+    static constexpr int CELL_SIZE = 24; // 每个格子的像素大小
     const int step_delay_ms = 200; // 每一步的延迟时间，单位为毫秒
-    int snake_length = 3; // 蛇的当前长度
+    static constexpr Uint64 RENDER_INTERVAL_NS = SDL_NS_PER_SECOND / 60; // 渲染帧率上限
 
-    SDL_Window *window = nullptr;
-    SDL_Renderer *renderer = nullptr;
+    // 窗口和渲染器由 runtime 创建和销毁
+    app_runtime::Runtime runtime;
 
-    entt::registry registry;
-};
-
-Application::Application(const std::string_view window_title, const int width, const int height) :
-    window_title(window_title), window_width(width), window_height(height) {
-    if (not SDL_Init(SDL_INIT_VIDEO)) {
-        const auto result = std::format("SDL_Init Error: {}", SDL_GetError());
-        throw std::runtime_error(result);
-    }
+    const Uint64 game_seed;
+    const bool autopilot;
+    Game game;
+    app_runtime::FixedTimestep timestep;
 
-    if (not SDL_CreateWindowAndRenderer(window_title.data(), window_width, window_height, SDL_WINDOW_RESIZABLE, &window,
-                                        &renderer)) {
-        const auto result = std::format("SDL_CreateWindowAndRenderer Error: {}", SDL_GetError());
-        throw std::runtime_error(result);
-    }
-    SDL_SetRenderLogicalPresentation(renderer, window_width, window_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
+    const std::filesystem::path record_path;
+    replay::Recording recording;
 
-    const auto head = registry.create();
-    registry.emplace<Position>(head, 10, 10);
-    registry.emplace<SnakeSegment>(head, snake_length); // 初始长度为3
-    registry.emplace<Direction>(head, 1, 0); // 初始向右移动
-    registry.emplace<SnakeHead>(head); // 标记为蛇头
+    // 按渲染类别收集的矩形，每帧复用，避免重复分配
+    std::vector<SDL_FRect> food_rects;
+    std::vector<SDL_FRect> body_rects;
+    std::vector<SDL_FRect> head_rects;
+};
 
-    const auto food = registry.create();
-    registry.emplace<Position>(food, 5, 5);
-    registry.emplace<Food>(food);
-}
+Application::Application(const std::string_view window_title, const int width, const int height, const Uint64 seed,
+                         std::filesystem::path record_path, const bool autopilot) :
+    window_title(window_title), window_width(width), window_height(height),
+    runtime({.title = window_title, .width = width, .height = height}),
+    game_seed(seed != 0 ? seed : SDL_GetPerformanceCounter()), autopilot(autopilot),
+    game(width / CELL_SIZE, height / CELL_SIZE, game_seed, Game::INITIAL_LENGTH,
+         autopilot ? Position{0, 0} : Game::DEFAULT_HEAD_POSITION),
+    timestep(static_cast<Uint64>(step_delay_ms) * SDL_NS_PER_MS), record_path(std::move(record_path)),
+    recording{.seed = game_seed, .grid_width = width / CELL_SIZE, .grid_height = height / CELL_SIZE} {}
 
 Application::~Application() {
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    if (not record_path.empty()) {
+        try {
+            replay::save_recording(record_path, recording);
+            SDL_Log("Saved %zu inputs to %s", recording.inputs.size(), record_path.string().c_str());
+        }
+        catch (const std::exception &e) {
+            SDL_Log("%s", e.what());
+        }
+    }
 }
 
 auto Application::handle_event(SDL_Event *event) -> SDL_AppResult {
     if (event->type == SDL_EVENT_QUIT) {
         return SDL_APP_SUCCESS;
     }
+    if (runtime.handle_event(event)) {
+        return SDL_APP_CONTINUE;
+    }
 
     if (event->type == SDL_EVENT_KEY_DOWN) {
-        auto head_view = registry.view<Direction, SnakeHead>();
-        for (const auto &entity: head_view) {
-            auto &[dx, dy] = head_view.get<Direction>(entity);
-            switch (event->key.scancode) {
-                case SDL_SCANCODE_UP:
-                    if (dy != 1) { // 防止反向移动
-                        dx = 0;
-                        dy = -1;
-                    }
-                    break;
-                case SDL_SCANCODE_DOWN:
-                    if (dy != -1) {
-                        dx = 0;
-                        dy = 1;
-                    }
-                    break;
-                case SDL_SCANCODE_LEFT:
-                    if (dx != 1) {
-                        dx = -1;
-                        dy = 0;
-                    }
-                    break;
-                case SDL_SCANCODE_RIGHT:
-                    if (dx != -1) {
-                        dx = 1;
-                        dy = 0;
-                    }
-                    break;
-                default:
-                    break;
-            }
+        switch (event->key.scancode) {
+            case SDL_SCANCODE_UP:
+                steer(0, -1);
+                break;
+            case SDL_SCANCODE_DOWN:
+                steer(0, 1);
+                break;
+            case SDL_SCANCODE_LEFT:
+                steer(-1, 0);
+                break;
+            case SDL_SCANCODE_RIGHT:
+                steer(1, 0);
+                break;
+            default:
+                break;
         }
     }
 
     return SDL_APP_CONTINUE;
 }
 
-auto Application::handle_iteration() -> SDL_AppResult {
-    SDL_SetRenderDrawColor(renderer, 10, 10, 30, 255);
-    SDL_RenderClear(renderer);
-
-    const auto current_tick = SDL_GetTicks();
-    static auto last_step_tick = current_tick;
-
-    if (current_tick - last_step_tick >= step_delay_ms) {
-        last_step_tick = current_tick;
-
-        // 1. 提取当前蛇头的信息
-        auto head_view = registry.view<Position, Direction, SnakeHead>();
-        entt::entity old_head = head_view.front();
-        auto [old_pos, head_dir] = head_view.get<Position, Direction>(old_head);
-
-        // 2. 计算新位置
-        Position next_pos = {old_pos.x + head_dir.dx, old_pos.y + head_dir.dy};
+/// 转向并记录下发生在第几步之前，重放时在同一步之前调用同样的 turn 即可复现
+auto Application::steer(const int dx, const int dy) -> void {
+    recording.inputs.push_back({.step = game.get_step_count(), .dx = dx, .dy = dy});
+    game.turn(dx, dy);
+}
 
-        // 3. 边界检测
-        const int grid_width = window_width / 24;
-        const int grid_height = window_height / 24;
-        if (next_pos.x < 0 || next_pos.x >= grid_width || next_pos.y < 0 || next_pos.y >= grid_height) {
-            SDL_Log("Game Over: Hit the boundary!");
-            return SDL_APP_SUCCESS; // 撞墙，游戏结束
-        }
+/// 自动驾驶的转向不记入录像：录像重放时蛇从默认位置出发，走不上同一条回路
+auto Application::steer_autopilot() -> void {
+    const auto &head = game.get_registry().get<SnakeBody>(game.get_snake()).head();
+    const auto [dx, dy] = replay::hamiltonian_direction(head.x, head.y, window_width / CELL_SIZE,
+                                                        window_height / CELL_SIZE);
+    game.turn(dx, dy);
+}
 
-        // 4. 自身碰撞检测（排除当前蛇头，因为蛇头位置即将变成蛇身）
-        auto body_view = registry.view<Position, SnakeSegment>();
-        for (auto entity: body_view) {
-            // 跳过当前蛇头，只检测真正的蛇身部分
-            if (entity == old_head) {
-                continue;
-            }
-            const auto &body_pos = body_view.get<Position>(entity);
-            if (body_pos.x == next_pos.x && body_pos.y == next_pos.y) {
-                SDL_Log("Game Over: Hit yourself!");
-                return SDL_APP_SUCCESS; // 撞到自己，游戏结束
-            }
-        }
+auto Application::handle_iteration() -> SDL_AppResult {
+    // Chrome Trace 里整帧包括等待，帧间隔的尖峰可以看出是落在 step、render 还是等待上
+    const app_runtime::trace::Zone zone("handle_iteration");
+    const auto result = runtime.iterate([this] { return iterate(); });
+    if (result != SDL_APP_CONTINUE) {
+        return result;
+    }
+    // 等待放在 runtime 的计时之外，iteration 只统计推进和渲染花的时间
+    {
+        const app_runtime::trace::Zone wait_zone("wait");
+        timestep.end_frame(is_visible() ? RENDER_INTERVAL_NS : app_runtime::FixedTimestep::UNTIL_NEXT_STEP);
+    }
+    if (timestep.consume_stats_update()) {
+        update_title();
+    }
+    return SDL_APP_CONTINUE;
+}
 
-        // 5. 碰撞检测 (食物)
-        bool eating = false;
-        auto food_view = registry.view<Position, Food>();
-        for (auto f_entity: food_view) {
-            if (auto &f_pos = food_view.get<Position>(f_entity); f_pos.x == next_pos.x && f_pos.y == next_pos.y) {
-                eating = true;
-                snake_length++; // 增加蛇的长度
-                // 简单的食物重生逻辑
-                f_pos.x = SDL_rand(grid_width);
-                f_pos.y = SDL_rand(grid_height);
-                break;
-            }
-        }
+auto Application::is_visible() const -> bool {
+    constexpr auto hidden_flags = SDL_WINDOW_MINIMIZED | SDL_WINDOW_OCCLUDED | SDL_WINDOW_HIDDEN;
+    return (SDL_GetWindowFlags(runtime.get_window()) & hidden_flags) == 0;
+}
 
-        // 6. 处理蛇身逻辑
-        // 给所有蛇节 age - 1 (如果没吃到东西)
-        auto seg_view = registry.view<SnakeSegment>();
-        for (auto entity: seg_view) {
-            auto &seg = seg_view.get<SnakeSegment>(entity);
-            if (!eating) {
-                seg.age--;
+auto Application::iterate() -> SDL_AppResult {
+    // 按固定步长推进游戏，落后时一帧内最多追赶若干步
+    const auto steps = timestep.begin_frame();
+    {
+        const auto timer = runtime.scope("step");
+        for (int i = 0; i < steps; ++i) {
+            if (autopilot) {
+                steer_autopilot();
             }
-            if (seg.age <= 0) {
-                registry.destroy(entity);
+            switch (game.step()) {
+                case StepResult::HitWall:
+                    SDL_Log("Game Over: Hit the boundary!");
+                    return SDL_APP_SUCCESS; // 撞墙，游戏结束
+                case StepResult::HitSelf:
+                    SDL_Log("Game Over: Hit yourself!");
+                    return SDL_APP_SUCCESS; // 撞到自己，游戏结束
+                default:
+                    break;
             }
         }
-
-        // 7. 创建新头（它继承了旧头的方向和当前长度）
-        auto new_entity = registry.create();
-        registry.emplace<Position>(new_entity, next_pos);
-        registry.emplace<Direction>(new_entity, head_dir); // 保持方向
-        registry.emplace<SnakeSegment>(new_entity, snake_length); // 使用当前长度
-        registry.emplace<SnakeHead>(new_entity); // 标记为蛇头
-
-        // 旧头不再是头了，移除头部相关组件
-        registry.remove<Direction>(old_head);
-        registry.remove<SnakeHead>(old_head);
     }
-    render(registry, renderer);
 
-    SDL_RenderPresent(renderer);
+    // 窗口不可见时不渲染，直接等到下一步
+    if (is_visible()) {
+        const auto timer = runtime.scope("render");
+        auto *renderer = runtime.get_renderer();
+        app_runtime::set_draw_color(renderer, 10, 10, 30, 255);
+        app_runtime::clear(renderer);
+        render(game.get_registry(), renderer, timestep.get_alpha());
+        runtime.present();
+    }
     return SDL_APP_CONTINUE;
 }
 
-auto Application::render(entt::registry &registry, SDL_Renderer *renderer) -> void {
+auto Application::update_title() -> void {
+    const auto title = std::format("{} | {:.1f} steps/s | {:.0f} fps | CPU {:.1f}%", window_title,
+                                   timestep.get_steps_per_second(), timestep.get_frames_per_second(),
+                                   timestep.get_cpu_utilisation() * 100.0);
+    SDL_SetWindowTitle(runtime.get_window(), title.c_str());
+}
+
+auto Application::render(entt::registry &registry, SDL_Renderer *renderer, const float alpha) -> void {
     // 绘制边界
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // 白色边界
+    app_runtime::set_draw_color(renderer, 255, 255, 255, 255); // 白色边界
     SDL_FRect boundary{.x = 0, .y = 0, .w = static_cast<float>(window_width), .h = static_cast<float>(window_height)};
-    SDL_RenderRect(renderer, &boundary);
+    app_runtime::render_rect(renderer, &boundary);
+
+    // 按类别收集矩形，每个类别只设置一次颜色、调用一次 SDL_RenderFillRects，
+    // 每帧的渲染调用次数与蛇的长度无关
+    food_rects.clear();
+    body_rects.clear();
+    head_rects.clear();
 
-    // 绘制游戏实体
-    const auto view = registry.view<Position>();
-    for (const auto &entity: view) {
-        const auto &position = view.get<Position>(entity);
+    // 食物：拥有 Position 的 group 会把带 Food 的实体排在 Position 存储的最前面，遍历是连续的
+    for (const auto [entity, position]: registry.group<Position>(entt::get<Food>).each()) {
+        food_rects.push_back(cell_rect(position));
+    }
 
-        if (registry.all_of<Food>(entity)) {
-            // 食物：红色
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    // 蛇：SnakeBody 环形缓冲区最多两段连续内存，从蛇尾到蛇头，最后一节是蛇头
+    // 蛇头从上一格滑向当前格，蛇尾从刚离开的格子滑向当前蛇尾，其余蛇节不动
+    for (const auto [entity, body]: registry.view<SnakeBody>().each()) {
+        if (body.empty()) {
+            continue;
         }
-        else if (registry.all_of<SnakeHead>(entity)) {
-            // 蛇头：亮绿色/黄绿色
-            SDL_SetRenderDrawColor(renderer, 150, 255, 0, 255);
+        for (const auto &segment: body.segments()) {
+            for (const auto &position: segment) {
+                body_rects.push_back(cell_rect(position));
+            }
         }
-        else {
-            // 蛇身：普通绿色
-            SDL_SetRenderDrawColor(renderer, 0, 200, 0, 255);
+        body_rects.pop_back();
+        const auto &previous_head = body.size() >= 2 ? body[body.size() - 2] : body.head();
+        head_rects.push_back(lerp_cell_rect(previous_head, body.head(), alpha));
+        if (const auto vacated_tail = game.get_vacated_tail()) {
+            body_rects.push_back(lerp_cell_rect(*vacated_tail, body.tail(), alpha));
         }
+    }
+
+    fill_rects(renderer, food_rects, 255, 0, 0); // 食物：红色
+    fill_rects(renderer, body_rects, 0, 200, 0); // 蛇身：普通绿色
+    fill_rects(renderer, head_rects, 150, 255, 0); // 蛇头：亮绿色/黄绿色
+}
+
+auto Application::cell_rect(const Position &position) -> SDL_FRect {
+    return {.x = static_cast<float>(position.x * CELL_SIZE),
+            .y = static_cast<float>(position.y * CELL_SIZE),
+            .w = CELL_SIZE,
+            .h = CELL_SIZE};
+}
+
+auto Application::lerp_cell_rect(const Position &from, const Position &to, const float alpha) -> SDL_FRect {
+    const auto x = static_cast<float>(from.x) + static_cast<float>(to.x - from.x) * alpha;
+    const auto y = static_cast<float>(from.y) + static_cast<float>(to.y - from.y) * alpha;
+    return {.x = x * CELL_SIZE, .y = y * CELL_SIZE, .w = CELL_SIZE, .h = CELL_SIZE};
+}
 
-        SDL_FRect rect{
-                .x = static_cast<float>(position.x * 24), .y = static_cast<float>(position.y * 24), .w = 24, .h = 24};
-        SDL_RenderFillRect(renderer, &rect);
+auto Application::fill_rects(SDL_Renderer *renderer, const std::vector<SDL_FRect> &rects, const Uint8 r,
+                             const Uint8 g, const Uint8 b) -> void {
+    if (rects.empty()) {
+        return;
     }
+    app_runtime::set_draw_color(renderer, r, g, b, 255);
+    app_runtime::render_fill_rects(renderer, rects.data(), static_cast<int>(rects.size()));
 }
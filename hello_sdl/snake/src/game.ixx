@@ -0,0 +1,142 @@
+module;
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <optional>
+
+export module snake.game;
+
+import snake;
+import snake.grid;
+
+export enum class StepResult {
+    Moved,
+    Ate,
+    HitWall,
+    HitSelf,
+};
+
+/**
+ * 与窗口、渲染无关的贪吃蛇规则，可以无头运行（基准测试、回放）
+ * 所有随机数都来自构造时给定的种子
+ */
+export class Game {
+public:
+    static constexpr int INITIAL_LENGTH = 3;
+    static constexpr Position DEFAULT_HEAD_POSITION{10, 10};
+    static constexpr Position DEFAULT_FOOD_POSITION{5, 5};
+
+    /// head_position 和 food_position 必须落在网格内，调用者负责检查
+    Game(const int width, const int height, const Uint64 seed, const int initial_length = INITIAL_LENGTH,
+         const Position head_position = DEFAULT_HEAD_POSITION, const Position food_position = DEFAULT_FOOD_POSITION) :
+        grid_width(width), grid_height(height), snake_length(initial_length), rng_state(seed) {
+        auto &grid = connect_occupancy_grid(registry, grid_width, grid_height);
+
+        // 整条蛇是一个实体：环形缓冲区存放蛇身，蛇身格子直接登记在占用表里
+        snake = registry.create();
+        auto &body = registry.emplace<SnakeBody>(snake, static_cast<std::size_t>(grid_width * grid_height));
+        body.push_head(head_position);
+        grid.occupy(grid.cell_index(head_position.x, head_position.y), snake);
+        registry.emplace<Direction>(snake, 1, 0); // 初始向右移动
+        registry.emplace<SnakeHead>(snake); // 标记为蛇头
+
+        const auto food = registry.create();
+        registry.emplace<Position>(food, food_position);
+        registry.emplace<Food>(food);
+    }
+
+    Game(const Game &) = delete;
+    auto operator=(const Game &) -> Game & = delete;
+
+    /// 改变蛇头方向，不允许直接掉头
+    auto turn(const int dx, const int dy) -> void {
+        auto head_view = registry.view<Direction, SnakeHead>();
+        for (const auto &entity: head_view) {
+            auto &direction = head_view.get<Direction>(entity);
+            if (direction.dx == -dx && direction.dy == -dy) {
+                continue;
+            }
+            direction = {dx, dy};
+        }
+    }
+
+    /// 前进一格
+    auto step() -> StepResult {
+        // 1. 提取当前蛇头的信息
+        auto &body = registry.get<SnakeBody>(snake);
+        const auto &old_pos = body.head();
+        const auto &head_dir = registry.get<Direction>(snake);
+
+        // 2. 计算新位置
+        const Position next_pos = {old_pos.x + head_dir.dx, old_pos.y + head_dir.dy};
+
+        // 3. 边界检测
+        auto &grid = registry.ctx().get<OccupancyGrid>();
+        if (not grid.in_bounds(next_pos.x, next_pos.y)) {
+            return StepResult::HitWall;
+        }
+
+        // 4. 查表检测碰撞：格子里不是食物就是蛇身（蛇尾这一步还没有移走，与原先的规则一致）
+        bool eating = false;
+        if (const auto occupant = grid.at(next_pos.x, next_pos.y); occupant != entt::null) {
+            if (not registry.all_of<Food>(occupant)) {
+                return StepResult::HitSelf;
+            }
+            // 5. 吃到食物
+            eating = true;
+            snake_length++; // 增加蛇的长度
+            respawn_food(occupant);
+        }
+
+        // 6. 蛇头前进一格，超出当前长度时移走蛇尾
+        body.push_head(next_pos);
+        grid.occupy(grid.cell_index(next_pos.x, next_pos.y), snake);
+        vacated_tail.reset();
+        while (body.size() > static_cast<std::size_t>(snake_length)) {
+            const auto tail = body.pop_tail();
+            grid.release(grid.cell_index(tail.x, tail.y), snake);
+            vacated_tail = tail;
+        }
+
+        ++step_count;
+        return eating ? StepResult::Ate : StepResult::Moved;
+    }
+
+    [[nodiscard]] auto get_registry() -> entt::registry & { return registry; }
+    [[nodiscard]] auto get_registry() const -> const entt::registry & { return registry; }
+    [[nodiscard]] auto get_snake() const -> entt::entity { return snake; }
+    /// 上一步蛇尾离开的格子（没有移走蛇尾时为空），渲染插值用
+    [[nodiscard]] auto get_vacated_tail() const -> std::optional<Position> { return vacated_tail; }
+    [[nodiscard]] auto get_snake_length() const -> int { return snake_length; }
+    /// 成功前进的步数，录制输入时用它标记每次转向发生在第几步之前
+    [[nodiscard]] auto get_step_count() const -> std::uint64_t { return step_count; }
+    [[nodiscard]] auto get_rng_state() const -> Uint64 { return rng_state; }
+    [[nodiscard]] auto get_grid_width() const -> int { return grid_width; }
+    [[nodiscard]] auto get_grid_height() const -> int { return grid_height; }
+
+private:
+    /**
+     * 从空闲格子中直接抽取新位置，不会落在蛇身上，也不需要重试
+     * 网格已经被蛇占满时移除食物
+     */
+    auto respawn_food(const entt::entity food) -> void {
+        const auto &grid = registry.ctx().get<OccupancyGrid>();
+        const auto cell = grid.random_free_cell(rng_state);
+        if (cell < 0) {
+            registry.destroy(food);
+            return;
+        }
+        registry.replace<Position>(food, cell % grid_width, cell / grid_width);
+    }
+
+    const int grid_width;
+    const int grid_height;
+    int snake_length; // 蛇的当前长度
+    Uint64 rng_state;
+    std::uint64_t step_count = 0;
+
+    entt::registry registry;
+    entt::entity snake = entt::null;
+    std::optional<Position> vacated_tail;
+};
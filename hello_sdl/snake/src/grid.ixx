@@ -0,0 +1,120 @@
+module;
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <entt/entt.hpp>
+#include <vector>
+
+export module snake.grid;
+
+import snake;
+
+/**
+ * 网格占用表：每个格子记录占据它的实体，同时维护一个空闲格子列表
+ * 碰撞检测是 O(1) 的数组访问，食物重生可以直接从空闲列表里随机抽取，不需要反复重试
+ */
+export class OccupancyGrid {
+public:
+    OccupancyGrid(const int width, const int height) :
+        grid_width(width), grid_height(height),
+        cells(static_cast<std::size_t>(width * height), static_cast<entt::entity>(entt::null)),
+        free_slots(static_cast<std::size_t>(width * height)) {
+        free_cells.reserve(cells.size());
+        for (int cell = 0; cell < width * height; ++cell) {
+            free_slots[cell] = static_cast<int>(free_cells.size());
+            free_cells.push_back(cell);
+        }
+    }
+
+    [[nodiscard]] auto in_bounds(const int x, const int y) const -> bool {
+        return x >= 0 && x < grid_width && y >= 0 && y < grid_height;
+    }
+
+    [[nodiscard]] auto cell_index(const int x, const int y) const -> int { return y * grid_width + x; }
+
+    /// 占据 (x, y) 的实体，空格子返回 entt::null
+    [[nodiscard]] auto at(const int x, const int y) const -> entt::entity { return cells[cell_index(x, y)]; }
+
+    auto occupy(const int cell, const entt::entity entity) -> void {
+        if (cells[cell] == entt::null) {
+            // 从空闲列表中交换删除
+            const auto slot = free_slots[cell];
+            const auto last = free_cells.back();
+            free_cells[slot] = last;
+            free_slots[last] = slot;
+            free_cells.pop_back();
+            free_slots[cell] = -1;
+        }
+        cells[cell] = entity;
+    }
+
+    /// 只有格子仍然属于 entity 时才释放，避免覆盖后来者
+    auto release(const int cell, const entt::entity entity) -> void {
+        if (cells[cell] != entity) {
+            return;
+        }
+        cells[cell] = entt::null;
+        free_slots[cell] = static_cast<int>(free_cells.size());
+        free_cells.push_back(cell);
+    }
+
+    [[nodiscard]] auto get_free_count() const -> std::size_t { return free_cells.size(); }
+
+    /// 随机抽取一个空闲格子，网格已满时返回 -1
+    [[nodiscard]] auto random_free_cell(Uint64 &rng_state) const -> int {
+        if (free_cells.empty()) {
+            return -1;
+        }
+        return free_cells[SDL_rand_r(&rng_state, static_cast<Sint32>(free_cells.size()))];
+    }
+
+    [[nodiscard]] auto get_width() const -> int { return grid_width; }
+    [[nodiscard]] auto get_height() const -> int { return grid_height; }
+
+private:
+    int grid_width;
+    int grid_height;
+    std::vector<entt::entity> cells;
+    std::vector<int> free_cells;
+    std::vector<int> free_slots; // 每个格子在 free_cells 中的下标，被占据时为 -1
+};
+
+/// 实体当前登记在网格中的格子，Position 被 replace/patch 时用它找到旧格子
+export struct GridCell {
+    int index;
+};
+
+auto on_position_construct(entt::registry &registry, const entt::entity entity) -> void {
+    auto &grid = registry.ctx().get<OccupancyGrid>();
+    const auto &[x, y] = registry.get<Position>(entity);
+    const auto cell = grid.cell_index(x, y);
+    grid.occupy(cell, entity);
+    registry.emplace_or_replace<GridCell>(entity, cell);
+}
+
+auto on_position_update(entt::registry &registry, const entt::entity entity) -> void {
+    auto &grid = registry.ctx().get<OccupancyGrid>();
+    const auto &[x, y] = registry.get<Position>(entity);
+    auto &[index] = registry.get<GridCell>(entity);
+    grid.release(index, entity);
+    index = grid.cell_index(x, y);
+    grid.occupy(index, entity);
+}
+
+auto on_position_destroy(entt::registry &registry, const entt::entity entity) -> void {
+    auto &grid = registry.ctx().get<OccupancyGrid>();
+    const auto &[x, y] = registry.get<Position>(entity);
+    grid.release(grid.cell_index(x, y), entity);
+}
+
+/**
+ * 在 registry 的上下文中创建占用表，并通过 Position 的 on_construct / on_update / on_destroy 信号保持同步
+ * 之后移动实体必须使用 registry.replace / patch，直接修改 Position 不会通知网格
+ * 所有带 Position 的实体都必须位于网格范围内
+ */
+export auto connect_occupancy_grid(entt::registry &registry, const int width, const int height) -> OccupancyGrid & {
+    auto &grid = registry.ctx().emplace<OccupancyGrid>(width, height);
+    registry.on_construct<Position>().connect<&on_position_construct>();
+    registry.on_update<Position>().connect<&on_position_update>();
+    registry.on_destroy<Position>().connect<&on_position_destroy>();
+    return grid;
+}
@@ -1,11 +1,106 @@
 #define SDL_MAIN_USE_CALLBACKS 1
+#include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <string_view>
 
 import snake.application;
+import snake.replay;
+
+namespace {
+    std::atomic<std::size_t> allocation_count{0};
+} // namespace
+
+// 统计堆分配次数，无头模式用它计算每步的分配次数
+auto operator new(const std::size_t size) -> void * {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void *pointer) noexcept -> void { std::free(pointer); }
+auto operator delete(void *pointer, std::size_t) noexcept -> void { std::free(pointer); }
+
+namespace {
+    /// 不初始化 SDL 视频子系统，尽可能快地运行游戏逻辑并打印吞吐量和最终状态哈希
+    auto run_headless(const replay::HeadlessOptions &options) -> SDL_AppResult {
+        const auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+        const auto result = replay::run_headless(options);
+        const auto allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+        const auto steps = static_cast<double>(result.steps);
+        std::printf("steps:            %llu\n", static_cast<unsigned long long>(result.steps));
+        std::printf("games:            %llu\n", static_cast<unsigned long long>(result.games));
+        std::printf("seconds:          %.3f\n", result.seconds);
+        std::printf("steps/sec:        %.0f\n", result.seconds > 0.0 ? steps / result.seconds : 0.0);
+        std::printf("allocations/step: %.4f\n", steps > 0.0 ? static_cast<double>(allocations) / steps : 0.0);
+        std::printf("state hash:       %016llx\n", static_cast<unsigned long long>(result.state_hash));
+        return SDL_APP_SUCCESS;
+    }
+} // namespace
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
-    auto application = std::make_unique<Application>();
+    // --headless：不打开窗口，运行 --steps N 步后打印 steps/sec、每步分配次数和状态哈希
+    // --replay FILE：无头模式下重放录像（种子和网格大小取自录像），否则用自动驾驶
+    // --seed N：固定随机种子；--record FILE：窗口模式下把这一局的输入保存为录像
+    // --autopilot：窗口模式下用自动驾驶，配合 APP_RUNTIME_FRAMES 做无头基准
+    bool headless = false;
+    replay::HeadlessOptions options;
+    std::uint64_t seed = 0;
+    std::filesystem::path replay_path;
+    std::filesystem::path record_path;
+    bool autopilot = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument{argv[i]};
+        if (argument == "--headless") {
+            headless = true;
+        }
+        else if (argument == "--steps" && i + 1 < argc) {
+            options.steps = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--seed" && i + 1 < argc) {
+            seed = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        }
+        else if (argument == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        }
+        else if (argument == "--autopilot") {
+            autopilot = true;
+        }
+    }
+
+    if (headless) {
+        *appstate = nullptr;
+        if (seed != 0) {
+            options.seed = seed;
+        }
+        try {
+            if (not replay_path.empty()) {
+                options.recording = replay::load_recording(replay_path);
+            }
+            return run_headless(options);
+        }
+        catch (const std::exception &e) {
+            SDL_Log("%s", e.what());
+            return SDL_APP_FAILURE;
+        }
+    }
+
+    auto application = std::make_unique<Application>("Snake", 640, 480, seed, record_path, autopilot);
     if (not application) {
         throw std::runtime_error("Failed to create application");
     }
@@ -26,4 +121,4 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 void SDL_AppQuit(void *appstate, const SDL_AppResult result) {
     const auto *application = static_cast<Application *>(appstate);
     delete application;
-}
\ No newline at end of file
+}
@@ -0,0 +1,251 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+export module snake.replay;
+
+import snake;
+import snake.game;
+
+export namespace replay {
+    /// 默认窗口 640x480、每格 24 像素时的网格大小
+    constexpr int DEFAULT_GRID_WIDTH = 640 / 24;
+    constexpr int DEFAULT_GRID_HEIGHT = 480 / 24;
+    /// 录像不保存起点，重放时蛇头和食物总在 Game 的默认位置，网格至少要装得下它们
+    constexpr int MIN_GRID_WIDTH = std::max(Game::DEFAULT_HEAD_POSITION.x, Game::DEFAULT_FOOD_POSITION.x) + 1;
+    constexpr int MIN_GRID_HEIGHT = std::max(Game::DEFAULT_HEAD_POSITION.y, Game::DEFAULT_FOOD_POSITION.y) + 1;
+    /// 蛇身和占用表按格子数分配，限制边长，损坏的录像不会申请巨量内存
+    constexpr int MAX_GRID_SIZE = 1024;
+
+    [[nodiscard]] auto is_valid_grid(const int width, const int height) -> bool {
+        return width >= MIN_GRID_WIDTH && width <= MAX_GRID_SIZE && height >= MIN_GRID_HEIGHT &&
+               height <= MAX_GRID_SIZE;
+    }
+
+    /// 在第 step 步执行之前调用 Game::turn(dx, dy)
+    struct InputEvent {
+        std::uint64_t step;
+        int dx;
+        int dy;
+    };
+
+    /**
+     * 一局游戏的输入录像，文本格式：
+     *
+     *     # snake replay v1
+     *     seed 12345
+     *     grid 26 20
+     *     <step> <dx> <dy>
+     *     ...
+     */
+    struct Recording {
+        Uint64 seed = 0;
+        int grid_width = DEFAULT_GRID_WIDTH;
+        int grid_height = DEFAULT_GRID_HEIGHT;
+        std::vector<InputEvent> inputs;
+    };
+
+    auto save_recording(const std::filesystem::path &path, const Recording &recording) -> void {
+        std::ofstream file{path};
+        if (not file) {
+            throw std::runtime_error(std::format("Failed to open replay for writing: {}", path.string()));
+        }
+        file << "# snake replay v1\n";
+        file << "seed " << recording.seed << '\n';
+        file << "grid " << recording.grid_width << ' ' << recording.grid_height << '\n';
+        for (const auto &[step, dx, dy]: recording.inputs) {
+            file << step << ' ' << dx << ' ' << dy << '\n';
+        }
+    }
+
+    auto load_recording(const std::filesystem::path &path) -> Recording {
+        std::ifstream file{path};
+        if (not file) {
+            throw std::runtime_error(std::format("Failed to open replay: {}", path.string()));
+        }
+
+        Recording recording;
+        std::string line;
+        int line_number = 0;
+        while (std::getline(file, line)) {
+            ++line_number;
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+            std::istringstream stream{line};
+            bool valid;
+            if (line.starts_with("seed ")) {
+                std::string keyword;
+                valid = static_cast<bool>(stream >> keyword >> recording.seed);
+            }
+            else if (line.starts_with("grid ")) {
+                std::string keyword;
+                valid = static_cast<bool>(stream >> keyword >> recording.grid_width >> recording.grid_height);
+                if (valid and not is_valid_grid(recording.grid_width, recording.grid_height)) {
+                    throw std::runtime_error(std::format(
+                            "Invalid replay grid {}x{} on line {} in {}: must be between {}x{} and {}x{}",
+                            recording.grid_width, recording.grid_height, line_number, path.string(), MIN_GRID_WIDTH,
+                            MIN_GRID_HEIGHT, MAX_GRID_SIZE, MAX_GRID_SIZE));
+                }
+            }
+            else {
+                InputEvent input{};
+                valid = static_cast<bool>(stream >> input.step >> input.dx >> input.dy);
+                // 只允许上下左右四个单位方向
+                if (valid and std::abs(input.dx) + std::abs(input.dy) != 1) {
+                    throw std::runtime_error(std::format("Invalid replay direction ({}, {}) on line {} in {}",
+                                                         input.dx, input.dy, line_number, path.string()));
+                }
+                recording.inputs.push_back(input);
+            }
+            if (not valid) {
+                throw std::runtime_error(
+                        std::format("Invalid replay line {} in {}: {}", line_number, path.string(), line));
+            }
+        }
+        std::ranges::stable_sort(recording.inputs, {}, &InputEvent::step);
+        return recording;
+    }
+
+    /**
+     * 自动驾驶：沿覆盖整张网格的哈密顿回路前进，只要蛇没有占满网格就不会撞死
+     * 第 0 行向右走到底，然后从最右一列开始逐列上下蛇形往左，最后沿第 0 列回到起点
+     * 要求网格宽度为偶数，蛇头需要从回路上出发
+     */
+    auto hamiltonian_direction(const int x, const int y, const int width, const int height) -> Direction {
+        if (y == 0) {
+            return x < width - 1 ? Direction{1, 0} : Direction{0, 1};
+        }
+        if ((width - 1 - x) % 2 == 0) {
+            return y < height - 1 ? Direction{0, 1} : Direction{-1, 0};
+        }
+        if (y > 1 || x == 0) {
+            return {0, -1};
+        }
+        return {-1, 0};
+    }
+
+    /// 游戏状态的 FNV-1a 哈希：蛇身（蛇尾到蛇头）、方向、长度、食物、步数和随机数状态
+    auto hash_state(const Game &game) -> std::uint64_t {
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        const auto mix = [&hash](const std::uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                hash ^= (value >> (i * 8)) & 0xFF;
+                hash *= 0x100000001b3ULL;
+            }
+        };
+
+        const auto &registry = game.get_registry();
+        const auto &body = registry.get<SnakeBody>(game.get_snake());
+        mix(body.size());
+        for (const auto &segment: body.segments()) {
+            for (const auto &[x, y]: segment) {
+                mix(static_cast<std::uint32_t>(x));
+                mix(static_cast<std::uint32_t>(y));
+            }
+        }
+        const auto &[dx, dy] = registry.get<Direction>(game.get_snake());
+        mix(static_cast<std::uint32_t>(dx));
+        mix(static_cast<std::uint32_t>(dy));
+
+        // 食物在存储中的顺序取决于 group 排序，按坐标排序后再参与哈希
+        std::vector<std::pair<int, int>> food;
+        for (const auto [entity, position]: registry.view<Position, Food>().each()) {
+            food.emplace_back(position.y, position.x);
+        }
+        std::ranges::sort(food);
+        for (const auto &[y, x]: food) {
+            mix(static_cast<std::uint32_t>(x));
+            mix(static_cast<std::uint32_t>(y));
+        }
+
+        mix(static_cast<std::uint64_t>(game.get_snake_length()));
+        mix(game.get_step_count());
+        mix(game.get_rng_state());
+        return hash;
+    }
+
+    struct HeadlessOptions {
+        std::uint64_t steps = 1'000'000;
+        /// 为空时使用哈密顿回路自动驾驶
+        std::optional<Recording> recording;
+        Uint64 seed = 1;
+        int grid_width = DEFAULT_GRID_WIDTH;
+        int grid_height = DEFAULT_GRID_HEIGHT;
+    };
+
+    struct HeadlessResult {
+        std::uint64_t steps = 0;
+        std::uint64_t games = 0; ///< 蛇死亡后用同一个种子重新开局，这里统计开局次数
+        double seconds = 0.0;
+        std::uint64_t state_hash = 0;
+    };
+
+    /**
+     * 不创建窗口和渲染器，直接运行游戏逻辑 options.steps 步
+     * 有录像时按录像的种子、网格大小和输入重放，否则用自动驾驶；蛇死亡后重新开局继续计数
+     * 最终哈希混合了每一局结束时的状态，任何影响游戏逻辑的改动都会改变它
+     * 网格装不下起点和食物、或者自动驾驶时宽度为奇数，抛出异常
+     */
+    auto run_headless(const HeadlessOptions &options) -> HeadlessResult {
+        const auto seed = options.recording ? options.recording->seed : options.seed;
+        const auto width = options.recording ? options.recording->grid_width : options.grid_width;
+        const auto height = options.recording ? options.recording->grid_height : options.grid_height;
+        if (not is_valid_grid(width, height)) {
+            throw std::runtime_error(std::format("Invalid grid {}x{}: must be between {}x{} and {}x{}", width, height,
+                                                 MIN_GRID_WIDTH, MIN_GRID_HEIGHT, MAX_GRID_SIZE, MAX_GRID_SIZE));
+        }
+        if (not options.recording and width % 2 != 0) {
+            throw std::runtime_error(std::format("Autopilot needs an even grid width, got {}", width));
+        }
+        // 自动驾驶需要从哈密顿回路的起点出发
+        const Position start = options.recording ? Game::DEFAULT_HEAD_POSITION : Position{0, 0};
+
+        HeadlessResult result;
+        std::optional<Game> game;
+        game.emplace(width, height, seed, Game::INITIAL_LENGTH, start);
+        result.games = 1;
+        std::size_t next_input = 0;
+        std::uint64_t hash = 0;
+
+        const auto begin = std::chrono::steady_clock::now();
+        while (result.steps < options.steps) {
+            if (options.recording) {
+                const auto &inputs = options.recording->inputs;
+                while (next_input < inputs.size() && inputs[next_input].step <= game->get_step_count()) {
+                    game->turn(inputs[next_input].dx, inputs[next_input].dy);
+                    ++next_input;
+                }
+            }
+            else {
+                const auto &head = game->get_registry().get<SnakeBody>(game->get_snake()).head();
+                const auto [dx, dy] = hamiltonian_direction(head.x, head.y, width, height);
+                game->turn(dx, dy);
+            }
+
+            ++result.steps;
+            if (const auto step = game->step(); step == StepResult::HitWall || step == StepResult::HitSelf) {
+                hash ^= hash_state(*game) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+                game.emplace(width, height, seed, Game::INITIAL_LENGTH, start);
+                next_input = 0;
+                ++result.games;
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        result.state_hash = hash ^ hash_state(*game);
+        return result;
+    }
+} // namespace replay
@@ -1,6 +1,10 @@
 module;
 
+#include <array>
+#include <cstddef>
 #include <entt/entt.hpp>
+#include <span>
+#include <vector>
 
 export module snake;
 export struct Position {
@@ -8,10 +12,66 @@ export struct Position {
     int y;
 };
 
+/// 旧的蛇身表示：每节一个实体，每步 age - 1，减到 0 时销毁（基准测试中作为对照）
 export struct SnakeSegment {
     int age;
 };
 
+/**
+ * 蛇身：固定容量的环形缓冲区，从蛇尾到蛇头依次存放每一节的位置
+ * 整条蛇只是一个组件，前进一步就是 push_head + pop_tail，都是 O(1) 且不分配内存
+ */
+export class SnakeBody {
+public:
+    /// 容量一般取网格格子数，蛇不可能比网格更长
+    explicit SnakeBody(const std::size_t capacity) : cells(capacity) {}
+
+    /// 调用前需保证 size() < capacity()
+    auto push_head(const Position position) -> void {
+        cells[wrap(tail_index + count)] = position;
+        ++count;
+    }
+
+    /// 调用前需保证不为空
+    auto pop_tail() -> Position {
+        const auto position = cells[tail_index];
+        tail_index = wrap(tail_index + 1);
+        --count;
+        return position;
+    }
+
+    [[nodiscard]] auto head() const -> const Position & { return cells[wrap(tail_index + count - 1)]; }
+    [[nodiscard]] auto tail() const -> const Position & { return cells[tail_index]; }
+
+    /// 第 index 节，0 为蛇尾，size() - 1 为蛇头
+    [[nodiscard]] auto operator[](const std::size_t index) const -> const Position & {
+        return cells[wrap(tail_index + index)];
+    }
+
+    /// 按从蛇尾到蛇头的顺序返回两段连续内存（没有回绕时第二段为空）
+    [[nodiscard]] auto segments() const -> std::array<std::span<const Position>, 2> {
+        const std::span all{cells};
+        if (tail_index + count <= cells.size()) {
+            return {all.subspan(tail_index, count), {}};
+        }
+        const auto first = cells.size() - tail_index;
+        return {all.subspan(tail_index), all.first(count - first)};
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t { return count; }
+    [[nodiscard]] auto capacity() const -> std::size_t { return cells.size(); }
+    [[nodiscard]] auto empty() const -> bool { return count == 0; }
+
+private:
+    [[nodiscard]] auto wrap(const std::size_t index) const -> std::size_t {
+        return index >= cells.size() ? index - cells.size() : index;
+    }
+
+    std::vector<Position> cells;
+    std::size_t tail_index = 0;
+    std::size_t count = 0;
+};
+
 export struct Food {};
 
 export struct Direction {
@@ -0,0 +1,191 @@
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <entt/entt.hpp>
+#include <new>
+
+import snake;
+import snake.game;
+import snake.grid;
+import snake.replay;
+
+namespace {
+    constexpr int GRID_SIZE = 256; // 偶数，保证存在下面的哈密顿回路
+    constexpr int MEASURED_STEPS = 2000;
+
+    std::size_t allocation_count = 0;
+} // namespace
+
+// 统计测量区间内的堆分配次数
+auto operator new(const std::size_t size) -> void * {
+    ++allocation_count;
+    if (auto *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void *pointer) noexcept -> void { std::free(pointer); }
+auto operator delete(void *pointer, std::size_t) noexcept -> void { std::free(pointer); }
+
+namespace {
+    auto hamiltonian_direction(const int x, const int y) -> Direction {
+        return replay::hamiltonian_direction(x, y, GRID_SIZE, GRID_SIZE);
+    }
+
+    auto seconds_since(const std::chrono::steady_clock::time_point start) -> double {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct Measurement {
+        double ns_per_step;
+        double allocations_per_step;
+    };
+
+    template<typename Step>
+    auto measure(Step &&step) -> Measurement {
+        const auto allocations_before = allocation_count;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < MEASURED_STEPS; ++i) {
+            step();
+        }
+        return {
+                .ns_per_step = seconds_since(start) * 1e9 / MEASURED_STEPS,
+                .allocations_per_step =
+                        static_cast<double>(allocation_count - allocations_before) / MEASURED_STEPS,
+        };
+    }
+
+    /// 原先 handle_iteration 的蛇身做法：每步新建蛇头实体，所有蛇节 age - 1，到 0 的销毁
+    class LegacySnake {
+    public:
+        explicit LegacySnake(const int snake_length) : length(snake_length) {
+            const auto head = registry.create();
+            registry.emplace<Position>(head, 0, 0);
+            registry.emplace<SnakeSegment>(head, length);
+            registry.emplace<Direction>(head, 1, 0);
+            registry.emplace<SnakeHead>(head);
+        }
+
+        auto step() -> void {
+            auto head_view = registry.view<Position, Direction, SnakeHead>();
+            const auto old_head = head_view.front();
+            const auto old_pos = head_view.get<Position>(old_head);
+            const auto head_dir = hamiltonian_direction(old_pos.x, old_pos.y);
+            const Position next_pos = {old_pos.x + head_dir.dx, old_pos.y + head_dir.dy};
+
+            auto seg_view = registry.view<SnakeSegment>();
+            for (auto entity: seg_view) {
+                auto &seg = seg_view.get<SnakeSegment>(entity);
+                seg.age--;
+                if (seg.age <= 0) {
+                    registry.destroy(entity);
+                }
+            }
+
+            auto new_entity = registry.create();
+            registry.emplace<Position>(new_entity, next_pos);
+            registry.emplace<Direction>(new_entity, head_dir);
+            registry.emplace<SnakeSegment>(new_entity, length);
+            registry.emplace<SnakeHead>(new_entity);
+            registry.remove<Direction>(old_head);
+            registry.remove<SnakeHead>(old_head);
+        }
+
+        /// 原先的自身碰撞 + 食物检测：遍历所有蛇节
+        auto scan_collision(const Position next_pos) -> bool {
+            auto body_view = registry.view<Position, SnakeSegment>();
+            for (auto entity: body_view) {
+                const auto &body_pos = body_view.get<Position>(entity);
+                if (body_pos.x == next_pos.x && body_pos.y == next_pos.y) {
+                    return true;
+                }
+            }
+            auto food_view = registry.view<Position, Food>();
+            for (auto entity: food_view) {
+                if (const auto &food_pos = food_view.get<Position>(entity);
+                    food_pos.x == next_pos.x && food_pos.y == next_pos.y) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        entt::registry registry;
+        int length;
+    };
+
+    auto steer(Game &game) -> void {
+        const auto &head = game.get_registry().get<SnakeBody>(game.get_snake()).head();
+        const auto [dx, dy] = hamiltonian_direction(head.x, head.y);
+        game.turn(dx, dy);
+    }
+} // namespace
+
+/**
+ * 无头运行很长的蛇：每种表示先走够 length 步让蛇身长满，再测量每一步的耗时和堆分配次数
+ *  - legacy：每节一个实体 + age 递减
+ *  - ring：SnakeBody 环形缓冲区，只做 push_head + pop_tail
+ *  - game：完整的 Game::step（环形缓冲区 + 占用表碰撞检测 + 食物）
+ * 最后在同样长度的蛇上对比占用表查表与逐节扫描的碰撞检测
+ */
+auto main() -> int {
+    std::printf("%-8s %14s %14s %12s %12s %12s %12s %14s %14s\n", "length", "legacy ns", "legacy alloc",
+                "ring ns", "ring alloc", "game ns", "game alloc", "grid check ns", "scan check ns");
+    for (const int length: {1'000, 4'000, 16'000}) {
+        LegacySnake legacy{length};
+        for (int i = 0; i < length; ++i) {
+            legacy.step();
+        }
+        const auto legacy_result = measure([&] { legacy.step(); });
+
+        SnakeBody body{static_cast<std::size_t>(GRID_SIZE * GRID_SIZE)};
+        body.push_head({0, 0});
+        for (int i = 1; i < length; ++i) {
+            const auto &head = body.head();
+            const auto [dx, dy] = hamiltonian_direction(head.x, head.y);
+            body.push_head({head.x + dx, head.y + dy});
+        }
+        const auto ring_result = measure([&] {
+            const auto head = body.head();
+            const auto [dx, dy] = hamiltonian_direction(head.x, head.y);
+            body.push_head({head.x + dx, head.y + dy});
+            body.pop_tail();
+        });
+
+        Game game{GRID_SIZE, GRID_SIZE, 42, length, {0, 0}, {GRID_SIZE / 2, GRID_SIZE / 2}};
+        for (int i = 0; i < length; ++i) {
+            steer(game);
+            if (const auto result = game.step(); result == StepResult::HitWall || result == StepResult::HitSelf) {
+                std::fprintf(stderr, "Snake died during warm-up\n");
+                return 1;
+            }
+        }
+        const auto game_result = measure([&] {
+            steer(game);
+            game.step();
+        });
+
+        // 两种碰撞检测都查询蛇头正前方的格子
+        auto &registry = game.get_registry();
+        const auto &grid = registry.ctx().get<OccupancyGrid>();
+        const auto &head = registry.get<SnakeBody>(game.get_snake()).head();
+        const auto [dx, dy] = hamiltonian_direction(head.x, head.y);
+        const Position next_pos{head.x + dx, head.y + dy};
+        volatile bool hit = false;
+        const auto grid_result = measure([&] {
+            const auto occupant = grid.at(next_pos.x, next_pos.y);
+            hit = occupant != entt::null && not registry.all_of<Food>(occupant);
+        });
+        const auto scan_result = measure([&] { hit = legacy.scan_collision(next_pos); });
+
+        std::printf("%-8d %14.1f %14.2f %12.1f %12.2f %12.1f %12.2f %14.1f %14.1f\n", length,
+                    legacy_result.ns_per_step, legacy_result.allocations_per_step, ring_result.ns_per_step,
+                    ring_result.allocations_per_step, game_result.ns_per_step, game_result.allocations_per_step,
+                    grid_result.ns_per_step, scan_result.ns_per_step);
+    }
+    return 0;
+}
@@ -0,0 +1,476 @@
+module;
+#include <SDL3/SDL.h>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WOODENEYE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && not defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC / Clang 需要给使用 AVX2 指令的函数单独打开目标特性，MSVC 不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define WOODENEYE_TARGET(features) __attribute__((target(features)))
+#else
+#define WOODENEYE_TARGET(features)
+#endif
+
+export module woodeneye.edges;
+
+import app_runtime.render_stats;
+import woodeneye.trig;
+import woodeneye.types;
+
+export namespace edges {
+    /// 每个 SIMD 批次处理的边数（AVX2 一个寄存器 8 个 float），边数组按它补齐
+    constexpr std::size_t SIMD_LANES = 8;
+    constexpr std::size_t SIMD_ALIGNMENT = 64;
+
+    template<typename T>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        AlignedAllocator() = default;
+        template<typename U>
+        explicit AlignedAllocator(const AlignedAllocator<U> &) {}
+
+        auto allocate(const std::size_t count) -> T * {
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{SIMD_ALIGNMENT}));
+        }
+
+        auto deallocate(T *pointer, std::size_t) -> void {
+            ::operator delete(pointer, std::align_val_t{SIMD_ALIGNMENT});
+        }
+
+        template<typename U>
+        auto operator==(const AlignedAllocator<U> &) const -> bool {
+            return true;
+        }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    /**
+     * 地图边的 SoA 存储：每条边两个端点 a、b，坐标分开存放
+     * 数组长度补齐到 SIMD_LANES 的倍数，补齐出来的边两个端点重合在原点，投影后会被丢弃
+     */
+    struct EdgeBuffer {
+        AlignedVector<float> ax, ay, az;
+        AlignedVector<float> bx, by, bz;
+        std::size_t count = 0;
+
+        auto resize(const std::size_t edge_count) -> void {
+            count = edge_count;
+            const auto padded = padded_count();
+            for (auto *array: {&ax, &ay, &az, &bx, &by, &bz}) {
+                array->assign(padded, 0.0f);
+            }
+        }
+
+        auto set(const std::size_t index, const std::array<float, 3> &a, const std::array<float, 3> &b) -> void {
+            ax[index] = a[0];
+            ay[index] = a[1];
+            az[index] = a[2];
+            bx[index] = b[0];
+            by[index] = b[1];
+            bz[index] = b[2];
+        }
+
+        [[nodiscard]] auto padded_count() const -> std::size_t {
+            return (count + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;
+        }
+    };
+
+    /// 世界坐标到相机坐标的变换：先平移到相机位置，再乘以旋转矩阵（行优先）
+    struct Camera {
+        std::array<float, 9> mat;
+        float x, y, z;
+    };
+
+    /// 视口的投影参数：屏幕上的原点、焦距，以及近裁剪面 z = -near
+    struct Viewport {
+        float origin_x;
+        float origin_y;
+        float focal;
+        float near = 1.0f;
+    };
+
+    /**
+     * 投影的中间结果：每条边在屏幕上的两个端点、展开成四边形用的半像素法线和是否可见
+     * 作为调用方持有的暂存区反复使用，避免每帧分配
+     */
+    struct ProjectedEdges {
+        AlignedVector<float> x0, y0, x1, y1;
+        AlignedVector<float> nx, ny;
+        /// 全 1 表示可见，0 表示整条边都在近裁剪面后面，或者投影后长度为 0
+        AlignedVector<std::uint32_t> visible;
+
+        auto resize(const std::size_t padded) -> void {
+            for (auto *array: {&x0, &y0, &x1, &y1, &nx, &ny}) {
+                if (array->size() < padded) {
+                    array->resize(padded);
+                }
+            }
+            if (visible.size() < padded) {
+                visible.resize(padded);
+            }
+        }
+    };
+
+    /**
+     * 一个视口内所有线段的绘制批次
+     * SDL_RenderLines 画的是首尾相连的折线，没法一次画互不相连的线段，
+     * 所以把每条线段展开成 1 像素宽的四边形，整批用一次 SDL_RenderGeometryRaw 提交
+     * 批次内所有线段同一种颜色，颜色步长为 0，顶点只存坐标
+     */
+    class LineBatch {
+    public:
+        auto clear() -> void { segment_count = 0; }
+
+        /// 坐标和索引数组只增不减，稳定之后每帧不再分配
+        auto reserve(const std::size_t segments) -> void {
+            if (xy.size() < segments * 8) {
+                xy.resize(segments * 8);
+            }
+            grow_indices(segments);
+        }
+
+        auto set_color(const Uint8 r, const Uint8 g, const Uint8 b, const Uint8 a = SDL_ALPHA_OPAQUE) -> void {
+            color = {static_cast<float>(r) / 255.0f, static_cast<float>(g) / 255.0f, static_cast<float>(b) / 255.0f,
+                     static_cast<float>(a) / 255.0f};
+        }
+
+        auto add(const float x0, const float y0, const float x1, const float y1) -> void {
+            const auto dx = x1 - x0;
+            const auto dy = y1 - y0;
+            const auto length = std::sqrt(dx * dx + dy * dy);
+            if (length <= 0.0f) {
+                return;
+            }
+            // 沿半个像素长的法线向两侧展开
+            const auto nx = -dy * (0.5f / length);
+            const auto ny = dx * (0.5f / length);
+            reserve(segment_count + 1);
+            auto *quad = &xy[segment_count * 8];
+            quad[0] = x0 + nx;
+            quad[1] = y0 + ny;
+            quad[2] = x0 - nx;
+            quad[3] = y0 - ny;
+            quad[4] = x1 + nx;
+            quad[5] = y1 + ny;
+            quad[6] = x1 - nx;
+            quad[7] = y1 - ny;
+            ++segment_count;
+        }
+
+        /**
+         * 追加 projected 前 count 条边中可见的部分
+         * 每条边都无条件写入，只有可见时才前移写指针，循环里没有分支
+         */
+        auto append(const ProjectedEdges &projected, const std::size_t count) -> void {
+            reserve(segment_count + count);
+            auto *quad = &xy[segment_count * 8];
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto x0 = projected.x0[i];
+                const auto y0 = projected.y0[i];
+                const auto x1 = projected.x1[i];
+                const auto y1 = projected.y1[i];
+                const auto nx = projected.nx[i];
+                const auto ny = projected.ny[i];
+                quad[0] = x0 + nx;
+                quad[1] = y0 + ny;
+                quad[2] = x0 - nx;
+                quad[3] = y0 - ny;
+                quad[4] = x1 + nx;
+                quad[5] = y1 + ny;
+                quad[6] = x1 - nx;
+                quad[7] = y1 - ny;
+                quad += projected.visible[i] & 8;
+            }
+            segment_count = static_cast<std::size_t>(quad - xy.data()) / 8;
+        }
+
+        /// 一次 SDL_RenderGeometryRaw 画出批次中的所有线段
+        auto submit(SDL_Renderer *renderer) const -> bool {
+            if (segment_count == 0) {
+                return true;
+            }
+            return app_runtime::render_geometry_raw(renderer, nullptr, xy.data(), 2 * sizeof(float), &color, 0,
+                                                    nullptr, 0, static_cast<int>(segment_count * 4), indices.data(),
+                                                    static_cast<int>(segment_count * 6), sizeof(int));
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t { return segment_count; }
+
+    private:
+        /// 每个四边形的索引都是同一个模式，只在线段数增长时补齐
+        auto grow_indices(const std::size_t segments) -> void {
+            for (auto i = indices.size() / 6; i < segments; ++i) {
+                const auto base = static_cast<int>(i * 4);
+                indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+            }
+        }
+
+        std::vector<float> xy;
+        std::vector<int> indices;
+        std::size_t segment_count = 0;
+        SDL_FColor color{1.0f, 1.0f, 1.0f, 1.0f};
+    };
+
+    enum class Backend {
+        Scalar,
+        Avx2,
+    };
+
+    auto is_backend_supported(Backend backend) -> bool;
+    auto best_backend() -> Backend;
+
+    /// 地图的边：外框 12 条棱，加上地面上两个方向各 scale 条网格线，坐标范围 [-scale, scale]
+    auto build_map_edges(int scale) -> EdgeBuffer;
+
+    /// 由玩家二进制角度的 yaw / pitch 和眼睛位置构造相机
+    auto make_camera(const Player &player, const std::array<float, 3> &eye) -> Camera;
+
+    /**
+     * 把所有边变换到相机坐标、裁剪到近裁剪面并透视投影，可见的线段追加到 batch
+     * 与原先逐条边调用 drawClippedSegment 的结果在浮点舍入范围内一致
+     */
+    auto project_edges(const EdgeBuffer &edges, const Camera &camera, const Viewport &viewport,
+                       ProjectedEdges &scratch, LineBatch &batch, Backend backend = best_backend()) -> void;
+} // namespace edges
+
+namespace edges {
+    auto is_backend_supported(const Backend backend) -> bool {
+#if defined(WOODENEYE_X86)
+        if (backend == Backend::Avx2) {
+#if defined(__GNUC__) || defined(__clang__)
+            static const bool avx2 = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+#else
+            static const bool avx2 = [] {
+                int info[4]{};
+                __cpuid(info, 1);
+                const bool osxsave = (info[2] & (1 << 27)) != 0;
+                __cpuidex(info, 7, 0);
+                return osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            }();
+#endif
+            return avx2;
+        }
+        return true;
+#else
+        return backend == Backend::Scalar;
+#endif
+    }
+
+    auto best_backend() -> Backend { return is_backend_supported(Backend::Avx2) ? Backend::Avx2 : Backend::Scalar; }
+
+    auto build_map_edges(const int scale) -> EdgeBuffer {
+        EdgeBuffer buffer;
+        buffer.resize(static_cast<std::size_t>(12 + scale * 2));
+
+        const auto r = static_cast<float>(scale);
+        // 外框的 12 条棱，每个数字的三个二进制位分别表示顶点在 x / y / z 上取正还是取负
+        constexpr int map[24] = {
+            0, 1, 1, 3, 3, 2, 2, 0,
+            7, 6, 6, 4, 4, 5, 5, 7,
+            6, 2, 3, 7, 0, 4, 5, 1
+        };
+        for (int i = 0; i < 12; i++) {
+            std::array<float, 3> a{};
+            std::array<float, 3> b{};
+            for (int j = 0; j < 3; j++) {
+                a[j] = map[i * 2 + 0] & (1 << j) ? r : -r;
+                b[j] = map[i * 2 + 1] & (1 << j) ? r : -r;
+            }
+            buffer.set(i, a, b);
+        }
+        // 地面网格
+        for (int i = 0; i < scale; i++) {
+            const auto d = static_cast<float>(i * 2);
+            buffer.set(i + 12, {-r, -r, d - r}, {r, -r, d - r});
+            buffer.set(i + 12 + scale, {d - r, -r, -r}, {d - r, -r, r});
+        }
+        return buffer;
+    }
+
+    auto make_camera(const Player &player, const std::array<float, 3> &eye) -> Camera {
+        const auto [sin_yaw, cos_yaw] = trig::sincos(player.yaw);
+        const auto [sin_pitch, cos_pitch] = trig::sincos(static_cast<std::uint32_t>(player.pitch));
+
+        Camera camera{};
+        camera.mat = {
+            cos_yaw, 0, -sin_yaw,
+            sin_yaw * sin_pitch, cos_pitch, cos_yaw * sin_pitch,
+            sin_yaw * cos_pitch, -sin_pitch, cos_yaw * cos_pitch
+        };
+        camera.x = eye[0];
+        camera.y = eye[1];
+        camera.z = eye[2];
+        return camera;
+    }
+
+    /**
+     * 标量版本，逐条边执行与 AVX2 版本完全相同的运算顺序
+     * 两个端点都在近裁剪面后面时不可见；只有一个在后面时把它沿线段移到近裁剪面上
+     */
+    auto project_scalar(const EdgeBuffer &edges, const Camera &camera, const Viewport &viewport,
+                        ProjectedEdges &out) -> void {
+        const auto &m = camera.mat;
+        const auto near = -viewport.near;
+        for (std::size_t i = 0; i < edges.padded_count(); ++i) {
+            const auto rax = edges.ax[i] - camera.x;
+            const auto ray = edges.ay[i] - camera.y;
+            const auto raz = edges.az[i] - camera.z;
+            const auto rbx = edges.bx[i] - camera.x;
+            const auto rby = edges.by[i] - camera.y;
+            const auto rbz = edges.bz[i] - camera.z;
+            auto ax = m[0] * rax + m[1] * ray + m[2] * raz;
+            auto ay = m[3] * rax + m[4] * ray + m[5] * raz;
+            auto az = m[6] * rax + m[7] * ray + m[8] * raz;
+            auto bx = m[0] * rbx + m[1] * rby + m[2] * rbz;
+            auto by = m[3] * rbx + m[4] * rby + m[5] * rbz;
+            auto bz = m[6] * rbx + m[7] * rby + m[8] * rbz;
+
+            const bool visible = az < near || bz < near;
+            if (az > near) {
+                const auto t = (near - bz) / (az - bz);
+                ax = bx + (ax - bx) * t;
+                ay = by + (ay - by) * t;
+                az = near;
+            }
+            else if (bz > near) {
+                const auto t = (near - az) / (bz - az);
+                bx = ax + (bx - ax) * t;
+                by = ay + (by - ay) * t;
+                bz = near;
+            }
+            const auto scale_a = viewport.focal / az;
+            const auto scale_b = viewport.focal / bz;
+            const auto x0 = viewport.origin_x - ax * scale_a;
+            const auto y0 = viewport.origin_y + ay * scale_a;
+            const auto x1 = viewport.origin_x - bx * scale_b;
+            const auto y1 = viewport.origin_y + by * scale_b;
+
+            const auto dx = x1 - x0;
+            const auto dy = y1 - y0;
+            const auto length_squared = dx * dx + dy * dy;
+            const auto half_inv_length = 0.5f / std::sqrt(length_squared);
+            out.x0[i] = x0;
+            out.y0[i] = y0;
+            out.x1[i] = x1;
+            out.y1[i] = y1;
+            out.nx[i] = -dy * half_inv_length;
+            out.ny[i] = dx * half_inv_length;
+            out.visible[i] = visible && length_squared > 0.0f ? UINT32_MAX : 0;
+        }
+    }
+
+#if defined(WOODENEYE_X86)
+    /// 相机矩阵的第 row 行乘以 (x, y, z)
+    WOODENEYE_TARGET("avx2")
+    auto transform_row(const __m256 (&m)[9], const __m256 x, const __m256 y, const __m256 z, const int row)
+            -> __m256 {
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[row * 3 + 0], x), _mm256_mul_ps(m[row * 3 + 1], y)),
+                             _mm256_mul_ps(m[row * 3 + 2], z));
+    }
+
+    WOODENEYE_TARGET("avx2")
+    auto project_avx2(const EdgeBuffer &edges, const Camera &camera, const Viewport &viewport,
+                      ProjectedEdges &out) -> void {
+        __m256 m[9];
+        for (int i = 0; i < 9; ++i) {
+            m[i] = _mm256_set1_ps(camera.mat[i]);
+        }
+        const auto cx = _mm256_set1_ps(camera.x);
+        const auto cy = _mm256_set1_ps(camera.y);
+        const auto cz = _mm256_set1_ps(camera.z);
+        const auto near = _mm256_set1_ps(-viewport.near);
+        const auto focal = _mm256_set1_ps(viewport.focal);
+        const auto origin_x = _mm256_set1_ps(viewport.origin_x);
+        const auto origin_y = _mm256_set1_ps(viewport.origin_y);
+        const auto half = _mm256_set1_ps(0.5f);
+        const auto zero = _mm256_setzero_ps();
+        const auto sign_mask = _mm256_set1_ps(-0.0f);
+
+        for (std::size_t i = 0; i < edges.padded_count(); i += SIMD_LANES) {
+            const auto rax = _mm256_sub_ps(_mm256_load_ps(&edges.ax[i]), cx);
+            const auto ray = _mm256_sub_ps(_mm256_load_ps(&edges.ay[i]), cy);
+            const auto raz = _mm256_sub_ps(_mm256_load_ps(&edges.az[i]), cz);
+            const auto rbx = _mm256_sub_ps(_mm256_load_ps(&edges.bx[i]), cx);
+            const auto rby = _mm256_sub_ps(_mm256_load_ps(&edges.by[i]), cy);
+            const auto rbz = _mm256_sub_ps(_mm256_load_ps(&edges.bz[i]), cz);
+            auto ax = transform_row(m, rax, ray, raz, 0);
+            auto ay = transform_row(m, rax, ray, raz, 1);
+            auto az = transform_row(m, rax, ray, raz, 2);
+            auto bx = transform_row(m, rbx, rby, rbz, 0);
+            auto by = transform_row(m, rbx, rby, rbz, 1);
+            auto bz = transform_row(m, rbx, rby, rbz, 2);
+
+            const auto visible = _mm256_or_ps(_mm256_cmp_ps(az, near, _CMP_LT_OQ), _mm256_cmp_ps(bz, near, _CMP_LT_OQ));
+            // 两种裁剪都算出来再按掩码选择；不需要裁剪的通道里的除法结果会被丢弃
+            const auto clip_a = _mm256_cmp_ps(az, near, _CMP_GT_OQ);
+            const auto clip_b = _mm256_andnot_ps(clip_a, _mm256_cmp_ps(bz, near, _CMP_GT_OQ));
+            const auto ta = _mm256_div_ps(_mm256_sub_ps(near, bz), _mm256_sub_ps(az, bz));
+            const auto tb = _mm256_div_ps(_mm256_sub_ps(near, az), _mm256_sub_ps(bz, az));
+            const auto clipped_ax = _mm256_add_ps(bx, _mm256_mul_ps(_mm256_sub_ps(ax, bx), ta));
+            const auto clipped_ay = _mm256_add_ps(by, _mm256_mul_ps(_mm256_sub_ps(ay, by), ta));
+            const auto clipped_bx = _mm256_add_ps(ax, _mm256_mul_ps(_mm256_sub_ps(bx, ax), tb));
+            const auto clipped_by = _mm256_add_ps(ay, _mm256_mul_ps(_mm256_sub_ps(by, ay), tb));
+            ax = _mm256_blendv_ps(ax, clipped_ax, clip_a);
+            ay = _mm256_blendv_ps(ay, clipped_ay, clip_a);
+            az = _mm256_blendv_ps(az, near, clip_a);
+            bx = _mm256_blendv_ps(bx, clipped_bx, clip_b);
+            by = _mm256_blendv_ps(by, clipped_by, clip_b);
+            bz = _mm256_blendv_ps(bz, near, clip_b);
+
+            const auto scale_a = _mm256_div_ps(focal, az);
+            const auto scale_b = _mm256_div_ps(focal, bz);
+            const auto x0 = _mm256_sub_ps(origin_x, _mm256_mul_ps(ax, scale_a));
+            const auto y0 = _mm256_add_ps(origin_y, _mm256_mul_ps(ay, scale_a));
+            const auto x1 = _mm256_sub_ps(origin_x, _mm256_mul_ps(bx, scale_b));
+            const auto y1 = _mm256_add_ps(origin_y, _mm256_mul_ps(by, scale_b));
+
+            const auto dx = _mm256_sub_ps(x1, x0);
+            const auto dy = _mm256_sub_ps(y1, y0);
+            const auto length_squared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            const auto half_inv_length = _mm256_div_ps(half, _mm256_sqrt_ps(length_squared));
+            _mm256_store_ps(&out.x0[i], x0);
+            _mm256_store_ps(&out.y0[i], y0);
+            _mm256_store_ps(&out.x1[i], x1);
+            _mm256_store_ps(&out.y1[i], y1);
+            _mm256_store_ps(&out.nx[i], _mm256_mul_ps(_mm256_xor_ps(dy, sign_mask), half_inv_length));
+            _mm256_store_ps(&out.ny[i], _mm256_mul_ps(dx, half_inv_length));
+            const auto drawn = _mm256_and_ps(visible, _mm256_cmp_ps(length_squared, zero, _CMP_GT_OQ));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(&out.visible[i]), _mm256_castps_si256(drawn));
+        }
+    }
+#endif
+
+    auto project_edges(const EdgeBuffer &edges, const Camera &camera, const Viewport &viewport,
+                       ProjectedEdges &scratch, LineBatch &batch, const Backend backend) -> void {
+        scratch.resize(edges.padded_count());
+#if defined(WOODENEYE_X86)
+        if (backend == Backend::Avx2 && is_backend_supported(Backend::Avx2)) {
+            project_avx2(edges, camera, viewport, scratch);
+        }
+        else {
+            project_scalar(edges, camera, viewport, scratch);
+        }
+#else
+        project_scalar(edges, camera, viewport, scratch);
+#endif
+        // 只压缩可见的线段进批次，补齐出来的边不参与
+        batch.append(scratch, edges.count);
+    }
+} // namespace edges
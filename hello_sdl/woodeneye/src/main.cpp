@@ -1,14 +1,44 @@
 #define SDL_MAIN_USE_CALLBACKS 1
 
 #include <memory>
+#include <string_view>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
 import woodeneye.application;
+import woodeneye.pacing;
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
+    // --bots N：加入 N 个机器人
+    // --pacing uncapped|fixed|vsync|fixed-step：帧节奏模式，默认 fixed
+    // --hz N：fixed 和 fixed-step 模式的渲染帧率上限，默认 1000
+    // --step-hz N：fixed-step 模式每秒的模拟步数，默认 120
+    int bot_count = 0;
+    pacing::Config pacing_config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument{argv[i]};
+        if (argument == "--bots" && i + 1 < argc) {
+            bot_count = SDL_max(SDL_atoi(argv[++i]), 0);
+        }
+        else if (argument == "--pacing" && i + 1 < argc) {
+            const auto mode = pacing::parse_mode(argv[++i]);
+            if (not mode) {
+                SDL_Log("Unknown pacing mode: %s", argv[i]);
+                return SDL_APP_FAILURE;
+            }
+            pacing_config.mode = *mode;
+        }
+        else if (argument == "--hz" && i + 1 < argc) {
+            pacing_config.target_hz = SDL_max(SDL_atof(argv[++i]), 1.0);
+        }
+        else if (argument == "--step-hz" && i + 1 < argc) {
+            pacing_config.step_ns = static_cast<Uint64>(static_cast<double>(SDL_NS_PER_SECOND) /
+                                                        SDL_max(SDL_atof(argv[++i]), 1.0));
+        }
+    }
+
     try {
-        auto application = std::make_unique<Application>("wooden_eye", 640, 480);
+        auto application = std::make_unique<Application>("wooden_eye", 640, 480, bot_count, pacing_config);
         *appstate = application.release();
     }
     catch (const std::exception &e) {
@@ -0,0 +1,228 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module woodeneye.pacing;
+
+import app_runtime.fixed_timestep;
+
+export namespace pacing {
+    enum class Mode {
+        /// 不等待，渲染完立刻开始下一帧
+        Uncapped,
+        /// 按 target_hz 的固定帧率，先睡眠再自旋等到下一帧的截止时间
+        FixedRate,
+        /// 交给渲染器的垂直同步，SDL_RenderPresent 阻塞到下一次刷新
+        VSync,
+        /// 模拟按 step_ns 固定步长推进，与渲染解耦；渲染仍按 target_hz 限制帧率
+        FixedStep,
+    };
+
+    [[nodiscard]] auto to_string(Mode mode) -> std::string_view;
+    [[nodiscard]] auto parse_mode(std::string_view name) -> std::optional<Mode>;
+
+    struct Config {
+        Mode mode = Mode::FixedRate;
+        double target_hz = 1000.0;
+        Uint64 step_ns = SDL_NS_PER_SECOND / 120;
+        int max_catch_up_steps = 5;
+    };
+
+    /// 这一帧要推进的模拟：steps 步，每步 step_ns
+    struct Frame {
+        int steps;
+        Uint64 step_ns;
+    };
+
+    /// 最近一个统计窗口内的帧间隔，单位毫秒
+    struct FrameStats {
+        double fps = 0.0;
+        double p50_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+    };
+
+    /**
+     * 帧节奏控制：
+     * - begin_frame() 在帧开始时调用，记录上一帧的间隔，返回这一帧要推进的模拟步数和步长
+     * - end_frame() 在 SDL_RenderPresent 之后调用，按模式等待到下一帧
+     * 固定帧率的等待用绝对截止时间，不会因为每帧的误差累积而漂移；
+     * SDL_DelayNS 醒来的时间不精确，所以离截止时间还剩 spin_margin 时就改为自旋，
+     * spin_margin 按观测到的睡眠超时自适应调整，睡眠越准自旋越少；它最多占一帧间隔的一半，
+     * 保证每帧至少睡掉半帧，不会因为一次醒得晚就变成整帧自旋
+     * 帧间隔统计每秒更新一次，报告 p50 / p99 / max
+     */
+    class FramePacer {
+    public:
+        /// 统计窗口最多保留的帧数，不限帧率时超出的帧只计入帧数和最大值
+        static constexpr std::size_t MAX_SAMPLES = 8192;
+        static constexpr Uint64 MIN_SPIN_MARGIN_NS = 200 * SDL_NS_PER_US;
+        static constexpr Uint64 MAX_SPIN_MARGIN_NS = 4 * SDL_NS_PER_MS;
+
+        explicit FramePacer(const Config &config);
+
+        /// 按模式打开或关闭渲染器的垂直同步
+        auto apply(SDL_Renderer *renderer) const -> void;
+
+        auto begin_frame() -> Frame;
+        auto end_frame() -> void;
+
+        [[nodiscard]] auto get_mode() const -> Mode { return config.mode; }
+        [[nodiscard]] auto get_stats() const -> const FrameStats & { return stats; }
+        [[nodiscard]] auto get_spin_margin_ns() const -> Uint64 { return spin_margin_ns; }
+        /// 统计数据每秒更新一次，更新后返回 true 一次
+        auto consume_stats_update() -> bool { return std::exchange(stats_updated, false); }
+
+        /// 睡眠加自旋，一直等到 SDL_GetTicksNS() >= deadline_ns
+        auto wait_until(Uint64 deadline_ns) -> void;
+
+    private:
+        auto record(Uint64 interval_ns) -> void;
+        auto update_stats(Uint64 now) -> void;
+
+        const Config config;
+        const Uint64 frame_interval_ns;
+        Uint64 next_deadline_ns = 0;
+        Uint64 last_frame_ns = 0;
+        /// FixedStep 模式的步数累加器，其他模式不使用
+        app_runtime::FixedTimestep timestep;
+        /// spin_margin 的上限：MAX_SPIN_MARGIN_NS 与半个帧间隔中较小的一个
+        const Uint64 max_spin_margin_ns;
+        Uint64 spin_margin_ns = MIN_SPIN_MARGIN_NS;
+
+        Uint64 stats_start_ns = 0;
+        std::vector<Uint64> samples;
+        std::uint64_t window_frames = 0;
+        Uint64 window_max_ns = 0;
+        FrameStats stats;
+        bool stats_updated = false;
+    };
+} // namespace pacing
+
+namespace pacing {
+    auto to_string(const Mode mode) -> std::string_view {
+        switch (mode) {
+            case Mode::Uncapped:
+                return "uncapped";
+            case Mode::FixedRate:
+                return "fixed";
+            case Mode::VSync:
+                return "vsync";
+            case Mode::FixedStep:
+                return "fixed-step";
+        }
+        return "unknown";
+    }
+
+    auto parse_mode(const std::string_view name) -> std::optional<Mode> {
+        for (const auto mode: {Mode::Uncapped, Mode::FixedRate, Mode::VSync, Mode::FixedStep}) {
+            if (to_string(mode) == name) {
+                return mode;
+            }
+        }
+        return std::nullopt;
+    }
+
+    FramePacer::FramePacer(const Config &config) :
+        config(config),
+        frame_interval_ns(static_cast<Uint64>(static_cast<double>(SDL_NS_PER_SECOND) /
+                                              std::max(config.target_hz, 1.0))),
+        timestep(config.step_ns, config.max_catch_up_steps),
+        max_spin_margin_ns(std::clamp(frame_interval_ns / 2, MIN_SPIN_MARGIN_NS, MAX_SPIN_MARGIN_NS)) {
+        samples.reserve(MAX_SAMPLES);
+    }
+
+    auto FramePacer::apply(SDL_Renderer *renderer) const -> void {
+        SDL_SetRenderVSync(renderer, config.mode == Mode::VSync ? 1 : 0);
+    }
+
+    auto FramePacer::begin_frame() -> Frame {
+        const auto now = SDL_GetTicksNS();
+        if (last_frame_ns == 0) {
+            last_frame_ns = now;
+            stats_start_ns = now;
+            next_deadline_ns = now;
+            return {0, config.step_ns};
+        }
+        const auto elapsed_ns = now - last_frame_ns;
+        last_frame_ns = now;
+        record(elapsed_ns);
+        update_stats(now);
+
+        if (config.mode != Mode::FixedStep) {
+            return {1, elapsed_ns};
+        }
+        return {timestep.advance(elapsed_ns), config.step_ns};
+    }
+
+    auto FramePacer::end_frame() -> void {
+        if (config.mode == Mode::Uncapped || config.mode == Mode::VSync) {
+            return;
+        }
+        next_deadline_ns += frame_interval_ns;
+        const auto now = SDL_GetTicksNS();
+        // 落后超过一帧（例如窗口被拖动）时从现在重新排期，不连续补帧
+        if (next_deadline_ns + frame_interval_ns < now) {
+            next_deadline_ns = now;
+            return;
+        }
+        wait_until(next_deadline_ns);
+    }
+
+    auto FramePacer::wait_until(const Uint64 deadline_ns) -> void {
+        auto now = SDL_GetTicksNS();
+        if (now + spin_margin_ns < deadline_ns) {
+            const auto requested_ns = deadline_ns - spin_margin_ns - now;
+            SDL_DelayNS(requested_ns);
+            const auto after = SDL_GetTicksNS();
+            const auto overshoot_ns = after - now > requested_ns ? after - now - requested_ns : 0;
+            // 超时变大时立刻跟上，变小时慢慢收缩，避免偶尔一次睡得准就自旋不够
+            spin_margin_ns = std::clamp(std::max(overshoot_ns * 2, spin_margin_ns - spin_margin_ns / 16),
+                                        MIN_SPIN_MARGIN_NS, max_spin_margin_ns);
+            now = after;
+        }
+        else {
+            // 这一帧没有睡眠就观测不到超时，同样慢慢收缩，否则 spin_margin 变大后再也回不来
+            spin_margin_ns = std::max(spin_margin_ns - spin_margin_ns / 16, MIN_SPIN_MARGIN_NS);
+        }
+        while (now < deadline_ns) {
+            now = SDL_GetTicksNS();
+        }
+    }
+
+    auto FramePacer::record(const Uint64 interval_ns) -> void {
+        ++window_frames;
+        window_max_ns = std::max(window_max_ns, interval_ns);
+        if (samples.size() < MAX_SAMPLES) {
+            samples.push_back(interval_ns);
+        }
+    }
+
+    auto FramePacer::update_stats(const Uint64 now) -> void {
+        const auto elapsed_ns = now - stats_start_ns;
+        if (elapsed_ns < SDL_NS_PER_SECOND || samples.empty()) {
+            return;
+        }
+        const auto percentile = [this](const double fraction) {
+            const auto index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+            std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(index));
+            return static_cast<double>(samples[index]) / static_cast<double>(SDL_NS_PER_MS);
+        };
+        stats.fps = static_cast<double>(window_frames) * static_cast<double>(SDL_NS_PER_SECOND) /
+                    static_cast<double>(elapsed_ns);
+        stats.p50_ms = percentile(0.50);
+        stats.p99_ms = percentile(0.99);
+        stats.max_ms = static_cast<double>(window_max_ns) / static_cast<double>(SDL_NS_PER_MS);
+        samples.clear();
+        window_frames = 0;
+        window_max_ns = 0;
+        stats_start_ns = now;
+        stats_updated = true;
+    }
+} // namespace pacing
@@ -0,0 +1,226 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WOODENEYE_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC / Clang 需要给使用 AVX2 指令的函数单独打开目标特性，MSVC 不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define WOODENEYE_TARGET(features) __attribute__((target(features)))
+#else
+#define WOODENEYE_TARGET(features)
+#endif
+
+export module woodeneye.physics;
+
+import woodeneye.edges;
+import woodeneye.trig;
+import woodeneye.types;
+
+export namespace physics {
+    constexpr double DRAG_RATE = 6.0;
+    constexpr double THRUST = 60.0;
+    constexpr double GRAVITY = 25.0;
+    /// 按住空格落地时获得的向上速度
+    constexpr float JUMP_SPEED = 8.4375f;
+
+    /**
+     * 所有玩家的物理状态，按 SoA 存放成 float 数组，与输入设备、颜色等冷数据分开
+     * 下标与 World 里的玩家槽位一一对应
+     */
+    struct Bodies {
+        edges::AlignedVector<float> x, y, z;
+        edges::AlignedVector<float> vx, vy, vz;
+        /// 本帧的输入：水平方向的单位推力，以及落地时的起跳速度（没按空格为 0）
+        edges::AlignedVector<float> thrust_x, thrust_z, jump;
+        edges::AlignedVector<float> radius, height;
+
+        auto resize(const std::size_t count) -> void {
+            for (auto *array: {&x, &y, &z, &vx, &vy, &vz, &thrust_x, &thrust_z, &jump, &radius, &height}) {
+                array->assign(count, 0.0f);
+            }
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t { return x.size(); }
+
+        [[nodiscard]] auto position(const std::size_t index) const -> std::array<float, 3> {
+            return {x[index], y[index], z[index]};
+        }
+    };
+
+    /**
+     * 只和帧间隔有关的常量，每帧算一次，所有物体共用
+     * 用 double 按原先的公式算好再转成 float，积分时每个物体只剩乘加
+     */
+    struct Step {
+        float time;
+        float keep;          ///< 水平速度经过阻尼后保留的比例
+        float velocity_gain; ///< 单位推力带来的速度增量
+        float position_gain; ///< 单位推力带来的位移
+        float carry;         ///< 初速度带来的位移比例
+        float fall_speed;    ///< 重力带来的速度减量
+        float fall_distance; ///< 重力带来的位移
+    };
+
+    auto make_step(Uint64 dt_ns) -> Step;
+
+    /// 由玩家朝向和按键算出本帧的推力方向和起跳速度
+    auto set_input(Bodies &bodies, std::size_t index, unsigned int yaw, unsigned char wasd) -> void;
+
+    /// 对 [begin, end) 范围内的玩家批量调用 set_input，players 与 bodies 的下标一致
+    auto set_inputs(Bodies &bodies, std::span<const Player> players, std::size_t begin, std::size_t end) -> void;
+
+    /// 积分 [begin, end) 范围内的物体，并把它们限制在场地里
+    auto integrate(Bodies &bodies, const Step &step, std::size_t begin, std::size_t end,
+                   edges::Backend backend = edges::best_backend()) -> void;
+} // namespace physics
+
+namespace physics {
+    auto make_step(const Uint64 dt_ns) -> Step {
+        const double time = static_cast<double>(dt_ns) * 1e-9;
+        const double drag = std::exp(-time * DRAG_RATE);
+        const double diff = 1.0 - drag;
+        return {
+            .time = static_cast<float>(time),
+            .keep = static_cast<float>(drag),
+            .velocity_gain = static_cast<float>(diff * THRUST / DRAG_RATE),
+            .position_gain = static_cast<float>((time - diff / DRAG_RATE) * THRUST / DRAG_RATE),
+            .carry = static_cast<float>(diff / DRAG_RATE),
+            .fall_speed = static_cast<float>(GRAVITY * time),
+            .fall_distance = static_cast<float>(-0.5 * GRAVITY * time * time),
+        };
+    }
+
+    /// 按键组合在玩家自身坐标下的单位移动方向和起跳速度
+    struct Intent {
+        float x, z, jump;
+    };
+
+    /// 以 wasd 的 5 位为下标，把方向归一化和起跳判断都提前到编译期
+    constexpr auto INTENTS = [] {
+        std::array<Intent, 32> intents{};
+        for (unsigned int wasd = 0; wasd < intents.size(); ++wasd) {
+            const float dir_x = (wasd & 8 ? 1.0f : 0.0f) - (wasd & 2 ? 1.0f : 0.0f);
+            const float dir_z = (wasd & 4 ? 1.0f : 0.0f) - (wasd & 1 ? 1.0f : 0.0f);
+            // 方向只可能是 0、轴向或对角线
+            const float inv_length = dir_x == 0 && dir_z == 0 ? 0.0f
+                                     : dir_x == 0 || dir_z == 0 ? 1.0f
+                                                                : 1.0f / std::numbers::sqrt2_v<float>;
+            intents[wasd] = {dir_x * inv_length, dir_z * inv_length, wasd & 16 ? JUMP_SPEED : 0.0f};
+        }
+        return intents;
+    }();
+
+    auto set_input(Bodies &bodies, const std::size_t index, const unsigned int yaw, const unsigned char wasd)
+            -> void {
+        const auto [sin, cos] = trig::sincos(yaw);
+        const auto &intent = INTENTS[wasd & 31];
+        bodies.thrust_x[index] = cos * intent.x + sin * intent.z;
+        bodies.thrust_z[index] = cos * intent.z - sin * intent.x;
+        bodies.jump[index] = intent.jump;
+    }
+
+    auto set_inputs(Bodies &bodies, const std::span<const Player> players, const std::size_t begin,
+                    const std::size_t end) -> void {
+        for (auto i = begin; i < end; ++i) {
+            set_input(bodies, i, players[i].yaw, players[i].wasd);
+        }
+    }
+
+    /// 标量版本，运算顺序与 AVX2 版本完全相同，两者结果逐位一致
+    auto integrate_scalar(Bodies &bodies, const Step &step, const std::size_t begin, const std::size_t end) -> void {
+        const auto scale = static_cast<float>(MAP_BOX_SCALE);
+        for (auto i = begin; i < end; ++i) {
+            const auto vx = bodies.vx[i];
+            const auto vy = bodies.vy[i];
+            const auto vz = bodies.vz[i];
+            const auto x = bodies.x[i] + (bodies.thrust_x[i] * step.position_gain + vx * step.carry);
+            const auto y = bodies.y[i] + (vy * step.time + step.fall_distance);
+            const auto z = bodies.z[i] + (bodies.thrust_z[i] * step.position_gain + vz * step.carry);
+            const auto bound = scale - bodies.radius[i];
+            const auto floor = bodies.height[i] - scale;
+            const auto clamped_x = std::max(std::min(bound, x), -bound);
+            const auto clamped_y = std::max(std::min(bound, y), floor);
+            const auto clamped_z = std::max(std::min(bound, z), -bound);
+            // 撞墙时那个方向的速度清零，落地时按是否起跳重置竖直速度
+            bodies.vx[i] = x != clamped_x ? 0.0f : vx * step.keep + bodies.thrust_x[i] * step.velocity_gain;
+            bodies.vy[i] = y != clamped_y ? bodies.jump[i] : vy - step.fall_speed;
+            bodies.vz[i] = z != clamped_z ? 0.0f : vz * step.keep + bodies.thrust_z[i] * step.velocity_gain;
+            bodies.x[i] = clamped_x;
+            bodies.y[i] = clamped_y;
+            bodies.z[i] = clamped_z;
+        }
+    }
+
+#if defined(WOODENEYE_X86)
+    WOODENEYE_TARGET("avx2")
+    auto integrate_avx2(Bodies &bodies, const Step &step, const std::size_t begin, const std::size_t end)
+            -> std::size_t {
+        const auto scale = _mm256_set1_ps(static_cast<float>(MAP_BOX_SCALE));
+        const auto time = _mm256_set1_ps(step.time);
+        const auto keep = _mm256_set1_ps(step.keep);
+        const auto velocity_gain = _mm256_set1_ps(step.velocity_gain);
+        const auto position_gain = _mm256_set1_ps(step.position_gain);
+        const auto carry = _mm256_set1_ps(step.carry);
+        const auto fall_speed = _mm256_set1_ps(step.fall_speed);
+        const auto fall_distance = _mm256_set1_ps(step.fall_distance);
+        const auto zero = _mm256_setzero_ps();
+        const auto sign_mask = _mm256_set1_ps(-0.0f);
+
+        // 范围的起点不一定对齐（本地玩家和机器人分两段积分），统一用非对齐读写
+        auto i = begin;
+        for (; i + edges::SIMD_LANES <= end; i += edges::SIMD_LANES) {
+            const auto vx = _mm256_loadu_ps(&bodies.vx[i]);
+            const auto vy = _mm256_loadu_ps(&bodies.vy[i]);
+            const auto vz = _mm256_loadu_ps(&bodies.vz[i]);
+            const auto thrust_x = _mm256_loadu_ps(&bodies.thrust_x[i]);
+            const auto thrust_z = _mm256_loadu_ps(&bodies.thrust_z[i]);
+            const auto push_x = _mm256_add_ps(_mm256_mul_ps(thrust_x, position_gain), _mm256_mul_ps(vx, carry));
+            const auto x = _mm256_add_ps(_mm256_loadu_ps(&bodies.x[i]), push_x);
+            const auto y = _mm256_add_ps(_mm256_loadu_ps(&bodies.y[i]),
+                                         _mm256_add_ps(_mm256_mul_ps(vy, time), fall_distance));
+            const auto push_z = _mm256_add_ps(_mm256_mul_ps(thrust_z, position_gain), _mm256_mul_ps(vz, carry));
+            const auto z = _mm256_add_ps(_mm256_loadu_ps(&bodies.z[i]), push_z);
+            const auto bound = _mm256_sub_ps(scale, _mm256_loadu_ps(&bodies.radius[i]));
+            const auto negative_bound = _mm256_xor_ps(bound, sign_mask);
+            const auto floor = _mm256_sub_ps(_mm256_loadu_ps(&bodies.height[i]), scale);
+            // 操作数顺序与 std::max(std::min(bound, x), -bound) 保持一致
+            const auto clamped_x = _mm256_max_ps(negative_bound, _mm256_min_ps(x, bound));
+            const auto clamped_y = _mm256_max_ps(floor, _mm256_min_ps(y, bound));
+            const auto clamped_z = _mm256_max_ps(negative_bound, _mm256_min_ps(z, bound));
+
+            const auto moved_vx = _mm256_add_ps(_mm256_mul_ps(vx, keep), _mm256_mul_ps(thrust_x, velocity_gain));
+            const auto moved_vy = _mm256_sub_ps(vy, fall_speed);
+            const auto moved_vz = _mm256_add_ps(_mm256_mul_ps(vz, keep), _mm256_mul_ps(thrust_z, velocity_gain));
+            _mm256_storeu_ps(&bodies.vx[i], _mm256_blendv_ps(moved_vx, zero, _mm256_cmp_ps(x, clamped_x, _CMP_NEQ_UQ)));
+            _mm256_storeu_ps(&bodies.vy[i], _mm256_blendv_ps(moved_vy, _mm256_loadu_ps(&bodies.jump[i]),
+                                                             _mm256_cmp_ps(y, clamped_y, _CMP_NEQ_UQ)));
+            _mm256_storeu_ps(&bodies.vz[i], _mm256_blendv_ps(moved_vz, zero, _mm256_cmp_ps(z, clamped_z, _CMP_NEQ_UQ)));
+            _mm256_storeu_ps(&bodies.x[i], clamped_x);
+            _mm256_storeu_ps(&bodies.y[i], clamped_y);
+            _mm256_storeu_ps(&bodies.z[i], clamped_z);
+        }
+        return i;
+    }
+#endif
+
+    auto integrate(Bodies &bodies, const Step &step, std::size_t begin, const std::size_t end,
+                   const edges::Backend backend) -> void {
+#if defined(WOODENEYE_X86)
+        if (backend == edges::Backend::Avx2 && edges::is_backend_supported(edges::Backend::Avx2)) {
+            begin = integrate_avx2(bodies, step, begin, end);
+        }
+#endif
+        // 凑不满一个 SIMD 批次的尾部交给标量版本
+        integrate_scalar(bodies, step, begin, end);
+    }
+} // namespace physics
@@ -0,0 +1,325 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+export module woodeneye.spatial;
+
+import woodeneye.edges;
+import woodeneye.physics;
+
+export namespace spatial {
+    /**
+     * 射线是否击中玩家：玩家是上下两个半径为 radius 的球，只检测射线前方
+     * 判定方式与原先 Application::shoot 里的相同
+     */
+    auto ray_hits_player(const std::array<double, 3> &origin, const std::array<double, 3> &direction,
+                         const physics::Bodies &bodies, const std::size_t target) -> bool {
+        const double r = bodies.radius[target];
+        const double h = bodies.height[target];
+        const double vv = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+        for (int j = 0; j < 2; j++) {
+            const double dx = bodies.x[target] - origin[0];
+            const double dy = bodies.y[target] - origin[1] + (j == 0 ? 0 : r - h);
+            const double dz = bodies.z[target] - origin[2];
+            const double vd = direction[0] * dx + direction[1] * dy + direction[2] * dz;
+            const double dd = dx * dx + dy * dy + dz * dz;
+            if (vd < 0) continue;
+            if (vd * vd >= vv * (dd - r * r)) return true;
+        }
+        return false;
+    }
+
+    /// 包住玩家两个球的包围球，y 方向的中心在两个球心中间
+    struct BoundingSphere {
+        float x, y, z, radius;
+    };
+
+    auto bounding_sphere(const physics::Bodies &bodies, const std::size_t index) -> BoundingSphere {
+        const auto half_span = 0.5f * (bodies.height[index] - bodies.radius[index]);
+        return {bodies.x[index], bodies.y[index] - half_span, bodies.z[index], bodies.radius[index] + half_span};
+    }
+
+    /**
+     * 视锥体的 6 个平面，世界坐标，n·p + d <= 0 的一侧是内侧
+     * 由相机矩阵和视口参数构造，与 Application::draw 的透视投影一致：相机看向 -z，屏幕 x = origin - focal * x / z
+     */
+    struct Frustum {
+        std::array<std::array<float, 4>, 6> planes{};
+
+        static auto from_camera(const edges::Camera &camera, const float focal, const float half_width,
+                                const float half_height, const float near, const float far) -> Frustum {
+            // 相机坐标下的平面
+            const std::array<std::array<float, 4>, 6> local = {{
+                {focal, 0.0f, half_width, 0.0f},
+                {-focal, 0.0f, half_width, 0.0f},
+                {0.0f, focal, half_height, 0.0f},
+                {0.0f, -focal, half_height, 0.0f},
+                {0.0f, 0.0f, 1.0f, near},
+                {0.0f, 0.0f, -1.0f, -far},
+            }};
+            const auto &m = camera.mat;
+            Frustum frustum;
+            for (std::size_t i = 0; i < local.size(); ++i) {
+                const auto &[lx, ly, lz, ld] = local[i];
+                const auto inv_length = 1.0f / std::sqrt(lx * lx + ly * ly + lz * lz);
+                // 相机坐标 p' = M (p - c)，所以 n·p' = (Mᵀ n)·p - (Mᵀ n)·c
+                const auto nx = (m[0] * lx + m[3] * ly + m[6] * lz) * inv_length;
+                const auto ny = (m[1] * lx + m[4] * ly + m[7] * lz) * inv_length;
+                const auto nz = (m[2] * lx + m[5] * ly + m[8] * lz) * inv_length;
+                const auto d = ld * inv_length - (nx * camera.x + ny * camera.y + nz * camera.z);
+                frustum.planes[i] = {nx, ny, nz, d};
+            }
+            return frustum;
+        }
+
+        [[nodiscard]] auto intersects_sphere(const BoundingSphere &sphere) const -> bool {
+            return std::ranges::all_of(planes, [&sphere](const auto &plane) {
+                return plane[0] * sphere.x + plane[1] * sphere.y + plane[2] * sphere.z + plane[3] <= sphere.radius;
+            });
+        }
+
+        enum class Containment {
+            Outside,
+            Intersects,
+            Inside,
+        };
+
+        /**
+         * 保守的包围盒测试：盒子最靠内侧的顶点在某个平面外侧时判定为在外面，
+         * 最靠外侧的顶点也在所有平面内侧时判定为整个在里面
+         */
+        [[nodiscard]] auto classify_box(const std::array<float, 3> &min, const std::array<float, 3> &max) const
+                -> Containment {
+            auto result = Containment::Inside;
+            for (const auto &plane: planes) {
+                auto nearest = plane[3];
+                auto farthest = plane[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    nearest += plane[axis] * (plane[axis] > 0.0f ? min[axis] : max[axis]);
+                    farthest += plane[axis] * (plane[axis] > 0.0f ? max[axis] : min[axis]);
+                }
+                if (nearest > 0.0f) {
+                    return Containment::Outside;
+                }
+                if (farthest > 0.0f) {
+                    result = Containment::Intersects;
+                }
+            }
+            return result;
+        }
+    };
+
+    /**
+     * XZ 平面上的均匀网格，覆盖 [-half_extent, half_extent]²，y 方向不划分
+     * 每帧用计数排序整体重建成两张表，都是 start[c] ~ start[c + 1] 对应格子 c，没有逐格子的动态分配：
+     * - 覆盖表：玩家登记到它水平范围覆盖的所有格子里，射线查询因此不会漏掉跨格子的玩家
+     * - 归属表：玩家只登记在中心所在的格子里，视锥体查询用它，不会重复
+     * 两次重建之间被移动（重生）的玩家记在 moved 里，查询时单独检测，网格里的旧记录被跳过
+     */
+    class UniformGrid {
+    public:
+        UniformGrid(const float half_extent, const float cell_size) :
+            half(half_extent), cell(cell_size), inv_cell(1.0f / cell_size),
+            side(std::max(1, static_cast<int>(std::ceil(2.0f * half_extent / cell_size)))),
+            cell_start(static_cast<std::size_t>(side * side) + 1), home_start(cell_start.size()) {}
+
+        auto rebuild(const physics::Bodies &bodies, const std::span<const int> members) -> void {
+            std::ranges::fill(cell_start, 0);
+            std::ranges::fill(home_start, 0);
+            max_radius = 0.0f;
+            for (const auto index: members) {
+                max_radius = std::max(max_radius, bounding_sphere(bodies, index).radius);
+                for_each_covered_cell(bodies, index, [this](const int cell_index) { ++cell_start[cell_index + 1]; });
+                ++home_start[home_cell(bodies, index) + 1];
+            }
+            for (std::size_t i = 1; i < cell_start.size(); ++i) {
+                cell_start[i] += cell_start[i - 1];
+                home_start[i] += home_start[i - 1];
+            }
+
+            items.resize(static_cast<std::size_t>(cell_start.back()));
+            home_items.resize(static_cast<std::size_t>(home_start.back()));
+            cursor.assign(cell_start.begin(), cell_start.end() - 1);
+            home_cursor.assign(home_start.begin(), home_start.end() - 1);
+            for (const auto index: members) {
+                for_each_covered_cell(bodies, index,
+                                      [this, index](const int cell_index) { items[cursor[cell_index]++] = index; });
+                home_items[home_cursor[home_cell(bodies, index)]++] = index;
+            }
+
+            for (const auto index: moved) {
+                moved_flags[index] = 0;
+            }
+            moved.clear();
+            moved_flags.resize(bodies.size());
+        }
+
+        /// 玩家被移动到了别处（例如重生），下次重建之前查询都单独检测它
+        auto mark_moved(const int index) -> void {
+            if (moved_flags[index] == 0) {
+                moved_flags[index] = 1;
+                moved.push_back(index);
+            }
+        }
+
+        [[nodiscard]] auto coord(const float value) const -> int {
+            return std::clamp(static_cast<int>(std::floor((value + half) * inv_cell)), 0, side - 1);
+        }
+
+        [[nodiscard]] auto cell_index(const int cx, const int cz) const -> int { return cz * side + cx; }
+
+        [[nodiscard]] auto members(const int cx, const int cz) const -> std::span<const int> {
+            const auto index = cell_index(cx, cz);
+            return {items.data() + cell_start[index], items.data() + cell_start[index + 1]};
+        }
+
+        /**
+         * 沿射线在 XZ 平面上的投影按顺序访问经过的格子（Amanatides-Woo 遍历），visit 返回 false 时提前结束
+         * 竖直的射线只访问起点所在的格子
+         */
+        template<typename Visit>
+        auto for_each_cell_on_ray(const float ox, const float oz, const float dx, const float dz, Visit &&visit) const
+                -> void {
+            constexpr auto infinity = std::numeric_limits<float>::infinity();
+            auto cx = coord(ox);
+            auto cz = coord(oz);
+            const auto step_x = dx > 0.0f ? 1 : -1;
+            const auto step_z = dz > 0.0f ? 1 : -1;
+            const auto boundary = [this](const int c, const int step) {
+                return static_cast<float>(c + (step > 0 ? 1 : 0)) * cell - half;
+            };
+            auto t_max_x = dx != 0.0f ? (boundary(cx, step_x) - ox) / dx : infinity;
+            auto t_max_z = dz != 0.0f ? (boundary(cz, step_z) - oz) / dz : infinity;
+            const auto t_delta_x = dx != 0.0f ? cell / std::fabs(dx) : infinity;
+            const auto t_delta_z = dz != 0.0f ? cell / std::fabs(dz) : infinity;
+
+            while (cx >= 0 && cx < side && cz >= 0 && cz < side) {
+                if (not visit(cx, cz)) {
+                    return;
+                }
+                if (t_max_x == infinity && t_max_z == infinity) {
+                    return;
+                }
+                if (t_max_x < t_max_z) {
+                    cx += step_x;
+                    t_max_x += t_delta_x;
+                }
+                else {
+                    cz += step_z;
+                    t_max_z += t_delta_z;
+                }
+            }
+        }
+
+        /**
+         * 射线击中的所有玩家追加到 hits（不含 shooter），与逐个检测所有玩家的结果相同
+         * 一个玩家可能登记在多个格子里，已经命中的不重复追加
+         */
+        auto trace_ray(const physics::Bodies &bodies, const int shooter, const std::array<double, 3> &origin,
+                       const std::array<double, 3> &direction, std::vector<int> &hits) const -> void {
+            const auto test = [&](const int index) {
+                if (index != shooter && std::ranges::find(hits, index) == hits.end() &&
+                    ray_hits_player(origin, direction, bodies, index)) {
+                    hits.push_back(index);
+                }
+            };
+            for_each_cell_on_ray(static_cast<float>(origin[0]), static_cast<float>(origin[2]),
+                                 static_cast<float>(direction[0]), static_cast<float>(direction[2]),
+                                 [&](const int cx, const int cz) {
+                                     for (const auto index: members(cx, cz)) {
+                                         if (moved_flags[index] == 0) {
+                                             test(index);
+                                         }
+                                     }
+                                     return true;
+                                 });
+            for (const auto index: moved) {
+                test(index);
+            }
+        }
+
+        /**
+         * 视锥体内的玩家追加到 visible（不含 viewer）
+         * 先用格子的包围盒（按最大包围球半径外扩）整格剔除或整格接受，只有与边界相交的格子才逐个测试包围球
+         */
+        auto collect_visible(const physics::Bodies &bodies, const int viewer, const Frustum &frustum,
+                             const float arena_bottom, const float arena_top, std::vector<int> &visible) const
+                -> void {
+            const auto accept = [&](const int index, const bool test) {
+                if (index != viewer && moved_flags[index] == 0 &&
+                    (not test || frustum.intersects_sphere(bounding_sphere(bodies, index)))) {
+                    visible.push_back(index);
+                }
+            };
+            for (int cz = 0; cz < side; ++cz) {
+                for (int cx = 0; cx < side; ++cx) {
+                    const auto cell = cell_index(cx, cz);
+                    if (home_start[cell] == home_start[cell + 1]) {
+                        continue;
+                    }
+                    const std::array min = {static_cast<float>(cx) * this->cell - half - max_radius,
+                                            arena_bottom - max_radius,
+                                            static_cast<float>(cz) * this->cell - half - max_radius};
+                    const std::array max = {static_cast<float>(cx + 1) * this->cell - half + max_radius,
+                                            arena_top + max_radius,
+                                            static_cast<float>(cz + 1) * this->cell - half + max_radius};
+                    const auto containment = frustum.classify_box(min, max);
+                    if (containment == Frustum::Containment::Outside) {
+                        continue;
+                    }
+                    const auto test = containment == Frustum::Containment::Intersects;
+                    for (auto i = home_start[cell]; i < home_start[cell + 1]; ++i) {
+                        accept(home_items[i], test);
+                    }
+                }
+            }
+            for (const auto index: moved) {
+                if (index != viewer && frustum.intersects_sphere(bounding_sphere(bodies, index))) {
+                    visible.push_back(index);
+                }
+            }
+        }
+
+        [[nodiscard]] auto get_cells_per_side() const -> int { return side; }
+
+    private:
+        [[nodiscard]] auto home_cell(const physics::Bodies &bodies, const int index) const -> int {
+            return cell_index(coord(bodies.x[index]), coord(bodies.z[index]));
+        }
+
+        template<typename Visit>
+        auto for_each_covered_cell(const physics::Bodies &bodies, const int index, Visit &&visit) const -> void {
+            const auto x = bodies.x[index];
+            const auto z = bodies.z[index];
+            const auto radius = bodies.radius[index];
+            const auto x0 = coord(x - radius);
+            const auto x1 = coord(x + radius);
+            const auto z0 = coord(z - radius);
+            const auto z1 = coord(z + radius);
+            for (auto cz = z0; cz <= z1; ++cz) {
+                for (auto cx = x0; cx <= x1; ++cx) {
+                    visit(cell_index(cx, cz));
+                }
+            }
+        }
+
+        float half;
+        float cell;
+        float inv_cell;
+        int side;
+        float max_radius = 0.0f;
+        std::vector<int> cell_start;
+        std::vector<int> home_start;
+        std::vector<int> cursor;
+        std::vector<int> home_cursor;
+        std::vector<int> items;
+        std::vector<int> home_items;
+        std::vector<int> moved;
+        std::vector<unsigned char> moved_flags;
+    };
+} // namespace spatial
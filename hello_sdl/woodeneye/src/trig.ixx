@@ -0,0 +1,99 @@
+module;
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+
+export module woodeneye.trig;
+
+/**
+ * 二进制角度的查表三角函数
+ * Player::yaw / pitch 用 32 位整数表示角度，2^32 对应一整圈，
+ * 用高 TABLE_BITS 位查表、剩下的低位在相邻两项之间线性插值，不需要转换成弧度再调用 std::sin / std::cos
+ */
+export namespace trig {
+    constexpr int TABLE_BITS = 12;
+    constexpr std::size_t TABLE_SIZE = std::size_t{1} << TABLE_BITS;
+    /// 四分之一圈对应的二进制角度，cos(a) = sin(a + QUARTER_TURN)
+    constexpr std::uint32_t QUARTER_TURN = 0x40000000u;
+
+    /**
+     * 插值误差上界：线性插值的截断误差最多 (2π / TABLE_SIZE)^2 / 8 ≈ 2.9e-7，
+     * 再加上 float 表项和插值运算的舍入误差；基准测试会遍历角度检查这个上界
+     */
+    constexpr float MAX_ERROR = 5e-7f;
+
+    struct SinCos {
+        float sin;
+        float cos;
+    };
+} // namespace trig
+
+namespace trig {
+    /// 编译期可用的 sin，x ∈ [-π, π]：先利用对称性折到 [-π/2, π/2]，再用泰勒级数求和
+    constexpr auto constexpr_sin(double x) -> double {
+        if (x > std::numbers::pi / 2) {
+            x = std::numbers::pi - x;
+        }
+        else if (x < -std::numbers::pi / 2) {
+            x = -std::numbers::pi - x;
+        }
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 20; ++n) {
+            term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /// 一整圈的正弦表，多出的最后一项等于第一项，插值时不用回绕下标
+    constexpr auto SINE_TABLE = [] {
+        std::array<float, TABLE_SIZE + 1> table{};
+        for (std::size_t i = 0; i <= TABLE_SIZE; ++i) {
+            // 把 [0, 2π) 映射到 [-π, π)，保证 constexpr_sin 的输入在收敛最快的范围内
+            const auto turn = static_cast<double>(i) / static_cast<double>(TABLE_SIZE);
+            const auto x = 2.0 * std::numbers::pi * (turn < 0.5 ? turn : turn - 1.0);
+            table[i] = static_cast<float>(constexpr_sin(x));
+        }
+        return table;
+    }();
+
+    constexpr int FRACTION_BITS = 32 - TABLE_BITS;
+    constexpr float FRACTION_SCALE = 1.0f / static_cast<float>(std::uint32_t{1} << FRACTION_BITS);
+} // namespace trig
+
+export namespace trig {
+    /// 二进制角度的正弦；有符号的角度（例如 pitch）直接转换成 uint32_t，补码正好对应同一个角度
+    constexpr auto sin(const std::uint32_t angle) -> float {
+        const auto index = angle >> FRACTION_BITS;
+        const auto fraction = static_cast<float>(angle & ((std::uint32_t{1} << FRACTION_BITS) - 1)) * FRACTION_SCALE;
+        const auto a = SINE_TABLE[index];
+        const auto b = SINE_TABLE[index + 1];
+        return a + (b - a) * fraction;
+    }
+
+    constexpr auto cos(const std::uint32_t angle) -> float { return sin(angle + QUARTER_TURN); }
+
+    constexpr auto sincos(const std::uint32_t angle) -> SinCos { return {sin(angle), cos(angle)}; }
+
+    /// 把 [0, 2π) 均分成 sides 份，第 index 份对应的二进制角度
+    constexpr auto fraction_of_turn(const std::uint32_t index, const std::uint32_t sides) -> std::uint32_t {
+        return static_cast<std::uint32_t>((std::uint64_t{index} << 32) / sides);
+    }
+
+    /// 单位圆上均匀分布的 VERTICES 个顶点，首尾重合（第 sides 个顶点回到起点），画圆时直接缩放平移
+    template<std::size_t VERTICES>
+    constexpr auto make_unit_circle() -> std::array<SinCos, VERTICES> {
+        std::array<SinCos, VERTICES> vertices{};
+        const auto sides = static_cast<std::uint32_t>(VERTICES - 1);
+        for (std::uint32_t i = 0; i < VERTICES; ++i) {
+            vertices[i] = sincos(fraction_of_turn(i % sides, sides));
+        }
+        return vertices;
+    }
+
+    static_assert(sin(0) == 0.0f);
+    static_assert(sin(QUARTER_TURN) == 1.0f);
+    static_assert(cos(QUARTER_TURN * 2) == -1.0f);
+} // namespace trig
@@ -8,20 +8,17 @@ module;
 export module woodeneye.types;
 
 export constexpr int MAP_BOX_SCALE = 24;
-export constexpr int MAP_BOX_EDGES_LEN = (12 + MAP_BOX_SCALE * 2);
-export constexpr int MAX_PLAYER_COUNT = 4;
+export constexpr int MAX_PLAYER_COUNT = 4; // 分屏的本地玩家数，机器人不受这个限制
+export constexpr float MIN_SCREEN_RADIUS = 0.5f; // 投影后半径小于这个像素数的玩家不再绘制
 export constexpr int CIRCLE_DRAW_SIDES = 32;
 export constexpr int CIRCLE_DRAW_SIDES_LEN = (CIRCLE_DRAW_SIDES + 1);
 
+/// 玩家的输入设备、朝向和颜色；位置、速度和体型是热数据，按 SoA 存放在 physics::Bodies 里
 export struct Player {
     SDL_MouseID mouse;
     SDL_KeyboardID keyboard;
-    std::array<double, 3> pos;
-    std::array<double, 3> vel;
     unsigned int yaw;
     int pitch;
-    float radius;
-    float height;
     std::array<unsigned char, 3> color;
     unsigned char wasd;
 };
@@ -0,0 +1,192 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+export module woodeneye.viewport;
+
+import app_runtime.render_stats;
+import woodeneye.edges;
+import woodeneye.spatial;
+import woodeneye.trig;
+import woodeneye.types;
+import woodeneye.world;
+
+export namespace viewport {
+    /// 分屏中一个视口的位置和投影参数
+    struct Layout {
+        SDL_Rect clip;
+        float origin_x;
+        float origin_y;
+        float focal;
+        float half_width;
+        float half_height;
+    };
+
+    /// 与原先 Application::draw 相同的分屏方式：1 个全屏，2 个上下分，3~4 个田字格
+    auto split_screen(const int width, const int height, const int count, const int index) -> Layout {
+        const int part_hor = count > 2 ? 2 : 1;
+        const int part_ver = count > 1 ? 2 : 1;
+        const float size_hor = static_cast<float>(width) / static_cast<float>(part_hor);
+        const float size_ver = static_cast<float>(height) / static_cast<float>(part_ver);
+        const auto mod_x = static_cast<float>(index % part_hor);
+        const auto mod_y = static_cast<float>(index / part_hor);
+        Layout layout{};
+        layout.clip = {static_cast<int>(mod_x * size_hor), static_cast<int>(mod_y * size_ver),
+                       static_cast<int>(size_hor), static_cast<int>(size_ver)};
+        layout.origin_x = (mod_x + 0.5f) * size_hor;
+        layout.origin_y = (mod_y + 0.5f) * size_ver;
+        layout.focal = 0.5f * std::hypot(size_hor, size_ver);
+        layout.half_width = 0.5f * size_hor;
+        layout.half_height = 0.5f * size_ver;
+        return layout;
+    }
+
+    /**
+     * 一批圆环：每个圆按 CIRCLE_DRAW_SIDES 边形展开成 1 像素宽的环带，顶点带各自的颜色
+     * 整批用一次 SDL_RenderGeometryRaw 提交，代替每个圆一次 SDL_RenderLines
+     */
+    class RingBatch {
+    public:
+        static constexpr std::size_t VERTICES_PER_RING = CIRCLE_DRAW_SIDES_LEN * 2;
+        static constexpr std::size_t INDICES_PER_RING = CIRCLE_DRAW_SIDES * 6;
+
+        auto clear() -> void { ring_count = 0; }
+
+        auto add(const float x, const float y, const float radius, const std::array<unsigned char, 3> &rgb) -> void {
+            // 单位圆顶点在编译期生成，这里只做缩放和平移
+            static constexpr auto unit_circle = trig::make_unit_circle<CIRCLE_DRAW_SIDES_LEN>();
+            reserve(ring_count + 1);
+            const auto outer = std::abs(radius) + 0.5f;
+            const auto inner = std::max(std::abs(radius) - 0.5f, 0.0f);
+            const SDL_FColor color{static_cast<float>(rgb[0]) / 255.0f, static_cast<float>(rgb[1]) / 255.0f,
+                                   static_cast<float>(rgb[2]) / 255.0f, 1.0f};
+            auto *xy = &this->xy[ring_count * VERTICES_PER_RING * 2];
+            for (const auto &[sin, cos]: unit_circle) {
+                xy[0] = x + outer * cos;
+                xy[1] = y + outer * sin;
+                xy[2] = x + inner * cos;
+                xy[3] = y + inner * sin;
+                xy += 4;
+            }
+            std::fill_n(colors.begin() + static_cast<std::ptrdiff_t>(ring_count * VERTICES_PER_RING),
+                        VERTICES_PER_RING, color);
+            ++ring_count;
+        }
+
+        auto submit(SDL_Renderer *renderer) const -> bool {
+            if (ring_count == 0) {
+                return true;
+            }
+            return app_runtime::render_geometry_raw(renderer, nullptr, xy.data(), 2 * sizeof(float), colors.data(),
+                                                    sizeof(SDL_FColor), nullptr, 0,
+                                                    static_cast<int>(ring_count * VERTICES_PER_RING), indices.data(),
+                                                    static_cast<int>(ring_count * INDICES_PER_RING), sizeof(int));
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t { return ring_count; }
+
+    private:
+        /// 数组只增不减，稳定之后每帧不再分配
+        auto reserve(const std::size_t rings) -> void {
+            if (colors.size() >= rings * VERTICES_PER_RING) {
+                return;
+            }
+            const auto capacity = std::max(rings, ring_count * 2);
+            xy.resize(capacity * VERTICES_PER_RING * 2);
+            colors.resize(capacity * VERTICES_PER_RING);
+            for (auto ring = indices.size() / INDICES_PER_RING; ring < capacity; ++ring) {
+                const auto base = static_cast<int>(ring * VERTICES_PER_RING);
+                for (int side = 0; side < CIRCLE_DRAW_SIDES; ++side) {
+                    const auto outer = base + side * 2;
+                    indices.insert(indices.end(), {outer, outer + 1, outer + 2, outer + 2, outer + 1, outer + 3});
+                }
+            }
+        }
+
+        std::vector<float> xy;
+        std::vector<SDL_FColor> colors;
+        std::vector<int> indices;
+        std::size_t ring_count = 0;
+    };
+
+    /**
+     * 一个视口一帧的绘制命令：地图的边、可见的玩家和准星
+     * record 只读 World，可以在工作线程上为不同视口并行调用；replay 在主线程上把命令交给渲染器
+     * 录制用的暂存区也放在这里，每个视口一份，线程之间不共享
+     */
+    class CommandBuffer {
+    public:
+        auto record(const World &world, const edges::EdgeBuffer &map, int viewer, const Layout &layout) -> void;
+
+        auto replay(SDL_Renderer *renderer) const -> void;
+
+        [[nodiscard]] auto get_edge_count() const -> std::size_t { return map_lines.size(); }
+        [[nodiscard]] auto get_ring_count() const -> std::size_t { return players.size(); }
+
+    private:
+        SDL_Rect clip{};
+        edges::LineBatch map_lines;
+        RingBatch players;
+        edges::LineBatch crosshair;
+
+        edges::ProjectedEdges projected;
+        std::vector<int> visible;
+    };
+} // namespace viewport
+
+namespace viewport {
+    auto CommandBuffer::record(const World &world, const edges::EdgeBuffer &map, const int viewer,
+                               const Layout &layout) -> void {
+        clip = layout.clip;
+        const auto &bodies = world.get_bodies();
+        const auto eye = bodies.position(viewer);
+        const auto camera = edges::make_camera(world.get_player(viewer), eye);
+        const auto &mat = camera.mat;
+
+        // 所有地图边批量投影、裁剪
+        map_lines.clear();
+        map_lines.set_color(64, 64, 64);
+        edges::project_edges(map, camera, {layout.origin_x, layout.origin_y, layout.focal, 1.0f}, projected,
+                             map_lines);
+
+        // 只画视锥体内、投影后不小于 MIN_SCREEN_RADIUS 像素的玩家
+        const auto far = layout.focal * bodies.radius[viewer] / MIN_SCREEN_RADIUS;
+        const auto frustum = spatial::Frustum::from_camera(camera, layout.focal, layout.half_width, layout.half_height,
+                                                           0.0f, far);
+        visible.clear();
+        world.collect_visible(viewer, frustum, visible);
+        players.clear();
+        for (const auto j: visible) {
+            const auto &color = world.get_player(j).color;
+            for (int k = 0; k < 2; k++) {
+                double rx = bodies.x[j] - eye[0];
+                double ry = bodies.y[j] - eye[1] + (bodies.radius[j] - bodies.height[j]) * static_cast<float>(k);
+                double rz = bodies.z[j] - eye[2];
+                double dx = mat[0] * rx + mat[1] * ry + mat[2] * rz;
+                double dy = mat[3] * rx + mat[4] * ry + mat[5] * rz;
+                double dz = mat[6] * rx + mat[7] * ry + mat[8] * rz;
+                double r_eff = bodies.radius[j] * layout.focal / dz;
+                if (!(dz < 0)) continue;
+                players.add(static_cast<float>(layout.origin_x - layout.focal * dx / dz),
+                            static_cast<float>(layout.origin_y + layout.focal * dy / dz), static_cast<float>(r_eff),
+                            color);
+            }
+        }
+
+        crosshair.clear();
+        crosshair.set_color(255, 255, 255);
+        crosshair.add(layout.origin_x, layout.origin_y - 10, layout.origin_x, layout.origin_y + 10);
+        crosshair.add(layout.origin_x - 10, layout.origin_y, layout.origin_x + 10, layout.origin_y);
+    }
+
+    auto CommandBuffer::replay(SDL_Renderer *renderer) const -> void {
+        SDL_SetRenderClipRect(renderer, &clip);
+        map_lines.submit(renderer);
+        players.submit(renderer);
+        crosshair.submit(renderer);
+    }
+} // namespace viewport
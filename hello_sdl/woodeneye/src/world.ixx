@@ -0,0 +1,237 @@
+module;
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+export module woodeneye.world;
+
+import app_runtime.trace;
+import woodeneye.physics;
+import woodeneye.spatial;
+import woodeneye.trig;
+import woodeneye.types;
+
+/**
+ * 与窗口、渲染无关的 woodeneye 模拟：玩家物理、射击和机器人，可以无头运行
+ * 前 MAX_PLAYER_COUNT 个槽位留给分屏的本地玩家（只有前 local_count 个参与模拟），之后是机器人
+ * 玩家的输入和颜色存在 players 里，位置、速度等物理状态按同样的下标存在 SoA 的 bodies 里
+ * 每次 update 结束时按玩家位置重建均匀网格，射击和视锥体剔除都通过网格查询，不再两两遍历
+ * 网格只在 update 和 shoot 里修改，两次调用之间 collect_visible 可以在多个线程中同时调用
+ */
+export class World {
+public:
+    /// 网格的格子边长，远大于玩家直径，每个玩家最多登记在 4 个格子里
+    static constexpr float GRID_CELL_SIZE = 4.0f;
+
+    explicit World(int bot_count = 0, std::uint64_t seed = std::random_device{}());
+
+    auto update(Uint64 dt_ns) -> void;
+
+    /// 射击并让所有被击中的玩家随机重生，返回击中的人数
+    auto shoot(int shooter) -> std::size_t;
+
+    /// 只查询 shooter 这一枪会击中哪些玩家，不改变状态
+    auto trace_shot(int shooter, std::vector<int> &hits) -> void;
+
+    /// 视锥体内除 viewer 以外的玩家
+    auto collect_visible(int viewer, const spatial::Frustum &frustum, std::vector<int> &visible) const -> void;
+
+    [[nodiscard]] auto get_player(const int index) -> Player & { return players[index]; }
+    [[nodiscard]] auto get_player(const int index) const -> const Player & { return players[index]; }
+    [[nodiscard]] auto get_players() const -> std::span<const Player> { return players; }
+    [[nodiscard]] auto get_bodies() const -> const physics::Bodies & { return bodies; }
+    [[nodiscard]] auto get_position(const int index) const -> std::array<float, 3> { return bodies.position(index); }
+    /// 参与模拟的玩家下标：本地玩家和所有机器人
+    [[nodiscard]] auto get_active() const -> std::span<const int> { return active; }
+
+    [[nodiscard]] auto get_local_count() const -> int { return local_count; }
+    auto set_local_count(int count) -> void;
+    [[nodiscard]] auto get_bot_count() const -> int { return static_cast<int>(bots.size()); }
+    [[nodiscard]] auto get_shot_count() const -> std::uint64_t { return shot_count; }
+    [[nodiscard]] auto get_grid() const -> const spatial::UniformGrid & { return grid; }
+
+private:
+    /// 机器人的“大脑”：隔一段随机时间换一次移动方向和转向速度，再隔一段随机时间开一枪
+    struct Bot {
+        Uint64 next_think_ns = 0;
+        Uint64 next_shot_ns = 0;
+        int turn_rate = 0; ///< 每秒转过的二进制角度
+    };
+
+    auto init_local_players() -> void;
+    auto init_bot(int index) -> void;
+    auto think(Uint64 dt_ns) -> void;
+    auto respawn(int index) -> void;
+    auto refresh_active() -> void;
+    auto refresh_grid() -> void;
+
+    std::vector<Player> players;
+    physics::Bodies bodies;
+    std::vector<Bot> bots;
+    std::vector<int> active;
+    int local_count = 1;
+
+    spatial::UniformGrid grid{static_cast<float>(MAP_BOX_SCALE), GRID_CELL_SIZE};
+    std::vector<int> hits;
+
+    std::mt19937 rng;
+    Uint64 clock_ns = 0;
+    std::uint64_t shot_count = 0;
+};
+
+World::World(const int bot_count, const std::uint64_t seed) :
+    players(static_cast<std::size_t>(MAX_PLAYER_COUNT + bot_count)), bots(static_cast<std::size_t>(bot_count)),
+    rng(static_cast<std::mt19937::result_type>(seed)) {
+    bodies.resize(players.size());
+    init_local_players();
+    for (int i = 0; i < bot_count; ++i) {
+        init_bot(MAX_PLAYER_COUNT + i);
+    }
+    refresh_active();
+    refresh_grid();
+}
+
+auto World::set_local_count(const int count) -> void {
+    local_count = std::clamp(count, 0, MAX_PLAYER_COUNT);
+    refresh_active();
+    refresh_grid();
+}
+
+auto World::init_local_players() -> void {
+    for (int i = 0; i < MAX_PLAYER_COUNT; i++) {
+        bodies.x[i] = 8.0f * (i & 1 ? -1.0f : 1.0f);
+        bodies.y[i] = 0;
+        bodies.z[i] = 8.0f * (i & 1 ? -1.0f : 1.0f) * (i & 2 ? -1.0f : 1.0f);
+        bodies.vx[i] = 0;
+        bodies.vy[i] = 0;
+        bodies.vz[i] = 0;
+        bodies.radius[i] = 0.5f;
+        bodies.height[i] = 1.5f;
+        players[i].yaw = 0x20000000 + (i & 1 ? 0x80000000 : 0) + (i & 2 ? 0x40000000 : 0);
+        players[i].pitch = -0x08000000;
+        players[i].wasd = 0;
+        players[i].mouse = 0;
+        players[i].keyboard = 0;
+        players[i].color[0] = (1 << (i / 2)) & 2 ? 0 : 0xff;
+        players[i].color[1] = (1 << (i / 2)) & 1 ? 0 : 0xff;
+        players[i].color[2] = (1 << (i / 2)) & 4 ? 0 : 0xff;
+        players[i].color[0] = (i & 1) ? players[i].color[0] : ~players[i].color[0];
+        players[i].color[1] = (i & 1) ? players[i].color[1] : ~players[i].color[1];
+        players[i].color[2] = (i & 1) ? players[i].color[2] : ~players[i].color[2];
+    }
+}
+
+auto World::init_bot(const int index) -> void {
+    respawn(index);
+    bodies.radius[index] = 0.5f;
+    bodies.height[index] = 1.5f;
+    auto &bot = players[index];
+    bot.yaw = std::uniform_int_distribution<unsigned int>{}(rng);
+    bot.pitch = 0;
+    bot.wasd = 0;
+    bot.mouse = 0;
+    bot.keyboard = 0;
+    // 机器人用偏暗的随机颜色，和本地玩家的纯色区分开
+    std::uniform_int_distribution<int> channel(48, 160);
+    bot.color = {static_cast<unsigned char>(channel(rng)), static_cast<unsigned char>(channel(rng)),
+                 static_cast<unsigned char>(channel(rng))};
+}
+
+auto World::refresh_active() -> void {
+    active.clear();
+    for (int i = 0; i < local_count; ++i) {
+        active.push_back(i);
+    }
+    for (int i = 0; i < get_bot_count(); ++i) {
+        active.push_back(MAX_PLAYER_COUNT + i);
+    }
+}
+
+auto World::refresh_grid() -> void { grid.rebuild(bodies, active); }
+
+auto World::update(const Uint64 dt_ns) -> void {
+    clock_ns += dt_ns;
+    {
+        const app_runtime::trace::Zone zone("think");
+        think(dt_ns);
+    }
+    {
+        // 阻尼、重力这些只和帧间隔有关的量每帧算一次；本地玩家和机器人各是一段连续的槽位，分两段批量积分
+        const app_runtime::trace::Zone zone("integrate");
+        const auto step = physics::make_step(dt_ns);
+        const auto locals_end = static_cast<std::size_t>(local_count);
+        physics::set_inputs(bodies, players, 0, locals_end);
+        physics::set_inputs(bodies, players, MAX_PLAYER_COUNT, bodies.size());
+        physics::integrate(bodies, step, 0, locals_end);
+        physics::integrate(bodies, step, MAX_PLAYER_COUNT, bodies.size());
+    }
+    const app_runtime::trace::Zone zone("grid");
+    refresh_grid();
+}
+
+auto World::think(const Uint64 dt_ns) -> void {
+    std::uniform_int_distribution<Uint64> think_delay(SDL_NS_PER_SECOND / 2, SDL_NS_PER_SECOND * 2);
+    std::uniform_int_distribution<Uint64> shot_delay(SDL_NS_PER_SECOND, SDL_NS_PER_SECOND * 3);
+    std::uniform_int_distribution<int> turn_rate(-0x20000000, 0x20000000);
+    std::uniform_int_distribution<int> wasd(0, 15);
+    std::bernoulli_distribution jump(0.1);
+
+    for (int i = 0; i < get_bot_count(); ++i) {
+        auto &bot = bots[i];
+        const auto index = MAX_PLAYER_COUNT + i;
+        auto &player = players[index];
+        if (clock_ns >= bot.next_think_ns) {
+            player.wasd = static_cast<unsigned char>(wasd(rng) | (jump(rng) ? 16 : 0));
+            bot.turn_rate = turn_rate(rng);
+            bot.next_think_ns = clock_ns + think_delay(rng);
+        }
+        player.yaw += static_cast<unsigned int>(static_cast<std::int64_t>(bot.turn_rate) *
+                                                static_cast<std::int64_t>(dt_ns) /
+                                                static_cast<std::int64_t>(SDL_NS_PER_SECOND));
+        if (clock_ns >= bot.next_shot_ns) {
+            if (bot.next_shot_ns != 0) {
+                shoot(index);
+            }
+            bot.next_shot_ns = clock_ns + shot_delay(rng);
+        }
+    }
+}
+
+auto World::trace_shot(const int shooter, std::vector<int> &out) -> void {
+    const auto &player = players[shooter];
+    const auto [sin_yaw, cos_yaw] = trig::sincos(player.yaw);
+    const auto [sin_pitch, cos_pitch] = trig::sincos(static_cast<std::uint32_t>(player.pitch));
+    const std::array<double, 3> direction = {-sin_yaw * cos_pitch, sin_pitch, -cos_yaw * cos_pitch};
+    const std::array<double, 3> origin = {bodies.x[shooter], bodies.y[shooter], bodies.z[shooter]};
+    grid.trace_ray(bodies, shooter, origin, direction, out);
+}
+
+auto World::shoot(const int shooter) -> std::size_t {
+    ++shot_count;
+    hits.clear();
+    trace_shot(shooter, hits);
+    // 重生的玩家不立即重建网格，而是记为已移动，下次 update 时统一重建
+    for (const auto index: hits) {
+        respawn(index);
+        grid.mark_moved(index);
+    }
+    return hits.size();
+}
+
+auto World::respawn(const int index) -> void {
+    std::uniform_int_distribution<int> dist(-128, 127);
+    bodies.x[index] = static_cast<float>(MAP_BOX_SCALE * dist(rng)) / 256.0f;
+    bodies.y[index] = static_cast<float>(MAP_BOX_SCALE * dist(rng)) / 256.0f;
+    bodies.z[index] = static_cast<float>(MAP_BOX_SCALE * dist(rng)) / 256.0f;
+}
+
+auto World::collect_visible(const int viewer, const spatial::Frustum &frustum, std::vector<int> &visible) const
+        -> void {
+    const auto scale = static_cast<float>(MAP_BOX_SCALE);
+    grid.collect_visible(bodies, viewer, frustum, -scale, scale, visible);
+}
@@ -0,0 +1,659 @@
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <vector>
+
+import app_runtime.jobs;
+import woodeneye.edges;
+import woodeneye.pacing;
+import woodeneye.physics;
+import woodeneye.spatial;
+import woodeneye.trig;
+import woodeneye.types;
+import woodeneye.viewport;
+import woodeneye.world;
+
+namespace {
+    constexpr int MEASURED_FRAMES = 200;
+    constexpr int TRIG_SAMPLES = 1 << 22;
+    constexpr int SWARM_FRAMES = 300;
+    constexpr int SWARM_SHOTS = 20000;
+    constexpr int SWARM_VIEWERS = 16;
+    constexpr int PHYSICS_FRAMES = 600;
+    /// 输入每隔这么多帧随机换一次，让物体有机会撞墙、落地和起跳
+    constexpr int PHYSICS_INPUT_PERIOD = 30;
+    /// 单步积分时 float 批量版本与原先 double 版本之间允许的误差
+    constexpr double PHYSICS_POSITION_TOLERANCE = 1e-4;
+    constexpr double PHYSICS_VELOCITY_TOLERANCE = 1e-3;
+    constexpr int VIEWPORT_FRAMES = 200;
+    constexpr Uint64 PACING_DURATION_NS = SDL_NS_PER_SECOND;
+    constexpr Uint64 FRAME_NS = SDL_NS_PER_SECOND / 60;
+    constexpr float VIEW_WIDTH = 640.0f;
+    constexpr float VIEW_HEIGHT = 480.0f;
+
+    auto seconds_since(const std::chrono::steady_clock::time_point start) -> double {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// 短于这个长度（像素）的原先线段视为退化，批量投影可能把它当成长度为 0 跳过
+    constexpr float DEGENERATE_SEGMENT_LENGTH = 1e-3f;
+
+    /// edge 是线段来自地图的第几条边，和批量投影的暂存区按编号对应
+    struct Segment {
+        std::size_t edge;
+        float x0, y0, x1, y1;
+    };
+
+    /// 原先 Application::draw 的做法：逐条边双精度变换，再逐条裁剪投影（这里收集线段代替 SDL_RenderLine）
+    auto project_legacy(const edges::EdgeBuffer &map, const Player &player, const std::array<float, 3> &eye,
+                        const edges::Viewport &viewport, std::vector<Segment> &out) -> void {
+        const double x0 = eye[0];
+        const double y0 = eye[1];
+        const double z0 = eye[2];
+        const double bin_rad = std::numbers::pi / 2147483648.0;
+        const double yaw_rad = bin_rad * player.yaw;
+        const double pitch_rad = bin_rad * player.pitch;
+        const double cos_yaw = std::cos(yaw_rad);
+        const double sin_yaw = std::sin(yaw_rad);
+        const double cos_pitch = std::cos(pitch_rad);
+        const double sin_pitch = std::sin(pitch_rad);
+        const double mat[9] = {
+            cos_yaw, 0, -sin_yaw,
+            sin_yaw * sin_pitch, cos_pitch, cos_yaw * sin_pitch,
+            sin_yaw * cos_pitch, -sin_pitch, cos_yaw * cos_pitch
+        };
+        const float w = viewport.near;
+        const float z = viewport.focal;
+        for (std::size_t i = 0; i < map.count; ++i) {
+            auto ax = static_cast<float>(mat[0] * (map.ax[i] - x0) + mat[1] * (map.ay[i] - y0) + mat[2] * (map.az[i] - z0));
+            auto ay = static_cast<float>(mat[3] * (map.ax[i] - x0) + mat[4] * (map.ay[i] - y0) + mat[5] * (map.az[i] - z0));
+            auto az = static_cast<float>(mat[6] * (map.ax[i] - x0) + mat[7] * (map.ay[i] - y0) + mat[8] * (map.az[i] - z0));
+            auto bx = static_cast<float>(mat[0] * (map.bx[i] - x0) + mat[1] * (map.by[i] - y0) + mat[2] * (map.bz[i] - z0));
+            auto by = static_cast<float>(mat[3] * (map.bx[i] - x0) + mat[4] * (map.by[i] - y0) + mat[5] * (map.bz[i] - z0));
+            auto bz = static_cast<float>(mat[6] * (map.bx[i] - x0) + mat[7] * (map.by[i] - y0) + mat[8] * (map.bz[i] - z0));
+            if (az >= -w && bz >= -w) continue;
+            float dx = ax - bx;
+            float dy = ay - by;
+            if (az > -w) {
+                float t = (-w - bz) / (az - bz);
+                ax = bx + dx * t;
+                ay = by + dy * t;
+                az = -w;
+            }
+            else if (bz > -w) {
+                float t = (-w - az) / (bz - az);
+                bx = ax - dx * t;
+                by = ay - dy * t;
+                bz = -w;
+            }
+            ax = -z * ax / az;
+            ay = -z * ay / az;
+            bx = -z * bx / bz;
+            by = -z * by / bz;
+            out.push_back({i, viewport.origin_x + ax, viewport.origin_y - ay, viewport.origin_x + bx,
+                           viewport.origin_y - by});
+        }
+    }
+
+    /// 站在地图一角、朝向中心略微低头，大部分网格都在视野内
+    auto make_player() -> Player {
+        Player player{};
+        player.yaw = 0x20000000;
+        player.pitch = -0x08000000;
+        return player;
+    }
+
+    /// 原先 Player 里和物理有关的字段，用双精度 AoS 存放
+    struct LegacyBody {
+        std::array<double, 3> pos;
+        std::array<double, 3> vel;
+        unsigned int yaw;
+        float radius;
+        float height;
+        unsigned char wasd;
+    };
+
+    /// 原先 Application::update 的逐玩家积分：每个玩家都重新计算 exp 和阻尼项
+    auto integrate_legacy(LegacyBody &player, const Uint64 dt_ns) -> void {
+        double rate = 6.0;
+        double time = static_cast<double>(dt_ns) * 1e-9;
+        double drag = std::exp(-time * rate);
+        double diff = 1.0 - drag;
+        double mult = 60.0;
+        double grav = 25.0;
+        const auto [sin, cos] = trig::sincos(player.yaw);
+        unsigned char wasd = player.wasd;
+        double dirX = (wasd & 8 ? 1.0 : 0.0) - (wasd & 2 ? 1.0 : 0.0);
+        double dirZ = (wasd & 4 ? 1.0 : 0.0) - (wasd & 1 ? 1.0 : 0.0);
+        double norm = dirX * dirX + dirZ * dirZ;
+        double accX = mult * (norm == 0 ? 0 : (cos * dirX + sin * dirZ) / std::sqrt(norm));
+        double accZ = mult * (norm == 0 ? 0 : (-sin * dirX + cos * dirZ) / std::sqrt(norm));
+        double velX = player.vel[0];
+        double velY = player.vel[1];
+        double velZ = player.vel[2];
+        player.vel[0] -= velX * diff;
+        player.vel[1] -= grav * time;
+        player.vel[2] -= velZ * diff;
+        player.vel[0] += diff * accX / rate;
+        player.vel[2] += diff * accZ / rate;
+        player.pos[0] += (time - diff / rate) * accX / rate + diff * velX / rate;
+        player.pos[1] += -0.5 * grav * time * time + velY * time;
+        player.pos[2] += (time - diff / rate) * accZ / rate + diff * velZ / rate;
+        auto scale = static_cast<double>(MAP_BOX_SCALE);
+        double bound = scale - player.radius;
+        double posX = std::max(std::min(bound, player.pos[0]), -bound);
+        double posY = std::max(std::min(bound, player.pos[1]), player.height - scale);
+        double posZ = std::max(std::min(bound, player.pos[2]), -bound);
+        if (player.pos[0] != posX) player.vel[0] = 0;
+        if (player.pos[1] != posY) player.vel[1] = (wasd & 16) ? 8.4375 : 0;
+        if (player.pos[2] != posZ) player.vel[2] = 0;
+        player.pos[0] = posX;
+        player.pos[1] = posY;
+        player.pos[2] = posZ;
+    }
+
+    auto make_eye(const int scale) -> std::array<float, 3> {
+        const auto s = static_cast<float>(scale);
+        return {0.8f * s, 1.5f - s, 0.8f * s};
+    }
+} // namespace
+
+/**
+ * 对比每帧投影所有地图边的耗时：
+ *  - legacy：原先的逐条边双精度变换 + 逐条裁剪
+ *  - scalar / avx2：SoA 批量投影并填充 LineBatch
+ * 同时检查批量投影与原先做法得到的线段数量和最大坐标误差
+ */
+auto benchmark_edges() -> int {
+    const edges::Viewport viewport{VIEW_WIDTH / 2, VIEW_HEIGHT / 2, 0.5f * std::hypot(VIEW_WIDTH, VIEW_HEIGHT), 1.0f};
+
+    std::printf("%-8s %8s %10s %12s %12s %12s %12s\n", "scale", "edges", "visible", "legacy us", "scalar us",
+                "avx2 us", "max rel err");
+    for (const int scale: {MAP_BOX_SCALE, 256, 1024, 4096}) {
+        const auto map = edges::build_map_edges(scale);
+        const auto player = make_player();
+        const auto eye = make_eye(scale);
+        const auto camera = edges::make_camera(player, eye);
+
+        std::vector<Segment> legacy_segments;
+        legacy_segments.reserve(map.count);
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < MEASURED_FRAMES; ++frame) {
+            legacy_segments.clear();
+            project_legacy(map, player, eye, viewport, legacy_segments);
+        }
+        const auto legacy_us = seconds_since(start) * 1e6 / MEASURED_FRAMES;
+
+        edges::ProjectedEdges scratch;
+        edges::LineBatch batch;
+        auto measure = [&](const edges::Backend backend) {
+            const auto begin = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < MEASURED_FRAMES; ++frame) {
+                batch.clear();
+                edges::project_edges(map, camera, viewport, scratch, batch, backend);
+            }
+            return seconds_since(begin) * 1e6 / MEASURED_FRAMES;
+        };
+        const auto scalar_us = measure(edges::Backend::Scalar);
+        const auto avx2_us = edges::is_backend_supported(edges::Backend::Avx2) ? measure(edges::Backend::Avx2) : 0.0;
+
+        // 按边的编号与原先做法比较投影后的端点，直接比较暂存区
+        // 批量投影会跳过长度为 0 的线段而原先的做法照样画出来，这样的退化线段不参与比较
+        edges::project_edges(map, camera, viewport, scratch, batch, edges::best_backend());
+        std::size_t visible = 0;
+        double max_error = 0.0;
+        for (const auto &[edge, x0, y0, x1, y1]: legacy_segments) {
+            if (scratch.visible[edge] == 0) {
+                if (std::hypot(x1 - x0, y1 - y0) <= DEGENERATE_SEGMENT_LENGTH) {
+                    continue;
+                }
+                std::fprintf(stderr, "Edge %zu is visible only in the legacy projection at scale %d\n", edge, scale);
+                return 1;
+            }
+            // 裁剪后靠近近裁剪面的端点会投影到屏幕外很远的地方，用相对误差衡量
+            const auto error = [](const float actual, const float expected) {
+                return std::fabs(static_cast<double>(actual) - expected) /
+                       std::max(1.0, std::fabs(static_cast<double>(expected)));
+            };
+            max_error = std::max({max_error, error(scratch.x0[edge], x0), error(scratch.y0[edge], y0),
+                                  error(scratch.x1[edge], x1), error(scratch.y1[edge], y1)});
+            ++visible;
+        }
+        const auto batch_visible = static_cast<std::size_t>(std::count_if(
+                scratch.visible.begin(), scratch.visible.begin() + static_cast<std::ptrdiff_t>(map.count),
+                [](const auto flag) { return flag != 0; }));
+        if (batch_visible != visible) {
+            std::fprintf(stderr, "Visible edge count mismatch at scale %d: %zu vs %zu\n", scale, batch_visible,
+                         visible);
+            return 1;
+        }
+
+        std::printf("%-8d %8zu %10zu %12.1f %12.1f %12.1f %12.2e\n", scale, map.count, visible, legacy_us, scalar_us,
+                    avx2_us, max_error);
+    }
+    return 0;
+}
+
+/**
+ * 对比二进制角度转弧度后调用 libm 的 std::sin / std::cos 与 trig 查表插值的耗时，
+ * 并遍历整圈角度检查查表结果的误差不超过 trig::MAX_ERROR
+ */
+auto benchmark_trig() -> int {
+    // 用不规则的步长覆盖整圈，避免只落在表项上
+    constexpr std::uint32_t ANGLE_STEP = 0x9E3779B9u;
+    volatile float sink = 0.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint32_t angle = 0;
+    double libm_sum = 0.0;
+    for (int i = 0; i < TRIG_SAMPLES; ++i) {
+        const double rad = angle * std::numbers::pi / 2147483648.0;
+        libm_sum += std::sin(rad) + std::cos(rad);
+        angle += ANGLE_STEP;
+    }
+    sink = static_cast<float>(libm_sum);
+    const auto libm_ns = seconds_since(start) * 1e9 / TRIG_SAMPLES;
+
+    start = std::chrono::steady_clock::now();
+    angle = 0;
+    float table_sum = 0.0f;
+    for (int i = 0; i < TRIG_SAMPLES; ++i) {
+        const auto [sin, cos] = trig::sincos(angle);
+        table_sum += sin + cos;
+        angle += ANGLE_STEP;
+    }
+    sink = table_sum;
+    const auto table_ns = seconds_since(start) * 1e9 / TRIG_SAMPLES;
+    static_cast<void>(sink);
+
+    double max_error = 0.0;
+    for (std::uint64_t sample = 0; sample < (std::uint64_t{1} << 32); sample += 997) {
+        const auto binary = static_cast<std::uint32_t>(sample);
+        const double rad = binary * std::numbers::pi / 2147483648.0;
+        const auto [sin, cos] = trig::sincos(binary);
+        max_error = std::max({max_error, std::fabs(sin - std::sin(rad)), std::fabs(cos - std::cos(rad))});
+    }
+
+    std::printf("\n%-12s %12s %12s %12s %12s\n", "function", "libm ns", "table ns", "max error", "bound");
+    std::printf("%-12s %12.2f %12.2f %12.2e %12.2e\n", "sincos", libm_ns, table_ns, max_error,
+                static_cast<double>(trig::MAX_ERROR));
+    if (max_error > trig::MAX_ERROR) {
+        std::fprintf(stderr, "Trig table error %.3g exceeds bound %.3g\n", max_error,
+                     static_cast<double>(trig::MAX_ERROR));
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * 机器人集群：不同人数下每帧 update（机器人思考、射击、物理、重建网格）的耗时，
+ * 网格射线查询与逐个检测所有玩家的射击吞吐量，以及视锥体剔除后的绘制列表大小和耗时
+ * 网格查询的结果必须与逐个检测完全一致
+ */
+auto benchmark_bots() -> int {
+    std::printf("\n%-8s %10s %14s %14s %10s %10s %12s\n", "players", "update us", "grid shots/s", "brute shots/s",
+                "draw list", "cull us", "brute cull us");
+    for (const int bot_count: {16, 64, 256, 1024, 4096}) {
+        World world{bot_count, 42};
+        world.set_local_count(0);
+        for (int frame = 0; frame < 60; ++frame) {
+            world.update(FRAME_NS);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < SWARM_FRAMES; ++frame) {
+            world.update(FRAME_NS);
+        }
+        const auto update_us = seconds_since(start) * 1e6 / SWARM_FRAMES;
+
+        const auto players = world.get_players();
+        const auto &bodies = world.get_bodies();
+        const auto active = world.get_active();
+        std::mt19937 rng{7};
+        std::uniform_int_distribution<std::size_t> pick(0, active.size() - 1);
+        std::vector<int> shooters(SWARM_SHOTS);
+        for (auto &shooter: shooters) {
+            shooter = active[pick(rng)];
+        }
+
+        std::vector<int> hits;
+        std::size_t grid_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto shooter: shooters) {
+            hits.clear();
+            world.trace_shot(shooter, hits);
+            grid_hits += hits.size();
+        }
+        const auto grid_shots = SWARM_SHOTS / seconds_since(start);
+
+        std::size_t brute_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto shooter: shooters) {
+            const auto &player = players[shooter];
+            const auto [sin_yaw, cos_yaw] = trig::sincos(player.yaw);
+            const auto [sin_pitch, cos_pitch] = trig::sincos(static_cast<std::uint32_t>(player.pitch));
+            const std::array<double, 3> direction = {-sin_yaw * cos_pitch, sin_pitch, -cos_yaw * cos_pitch};
+            const std::array<double, 3> origin = {bodies.x[shooter], bodies.y[shooter], bodies.z[shooter]};
+            for (const auto target: active) {
+                if (target != shooter && spatial::ray_hits_player(origin, direction, bodies, target)) {
+                    ++brute_hits;
+                }
+            }
+        }
+        const auto brute_shots = SWARM_SHOTS / seconds_since(start);
+        if (grid_hits != brute_hits) {
+            std::fprintf(stderr, "Hit count mismatch with %d bots: grid %zu, brute force %zu\n", bot_count, grid_hits,
+                         brute_hits);
+            return 1;
+        }
+
+        const float focal = 0.5f * std::hypot(VIEW_WIDTH, VIEW_HEIGHT);
+        std::vector<int> visible;
+        std::size_t grid_visible = 0;
+        std::size_t brute_visible = 0;
+        double cull_seconds = 0.0;
+        double brute_seconds = 0.0;
+        for (int viewer = 0; viewer < SWARM_VIEWERS; ++viewer) {
+            const auto index = active[static_cast<std::size_t>(viewer) % active.size()];
+            const auto camera = edges::make_camera(players[index], bodies.position(index));
+            const auto frustum = spatial::Frustum::from_camera(camera, focal, VIEW_WIDTH / 2, VIEW_HEIGHT / 2, 0.0f,
+                                                               focal * bodies.radius[index] / MIN_SCREEN_RADIUS);
+            visible.clear();
+            start = std::chrono::steady_clock::now();
+            world.collect_visible(index, frustum, visible);
+            cull_seconds += seconds_since(start);
+            grid_visible += visible.size();
+
+            start = std::chrono::steady_clock::now();
+            for (const auto target: active) {
+                if (target != index && frustum.intersects_sphere(spatial::bounding_sphere(bodies, target))) {
+                    ++brute_visible;
+                }
+            }
+            brute_seconds += seconds_since(start);
+        }
+        if (grid_visible != brute_visible) {
+            std::fprintf(stderr, "Draw list mismatch with %d bots: grid %zu, brute force %zu\n", bot_count,
+                         grid_visible, brute_visible);
+            return 1;
+        }
+
+        std::printf("%-8zu %10.1f %14.0f %14.0f %10.1f %10.2f %12.2f\n", active.size(), update_us, grid_shots,
+                    brute_shots, static_cast<double>(grid_visible) / SWARM_VIEWERS,
+                    cull_seconds * 1e6 / SWARM_VIEWERS, brute_seconds * 1e6 / SWARM_VIEWERS);
+    }
+    return 0;
+}
+
+/**
+ * 物理积分：原先的双精度逐玩家积分，与 SoA float 批量积分的标量 / AVX2 版本
+ * 每一帧都从同一个 float 状态出发分别走一步比较误差，避免误差在多帧之间累积；
+ * 标量和 AVX2 版本的结果必须逐位一致
+ * 物体正好落在墙面或地面上时，两种精度可能一个判定为撞上、一个没有，速度差一整个撞墙前的速度；
+ * 这种情况单独计数，不算进速度误差
+ */
+auto benchmark_physics() -> int {
+    std::printf("\n%-8s %12s %12s %12s %12s %12s %14s\n", "bodies", "legacy ns", "scalar ns", "avx2 ns",
+                "max pos err", "max vel err", "contact flips");
+    for (const int count: {1024, 16384, 65536}) {
+        const auto size = static_cast<std::size_t>(count);
+        std::mt19937 rng{11};
+        std::uniform_real_distribution<float> place(-20.0f, 20.0f);
+        std::uniform_real_distribution<float> speed(-5.0f, 5.0f);
+        std::uniform_int_distribution<Uint64> frame_time(SDL_NS_PER_SECOND / 240, SDL_NS_PER_SECOND / 30);
+        std::uniform_int_distribution<unsigned int> yaw(0, UINT32_MAX);
+        std::uniform_int_distribution<int> wasd(0, 31);
+
+        physics::Bodies initial;
+        initial.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            initial.x[i] = place(rng);
+            initial.y[i] = place(rng);
+            initial.z[i] = place(rng);
+            initial.vx[i] = speed(rng);
+            initial.vy[i] = speed(rng);
+            initial.vz[i] = speed(rng);
+            initial.radius[i] = 0.5f;
+            initial.height[i] = 1.5f;
+        }
+        std::vector<Uint64> frames(PHYSICS_FRAMES);
+        for (auto &frame: frames) {
+            frame = frame_time(rng);
+        }
+        std::vector<Player> inputs(size * (PHYSICS_FRAMES / PHYSICS_INPUT_PERIOD));
+        for (auto &input: inputs) {
+            input.yaw = yaw(rng);
+            input.wasd = static_cast<unsigned char>(wasd(rng));
+        }
+        const auto input_of = [&](const int frame, const std::size_t index) -> const Player & {
+            return inputs[static_cast<std::size_t>(frame / PHYSICS_INPUT_PERIOD) * size + index];
+        };
+        const auto to_legacy = [](const physics::Bodies &bodies, const std::size_t i, const Player &input) {
+            return LegacyBody{{bodies.x[i], bodies.y[i], bodies.z[i]},
+                              {bodies.vx[i], bodies.vy[i], bodies.vz[i]},
+                              input.yaw,
+                              bodies.radius[i],
+                              bodies.height[i],
+                              input.wasd};
+        };
+
+        std::vector<LegacyBody> legacy(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            legacy[i] = to_legacy(initial, i, input_of(0, i));
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < PHYSICS_FRAMES; ++frame) {
+            for (std::size_t i = 0; i < size; ++i) {
+                legacy[i].yaw = input_of(frame, i).yaw;
+                legacy[i].wasd = input_of(frame, i).wasd;
+                integrate_legacy(legacy[i], frames[frame]);
+            }
+        }
+        const auto legacy_ns = seconds_since(start) * 1e9 / PHYSICS_FRAMES / count;
+
+        auto run = [&](physics::Bodies &bodies, const edges::Backend backend) {
+            bodies = initial;
+            const auto begin = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < PHYSICS_FRAMES; ++frame) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    physics::set_input(bodies, i, input_of(frame, i).yaw, input_of(frame, i).wasd);
+                }
+                physics::integrate(bodies, physics::make_step(frames[frame]), 0, size, backend);
+            }
+            return seconds_since(begin) * 1e9 / PHYSICS_FRAMES / count;
+        };
+        physics::Bodies scalar;
+        const auto scalar_ns = run(scalar, edges::Backend::Scalar);
+        double avx2_ns = 0.0;
+        if (edges::is_backend_supported(edges::Backend::Avx2)) {
+            physics::Bodies avx2;
+            avx2_ns = run(avx2, edges::Backend::Avx2);
+            for (auto array: {&physics::Bodies::x, &physics::Bodies::y, &physics::Bodies::z, &physics::Bodies::vx,
+                              &physics::Bodies::vy, &physics::Bodies::vz}) {
+                if (not std::ranges::equal(scalar.*array, avx2.*array)) {
+                    std::fprintf(stderr, "AVX2 physics differs from scalar with %d bodies\n", count);
+                    return 1;
+                }
+            }
+        }
+
+        // 逐帧比较：同一个 float 状态分别用两种做法走一步
+        physics::Bodies bodies = initial;
+        double max_position_error = 0.0;
+        double max_velocity_error = 0.0;
+        std::size_t contact_flips = 0;
+        for (int frame = 0; frame < PHYSICS_FRAMES; ++frame) {
+            for (std::size_t i = 0; i < size; ++i) {
+                legacy[i] = to_legacy(bodies, i, input_of(frame, i));
+                integrate_legacy(legacy[i], frames[frame]);
+                physics::set_input(bodies, i, input_of(frame, i).yaw, input_of(frame, i).wasd);
+            }
+            physics::integrate(bodies, physics::make_step(frames[frame]), 0, size, edges::Backend::Scalar);
+            for (std::size_t i = 0; i < size; ++i) {
+                const auto &expected = legacy[i];
+                const double bound = MAP_BOX_SCALE - expected.radius;
+                const double floor = expected.height - MAP_BOX_SCALE;
+                const std::array position = {bodies.x[i], bodies.y[i], bodies.z[i]};
+                const std::array velocity = {bodies.vx[i], bodies.vy[i], bodies.vz[i]};
+                for (int axis = 0; axis < 3; ++axis) {
+                    const auto near = [&expected, axis](const double value) {
+                        return std::abs(expected.pos[axis] - value) <= PHYSICS_POSITION_TOLERANCE;
+                    };
+                    const auto velocity_error = std::abs(velocity[axis] - expected.vel[axis]);
+                    max_position_error = std::max(max_position_error, std::abs(position[axis] - expected.pos[axis]));
+                    const auto at_contact = near(bound) || near(axis == 1 ? floor : -bound);
+                    if (velocity_error > PHYSICS_VELOCITY_TOLERANCE && at_contact) {
+                        ++contact_flips;
+                        continue;
+                    }
+                    max_velocity_error = std::max(max_velocity_error, velocity_error);
+                }
+            }
+        }
+
+        std::printf("%-8d %12.2f %12.2f %12.2f %12.3g %12.3g %14zu\n", count, legacy_ns, scalar_ns, avx2_ns,
+                    max_position_error, max_velocity_error, contact_flips);
+        if (max_position_error > PHYSICS_POSITION_TOLERANCE || max_velocity_error > PHYSICS_VELOCITY_TOLERANCE) {
+            std::fprintf(stderr, "Physics error exceeds tolerance with %d bodies\n", count);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 分屏录制：不同视口数和机器人数下，每帧在主线程上依次录制所有视口，
+ * 与在作业系统上每个视口一个作业并行录制的耗时；两种方式录制出的边数和圆数必须相同
+ */
+auto benchmark_viewports() -> int {
+    constexpr int window_width = 1280;
+    constexpr int window_height = 960;
+    app_runtime::JobSystem job_system{std::min(app_runtime::JobSystem::default_worker_count(),
+                                        static_cast<unsigned int>(MAX_PLAYER_COUNT - 1))};
+    const auto map = edges::build_map_edges(MAP_BOX_SCALE);
+
+    std::printf("\n%-8s %10s %10s %12s %12s %10s\n", "players", "viewports", "rings", "serial us", "parallel us",
+                "threads");
+    for (const int bot_count: {0, 256, 1024, 4096}) {
+        World world{bot_count, 42};
+        world.set_local_count(MAX_PLAYER_COUNT);
+        for (int frame = 0; frame < 60; ++frame) {
+            world.update(FRAME_NS);
+        }
+        for (int count = 1; count <= MAX_PLAYER_COUNT; ++count) {
+            std::array<viewport::CommandBuffer, MAX_PLAYER_COUNT> serial;
+            std::array<viewport::CommandBuffer, MAX_PLAYER_COUNT> parallel;
+            const auto record = [&](std::array<viewport::CommandBuffer, MAX_PLAYER_COUNT> &commands,
+                                    const std::size_t i) {
+                const auto viewer = static_cast<int>(i);
+                commands[i].record(world, map, viewer,
+                                   viewport::split_screen(window_width, window_height, count, viewer));
+            };
+
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < VIEWPORT_FRAMES; ++frame) {
+                for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
+                    record(serial, i);
+                }
+            }
+            const auto serial_us = seconds_since(start) * 1e6 / VIEWPORT_FRAMES;
+
+            start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < VIEWPORT_FRAMES; ++frame) {
+                job_system.parallel_for(static_cast<std::size_t>(count),
+                                        [&](const std::size_t i) { record(parallel, i); });
+            }
+            const auto parallel_us = seconds_since(start) * 1e6 / VIEWPORT_FRAMES;
+
+            std::size_t rings = 0;
+            for (int i = 0; i < count; ++i) {
+                if (serial[i].get_edge_count() != parallel[i].get_edge_count() ||
+                    serial[i].get_ring_count() != parallel[i].get_ring_count()) {
+                    std::fprintf(stderr, "Viewport %d recorded differently in parallel\n", i);
+                    return 1;
+                }
+                rings += serial[i].get_ring_count();
+            }
+            std::printf("%-8zu %10d %10zu %12.1f %12.1f %10zu\n", world.get_active().size(), count, rings, serial_us,
+                        parallel_us, job_system.get_thread_count());
+        }
+    }
+    return 0;
+}
+
+/**
+ * 帧节奏：空帧按固定帧率运行一秒，统计实际帧间隔与目标间隔之差的 p50 / p99 / max
+ *  - delay：原先 handle_iteration 的做法，每帧 SDL_DelayNS(间隔 - 本帧耗时)
+ *  - pacer：FramePacer 的固定帧率模式，绝对截止时间加睡眠和自旋
+ */
+auto benchmark_pacing() -> int {
+    std::printf("\n%-8s %-8s %10s %10s %10s %10s\n", "hz", "method", "frames", "p50 us", "p99 us", "max us");
+    std::vector<double> errors;
+    const auto report = [&errors](const double hz, const char *method) {
+        std::ranges::sort(errors);
+        const auto at = [&errors](const double fraction) {
+            return errors[static_cast<std::size_t>(fraction * static_cast<double>(errors.size() - 1))];
+        };
+        std::printf("%-8.0f %-8s %10zu %10.1f %10.1f %10.1f\n", hz, method, errors.size(), at(0.5), at(0.99),
+                    errors.back());
+    };
+    for (const double hz: {240.0, 1000.0}) {
+        const auto interval_ns = static_cast<Uint64>(static_cast<double>(SDL_NS_PER_SECOND) / hz);
+        const auto record = [&errors, interval_ns](const Uint64 elapsed_ns) {
+            const auto error = static_cast<double>(elapsed_ns) - static_cast<double>(interval_ns);
+            errors.push_back(std::abs(error) / static_cast<double>(SDL_NS_PER_US));
+        };
+
+        errors.clear();
+        auto last = SDL_GetTicksNS();
+        for (const auto end = last + PACING_DURATION_NS; last < end;) {
+            const auto elapsed = SDL_GetTicksNS() - last;
+            if (elapsed < interval_ns) {
+                SDL_DelayNS(interval_ns - elapsed);
+            }
+            const auto now = SDL_GetTicksNS();
+            record(now - last);
+            last = now;
+        }
+        report(hz, "delay");
+
+        errors.clear();
+        pacing::FramePacer pacer{{.mode = pacing::Mode::FixedRate, .target_hz = hz}};
+        pacer.begin_frame();
+        last = SDL_GetTicksNS();
+        for (const auto end = last + PACING_DURATION_NS; last < end;) {
+            pacer.end_frame();
+            pacer.begin_frame();
+            const auto now = SDL_GetTicksNS();
+            record(now - last);
+            last = now;
+        }
+        report(hz, "pacer");
+    }
+    return 0;
+}
+
+auto main() -> int {
+    if (const auto result = benchmark_edges(); result != 0) {
+        return result;
+    }
+    if (const auto result = benchmark_trig(); result != 0) {
+        return result;
+    }
+    if (const auto result = benchmark_bots(); result != 0) {
+        return result;
+    }
+    if (const auto result = benchmark_physics(); result != 0) {
+        return result;
+    }
+    if (const auto result = benchmark_viewports(); result != 0) {
+        return result;
+    }
+    return benchmark_pacing();
+}